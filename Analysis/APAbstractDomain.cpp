@@ -47,18 +47,6 @@ using namespace clang;
 
 namespace differential {
 
-manager * APAbstractDomain_ValueTypes::ValTy::mgr_ptr_ = 0;
-
-map< var,vector<var> > APAbstractDomain_ValueTypes::ValTy::read_map_;
-map< var,vector<var> > APAbstractDomain_ValueTypes::ValTy::update_map_;
-
-AnalysisConfiguration::PartitionPoint APAbstractDomain_ValueTypes::ValTy::partition_point_ = AnalysisConfiguration::PARTITION_AT_CORR_POINT;
-AnalysisConfiguration::PartitionStrategy APAbstractDomain_ValueTypes::ValTy::partition_strategy_ = AnalysisConfiguration::JOIN_EQUIV;
-
-AnalysisConfiguration::WideningPoint APAbstractDomain_ValueTypes::ValTy::widening_point_ = AnalysisConfiguration::WIDEN_AT_BACK_EDGE;
-AnalysisConfiguration::WideningStrategy APAbstractDomain_ValueTypes::ValTy::widening_strategy_ = AnalysisConfiguration::WIDEN_EQUIV;
-unsigned APAbstractDomain_ValueTypes::ValTy::widening_threshold_ = AnalysisConfiguration::kWideningThreshold;
-
 namespace {
 
 class RegisterDecls
@@ -77,6 +65,39 @@ class RegisterDecls
 	}
 };
 
+// add to result the (untagged) vars of the abstract whose two versions are not known to differ in it, or (in the
+// abstract of the vars, whose array instrumentation is skipped) whose equality it prints. The ids and the non
+// equivalent vars are kept per abstract, so this costs no domain operations once they are known, and the abstract
+// is printed only for a var they do not find equivalent
+void AddEquivalentVars(const Abstract1 &abstract, bool is_vars, set<var> &result) {
+	SymbolTable &symbols = DomainContext::Current().symbols_;
+	const vector<SymbolTable::Id> &ids = abstract.Ids();
+	const set<var> &non_equiv_vars = abstract.NonEquivVars();
+	string abs_str;
+	for (size_t i = 0; i < ids.size(); ++i ) {
+		if (is_vars && SymbolTable::IsArrayInstrumentation(ids[i]))
+			continue;
+		SymbolTable::Id untagged = SymbolTable::IsTagged(ids[i]) ? symbols.Counterpart(ids[i]) : ids[i];
+		const var &v = symbols.Var(untagged);
+		if (non_equiv_vars.count(v) == 0) { // equivalence found for var v, add it to the set of equivalent vars
+			result.insert(v);
+			continue;
+		}
+		if (!is_vars)
+			continue;
+		// quick hack to save on domain operations
+		if (abs_str.empty()) {
+			stringstream abs_ss;
+			abs_ss << *abstract.abstract();
+			abs_str = abs_ss.str();
+		}
+		stringstream equiv_ss;
+		equiv_ss << symbols.Var(symbols.Counterpart(untagged)) << " - 1" << v << " = 0";
+		if (abs_str.find(equiv_ss.str()) != abs_str.npos)
+			result.insert(v);
+	}
+}
+
 } // end anonymous namespace
 
 bool APAbstractDomain_ValueTypes::ValTy::isTop(void) const {
@@ -84,7 +105,7 @@ bool APAbstractDomain_ValueTypes::ValTy::isTop(void) const {
 	cerr << "IsTop: " << *this << endl;
 #endif
 	for ( AbstractSet::const_iterator iter = abs_set_.begin(), E = abs_set_.end(); iter != E; ++iter ) {
-		if ( iter->vars.abstract()->is_top(*mgr_ptr_) && iter->guards.abstract()->is_top(*mgr_ptr_) ) {
+		if ( iter->vars.abstract()->is_top(*Context().mgr_ptr_) && iter->guards.abstract()->is_top(*Context().mgr_ptr_) ) {
 #if (DEBUGIsTop)
 			cerr << *iter << " is Top.\n";
 #endif
@@ -101,7 +122,7 @@ void APAbstractDomain_ValueTypes::ValTy::Assign(const environment& expr_env, con
 #if (DEBUGAssign)
 	cerr << "Assigning " << expr << " To " << variable << "\n";
 #endif
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet updated_abs_set;
 
 	if (abs_set_.size() == 0) {
@@ -150,7 +171,7 @@ void APAbstractDomain_ValueTypes::ValTy::Assign(const environment& expr_env, con
 
 /// forget given var from the state.
 void APAbstractDomain_ValueTypes::ValTy::Forget(string name) {
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet updated_abs_set;
 	for ( AbstractSet::iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		abstract1 abs = iter->vars, guards = iter->guards;
@@ -175,7 +196,7 @@ void APAbstractDomain_ValueTypes::ValTy::Assume(const set<abstract1>& added_abs_
 		cerr << *iter << ",";
 	cerr << "}\n";
 #endif
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet updated_abs_set;
 
 	// No need to account for guards as they are never involved in this operation
@@ -220,7 +241,7 @@ bool APAbstractDomain_ValueTypes::ValTy::operator<=(const ValTy& rhs) const {
 #if (DEBUGLowerEqual)
 	cerr << *this << " <= " << rhs << " ? ";
 #endif
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	// forall sub-states S1 in the abstract set
 	for ( AbstractSet::const_iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		bool found = false;
@@ -274,7 +295,7 @@ void APAbstractDomain_ValueTypes::ValTy::copyValues(const ValTy& rhs) {
 /// JoinAll joins all abstracts in the set into one abstract i.e. it performs: |_|{abs_1,...,abs_n}
 void APAbstractDomain_ValueTypes::ValTy::JoinAll() {
 	abs_set_.clear();
-	abs_set_.insert(AnalysisUtils::JoinAbstracts(*mgr_ptr_,abs_set_));
+	abs_set_.insert(AnalysisUtils::JoinAbstracts(*Context().mgr_ptr_,abs_set_));
 }
 
 // returns a mapping: {guards} ->  [abstracts]
@@ -283,7 +304,7 @@ map<Abstract1,AbstractSet> APAbstractDomain_ValueTypes::ValTy::PartitionByGuards
 	for ( AbstractSet::const_iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		Abstract2 abs2 = *iter;
 		//Abstract1 guards = (abs2.guards);
-		//guards.change_environment(*mgr_ptr_,env_);
+		//guards.change_environment(*Context().mgr_ptr_,env_);
 		// map the abstract to it's guards
 		//result[guards_str].insert(abs_ref);
 		result[abs2.guards].insert(abs2);
@@ -315,15 +336,15 @@ bool APAbstractDomain_ValueTypes::ValTy::CanBeReduced(string arr_name, string ar
  *  state = (state /\ {read(A,idx_l1) == update(B,idx_l2)}) \ { read(A,idx_l1) }
  */
 void APAbstractDomain_ValueTypes::ValTy::ApplyArrayReadAfterUpdateDeductionRule(var read_var)  {
-	if (!update_map_.size())
+	if (!Context().update_map_.size())
 		return;
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet deduced_set;
-	const vector<var> &read = read_map_[read_var];
+	const vector<var> &read = Context().read_map_[read_var];
 	for ( AbstractSet::iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		abstract1 abs = iter->vars;
 		const environment& env = abs.get_environment();
-		for (map< var, vector<var> >::const_iterator update_iter = update_map_.begin(), end = update_map_.end(); update_iter != end; ++update_iter) {
+		for (map< var, vector<var> >::const_iterator update_iter = Context().update_map_.begin(), end = Context().update_map_.end(); update_iter != end; ++update_iter) {
 			const vector<var> &update = update_iter->second;
 			if (AnalysisUtils::IsEquivalent(abs, read[0], update[0]) && // A == B
 					AnalysisUtils::IsEquivalent(abs, read[1], update[1])) { //  idx_l1 == idx_l2
@@ -343,14 +364,14 @@ void APAbstractDomain_ValueTypes::ValTy::ApplyArrayReadAfterUpdateDeductionRule(
  *  if A = B' and idx_l1 = idx_l2' then read(A,idx_l1) = read(B',idx_l2')
  */
 void APAbstractDomain_ValueTypes::ValTy::ApplyArrayReadDeductionRule()  {
-	if (!read_map_.size())
+	if (!Context().read_map_.size())
 		return;
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet deduced_set;
 	for ( AbstractSet::iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		abstract1 abs = iter->vars;
 		const environment& env = abs.get_environment();
-		for (map< var, vector<var> >::const_iterator read_iter = read_map_.begin(), end = read_map_.end(); read_iter != end; ++read_iter) {
+		for (map< var, vector<var> >::const_iterator read_iter = Context().read_map_.begin(), end = Context().read_map_.end(); read_iter != end; ++read_iter) {
 			map< var, vector<var> >::const_iterator read2_iter = read_iter;
 			while (++read2_iter != end) {
 				// for every (different) pair of reads
@@ -377,14 +398,14 @@ void APAbstractDomain_ValueTypes::ValTy::ApplyArrayReadDeductionRule()  {
  *  if the state has an unmatched update(), it means no equivalence
  */
 void APAbstractDomain_ValueTypes::ValTy::ApplyArrayUpdateDeductionRule()  {
-	if (!update_map_.size())
+	if (!Context().update_map_.size())
 		return;
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	AbstractSet deduced_set;
 	for ( AbstractSet::iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 		abstract1 abs = iter->vars;
 		vector<var> equiv_updates;
-		for (map< var, vector<var> >::const_iterator updates_iter = update_map_.begin(), end = update_map_.end(); updates_iter != end; ++updates_iter) {
+		for (map< var, vector<var> >::const_iterator updates_iter = Context().update_map_.begin(), end = Context().update_map_.end(); updates_iter != end; ++updates_iter) {
 			map< var, vector<var> >::const_iterator updates2_iter = updates_iter;
 			while (++updates2_iter != end) {
 				// for every (different) pair of updates
@@ -409,68 +430,13 @@ void APAbstractDomain_ValueTypes::ValTy::ApplyArrayUpdateDeductionRule()  {
 }
 
 map<set<var>,AbstractSet> APAbstractDomain_ValueTypes::ValTy::PartitionByEquivalence() const {
-	manager mgr = *mgr_ptr_;
 	map<set<var>,AbstractSet> result;
 
 	for ( AbstractSet::const_iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
-		abstract1 vars_abs = (iter->vars), guards_abs = (iter->guards);
-		environment env = vars_abs.get_environment();
-		vector<var> vars = env.get_vars();
-		set<var> equivalent_vars;
-		stringstream abs_ss;
-		abs_ss << vars_abs;
-		string abs_str = abs_ss.str();
-
 		// find the set of equivalent vars for the current abstract that agree on guards
-		for (size_t i = 0; i < vars.size(); ++i ) {
-			string name = vars[i],name_tag;
-
-			if (AnalysisUtils::IsArrayInstrumentationVar(vars[i]))
-				continue;
-
-			Utils::Names(name,name_tag);
-			var v(name),v_tag(name_tag);
-
-			// quick hack to save on domain operations
-			stringstream equiv_ss;
-			equiv_ss << name_tag << " - 1" << name << " = 0";
-			if (abs_str.find(equiv_ss.str()) != abs_str.npos) {
-				equivalent_vars.insert(v);
-				continue;
-			}
-
-			if ( !env.contains(v) )
-				env = env.add(&v,1,0,0);
-			if ( !env.contains(v_tag) )
-				env = env.add(&v_tag,1,0,0);
-			vars_abs.change_environment(mgr,env);
-
-			if (iter->vars.NonEquivVars().count(v) == 0) { // equivalence found for var v, add it to the set of equivalent vars
-				equivalent_vars.insert(v);
-			}
-		}
-
-		env = guards_abs.get_environment();
-		vars = env.get_vars();
-		// find the set of equivalent vars for the current abstract that agree on guards
-		for (size_t i = 0; i < vars.size(); ++i ) {
-			string name = vars[i],name_tag;
-			Utils::Names(name,name_tag);
-			var v(name),v_tag(name_tag);
-
-			if ( !env.contains(v) )
-				env = env.add(&v,1,0,0);
-			if ( !env.contains(v_tag) )
-				env = env.add(&v_tag,1,0,0);
-
-			guards_abs.change_environment(mgr,env);
-
-			tcons1 v_equal(texpr1(env,v) == texpr1(env,v_tag));
-
-			if (iter->guards.NonEquivVars().count(v) == 0) { // equivalence found for var v, add it to the set of equivalent vars
-				equivalent_vars.insert(v);
-			}
-		}
+		set<var> equivalent_vars;
+		AddEquivalentVars(iter->vars,true,equivalent_vars);
+		AddEquivalentVars(iter->guards,false,equivalent_vars);
 
 		// put the abstract in the set of other abstracts that hold equivalence for the same set of vars
 		result[equivalent_vars].insert(*iter);
@@ -497,14 +463,14 @@ map<set<var>,Abstract2> APAbstractDomain_ValueTypes::ValTy::JoinByPartition(map<
 	map<set<var>,Abstract2> result;
 	for (map<set<var>,AbstractSet>::const_iterator iter = partition.begin(), end = partition.end(); iter != end; ++iter ) {
 		// for each set of abstracts (that hold equivalence for the same vars) join them all into one abstract and put it in the result
-		result[iter->first] = AnalysisUtils::JoinAbstracts(*mgr_ptr_,iter->second);
+		result[iter->first] = AnalysisUtils::JoinAbstracts(*Context().mgr_ptr_,iter->second);
 	}
 	return result;
 }
 
 map<Abstract1,Abstract1> APAbstractDomain_ValueTypes::ValTy::JoinByPartition(map<Abstract1,AbstractSet> partition) {
 	map<Abstract1,Abstract1> result;
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 #if (DEBUGPartition)
 	cerr << "JoinByPartition: \n";
 #endif
@@ -544,23 +510,25 @@ bool APAbstractDomain_ValueTypes::ValTy::Partition() {
 	cerr << "\n---------------------\nPartition: " << *this;
 #endif
 	bool result = false;
-	cerr << abs_set_.size() << "->";
+	if (!Context().quiet_)
+		cerr << abs_set_.size() << "->";
 	if (abs_set_.size() > 1) {
 		result = true;
-		if ( partition_strategy_ == AnalysisConfiguration::JOIN_ALL ) {
+		if ( Context().partition_strategy_ == AnalysisConfiguration::JOIN_ALL ) {
 			JoinAll();
-		} else if ( partition_strategy_ == AnalysisConfiguration::JOIN_EQUIV ) {
+		} else if ( Context().partition_strategy_ == AnalysisConfiguration::JOIN_EQUIV ) {
 			ApplyArrayReadDeductionRule();
 			ApplyArrayUpdateDeductionRule();
 			// for each, find the set of variables which are equivalent and partition
 			abs_set_ = PartitionToAbsSet(JoinByPartition(PartitionByEquivalence()));
-		} else if ( partition_strategy_ == AnalysisConfiguration::JOIN_GUARDS ) {
+		} else if ( Context().partition_strategy_ == AnalysisConfiguration::JOIN_GUARDS ) {
 			abs_set_ = PartitionToAbsSet(JoinByPartition(PartitionByGuards()));
 		} else {
 			result = false;
 		}
 	}
-	cerr << abs_set_.size() << " ";
+	if (!Context().quiet_)
+		cerr << abs_set_.size() << " ";
 #if (DEBUGPartition)
 	cerr << "\nResult: " << *this << "\n---------------------\n";
 	getchar();
@@ -581,7 +549,7 @@ APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::Join(Val
 
 	for ( AbstractSet::const_iterator iter = rhs.abs_set_.begin(), end = rhs.abs_set_.end(); iter != end; ++iter ) {
 		// Remove bottoms
-		if (iter->vars.abstract()->is_bottom(*mgr_ptr_) || iter->guards.abstract()->is_bottom(*mgr_ptr_))
+		if (iter->vars.abstract()->is_bottom(*Context().mgr_ptr_) || iter->guards.abstract()->is_bottom(*Context().mgr_ptr_))
 			continue;
 		abs_set_.insert(*iter);
 	}
@@ -613,7 +581,7 @@ APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::Meet(con
 #if (DEBUGMeet)
 	cerr << "Meeting: " << *this << "And: "<< rhs;
 #endif
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 
 	AbstractSet met_abs_set;
 	if (abs_set_.size() == 0) {
@@ -647,23 +615,23 @@ APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::Meet(con
 
 APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::Meet(const abstract1& abs) {
 	ValTy rhs;
-	rhs.abs_set_.insert(Abstract2((abs),(abstract1(*mgr_ptr_,abs.get_environment(),apron::top()))));
+	rhs.abs_set_.insert(Abstract2((abs),(abstract1(*Context().mgr_ptr_,abs.get_environment(),apron::top()))));
 	//rhs.abs_set_.insert(Abstract2((abs),(abs)));
 	return Meet(rhs);
 }
 APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::Meet(const tcons1& cons) {
-	return Meet(AnalysisUtils::AbsFromConstraint(*mgr_ptr_,cons));
+	return Meet(AnalysisUtils::AbsFromConstraint(*Context().mgr_ptr_,cons));
 }
 
 APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::MeetGuard(const tcons1& guard_cons) {
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	abstract1 guard_abs = AnalysisUtils::AbsFromConstraint(mgr,guard_cons);
 #if (DEBUGMeetGuard)
 	cerr << "MeetGuard: " << *this << "And: "<< guard_abs;
 #endif
 	AbstractSet met_abs_set;
 	if (abs_set_.size() == 0) {
-		met_abs_set.insert(Abstract2((abstract1(*mgr_ptr_,guard_abs.get_environment(),apron::top())),(guard_abs)));
+		met_abs_set.insert(Abstract2((abstract1(*Context().mgr_ptr_,guard_abs.get_environment(),apron::top())),(guard_abs)));
 	} else {
 		for ( AbstractSet::const_iterator iter = abs_set_.begin(), end = abs_set_.end(); iter != end; ++iter ) {
 			abstract1 meet_guards = (iter->guards);
@@ -684,7 +652,7 @@ APAbstractDomain_ValueTypes::ValTy& APAbstractDomain_ValueTypes::ValTy::MeetGuar
 
 void APAbstractDomain_ValueTypes::ValTy::SetTop(){
 	abs_set_.clear();
-	Abstract1 abs1(abstract1(*mgr_ptr_,env_,apron::top()));
+	Abstract1 abs1(abstract1(*Context().mgr_ptr_,env_,apron::top()));
 	abs_set_.insert(Abstract2(abs1,abs1));
 }
 void APAbstractDomain_ValueTypes::ValTy::SetBottom(){
@@ -700,7 +668,7 @@ void APAbstractDomain_ValueTypes::ValTy::WidenByGuards(const ValTy& pre, const V
 
 
 	result.abs_set_.clear();
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	for (map<Abstract1, Abstract1>::const_iterator iter = pre_partition.begin(), end = pre_partition.end(); iter != end; ++iter ) {
 		Abstract1 guards = iter->first;
 #if (DEBUGWidening)
@@ -745,7 +713,7 @@ void APAbstractDomain_ValueTypes::ValTy::WidenByEquivalence(const ValTy& pre, co
 	map<set<var>,Abstract2> post_partition = post.JoinByPartition(post.PartitionByEquivalence());
 
 	result.abs_set_.clear();
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	for (map<set<var>,Abstract2>::const_iterator iter = pre_partition.begin(), end = pre_partition.end(); iter != end; ++iter ) {
 		const set<var> &key = iter->first;
 		abstract1 widened_abs = ((iter->second).vars), widened_guards = ((iter->second).guards);
@@ -783,7 +751,7 @@ void APAbstractDomain_ValueTypes::ValTy::WidenByEquivalence(const ValTy& pre, co
 }
 
 void APAbstractDomain_ValueTypes::ValTy::WidenAll(const ValTy& pre, const ValTy& post, ValTy& result) {
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 
 	Abstract2 joined_pre_abs = AnalysisUtils::JoinAbstracts(mgr, pre.abs_set_);
 	Abstract2 joined_post_abs = AnalysisUtils::JoinAbstracts(mgr, post.abs_set_);
@@ -793,12 +761,12 @@ void APAbstractDomain_ValueTypes::ValTy::WidenAll(const ValTy& pre, const ValTy&
 #endif
 	environment env = AnalysisUtils::JoinEnvironments(joined_pre_abs.vars.abstract()->get_environment(),
 			joined_post_abs.vars.abstract()->get_environment());
-	abstract1 widened_abs(*mgr_ptr_,env,apron::bottom());
+	abstract1 widened_abs(*Context().mgr_ptr_,env,apron::bottom());
 	apron::widening(mgr, widened_abs, joined_pre_abs.vars, joined_post_abs.vars);
 
 	env = AnalysisUtils::JoinEnvironments(joined_pre_abs.guards.abstract()->get_environment(),
 			joined_post_abs.guards.abstract()->get_environment());
-	abstract1 widened_guards(*mgr_ptr_,env,apron::bottom());
+	abstract1 widened_guards(*Context().mgr_ptr_,env,apron::bottom());
 	apron::widening(mgr, widened_guards, joined_pre_abs.guards, joined_post_abs.guards);
 
 	result.abs_set_.clear();
@@ -810,11 +778,11 @@ void APAbstractDomain_ValueTypes::ValTy::WidenAll(const ValTy& pre, const ValTy&
 }
 
 void APAbstractDomain_ValueTypes::ValTy::Widening(const ValTy& pre, const ValTy& post, ValTy& result) {
-	if (widening_strategy_ == AnalysisConfiguration::WIDEN_ALL)
+	if (Context().widening_strategy_ == AnalysisConfiguration::WIDEN_ALL)
 		WidenAll(pre,post,result);
-	if (widening_strategy_ == AnalysisConfiguration::WIDEN_EQUIV)
+	if (Context().widening_strategy_ == AnalysisConfiguration::WIDEN_EQUIV)
 		WidenByEquivalence(pre,post,result);
-	if (widening_strategy_ == AnalysisConfiguration::WIDEN_GUARDS)
+	if (Context().widening_strategy_ == AnalysisConfiguration::WIDEN_GUARDS)
 		WidenByGuards(pre,post,result);
 }
 
@@ -932,7 +900,7 @@ vector<set<abstract1> > APAbstractDomain_ValueTypes::ValTy::ComputeNegatedTau(un
 
 string APAbstractDomain_ValueTypes::ValTy::ComputeDiff(bool report_on_diff, bool compute_diff, bool guards, ValTy &delta_plus,  ValTy &delta_minus) {
 	unsigned index = 0;
-	manager mgr = *mgr_ptr_;
+	manager mgr = *Context().mgr_ptr_;
 	environment env, guards_env;// = state.env;
 	string report_string;
 	raw_string_ostream report_os(report_string);
@@ -1101,7 +1069,7 @@ void APChecker::ObserveFixedPoint(bool report_on_diff, bool compute_diff, unsign
 		raw_string_ostream report_os(report_string);
 
 		// partition one last time if strategy was at-corr-point
-		if (state.partition_point_ == AnalysisConfiguration::PARTITION_AT_CORR_POINT)
+		if (state.Context().partition_point_ == AnalysisConfiguration::PARTITION_AT_CORR_POINT)
 			state.Partition();
 
 #if (VERBOSE)
@@ -17,6 +17,8 @@ using namespace std;
 #include "AnalysisConfiguration.h"
 #include "Abstract1.h"
 #include "AnalysisUtils.h"
+#include "CFGLoops.h"
+#include "DomainContext.h"
 
 #include "apronxx/apronxx.hh"
 using namespace apron;
@@ -71,20 +73,13 @@ public:
 	public:
 
 		AbstractSet abs_set_;
-		static manager *mgr_ptr_;
 		environment env_; // shared environment for all abstracts in AbsSet
 
-		static map< var, vector<var> > read_map_;   // l: v = A[i] is kept here as read(A,idx_l) -> (v,A,idx_l)
-		static map< var, vector<var> > update_map_; // l: A[i] = e is kept here as update(A,idx_l) -> (A,idx_l)
-
 		bool at_diff_point_;
 
-		static AnalysisConfiguration::PartitionPoint partition_point_;
-		static AnalysisConfiguration::PartitionStrategy partition_strategy_;
-
-		static AnalysisConfiguration::WideningPoint widening_point_;
-		static AnalysisConfiguration::WideningStrategy widening_strategy_;
-		static unsigned widening_threshold_;
+		// the manager, the partitioning/widening configuration and the read/update maps of the current analysis
+		static DomainContext &Context() { return DomainContext::Current(); }
+		typedef CFGLoops LoopsTy; // the solver widens at the loop heads of this analysis of the CFG
 
 		ValTy() : at_diff_point_(false) {	}
 
@@ -11,11 +11,6 @@
 namespace differential
 {
 
-map<string,const abstract1*> Abstract1::abstract_dictionary;
-map<const abstract1*,set<var> > Abstract1::abstract_to_common_vars;
-map<const abstract1*,set<var> > Abstract1::abstract_to_nonequiv_vars;
-map<const abstract1*,string > Abstract1::abstract_to_string;
-
 Abstract1 Abstract1::AddAbstractToAll(const abstract1 &abstract) {
 	/**
 	 * look for an abstract that looks like the input in the dictionary by creating an Abstract1 from it
@@ -23,10 +18,10 @@ Abstract1 Abstract1::AddAbstractToAll(const abstract1 &abstract) {
 	 */
 	string key = Abstract1(&abstract).key();
 
-	if (abstract_dictionary.find(key) == abstract_dictionary.end()) {
-		abstract_dictionary[key] = new abstract1(abstract);
+	if (Context().abstract_dictionary.find(key) == Context().abstract_dictionary.end()) {
+		Context().abstract_dictionary[key] = new abstract1(abstract);
 	}
-	Abstract1 result(abstract_dictionary[key]);
+	Abstract1 result(Context().abstract_dictionary[key]);
 	return result;
 }
 
@@ -88,33 +83,42 @@ string Abstract1::key() const {
 	return result.str();
 }
 
+const vector<SymbolTable::Id>& Abstract1::Ids() const {
+	assert(abstract_ptr_);
+	if (Context().abstract_to_ids.count(abstract_ptr_))
+		return Context().abstract_to_ids[abstract_ptr_];
+	vector<var> vars = abstract_ptr_->get_environment().get_vars();
+	vector<SymbolTable::Id> result;
+	SymbolTable &symbols = Context().symbols_;
+	for (size_t i = 0 ; i < vars.size() ; ++i)
+		result.push_back(symbols.Find(vars[i]));
+	return (Context().abstract_to_ids[abstract_ptr_] = result);
+}
+
 // return the variables in the abstract that appear in bot tagges and untagged form
 const set<var>& Abstract1::CommonVars() const {
 	assert(abstract_ptr_);
-	if (abstract_to_common_vars.count(abstract_ptr_))
-		return abstract_to_common_vars[abstract_ptr_];
-	manager mgr = abstract_ptr_->get_manager();
+	if (Context().abstract_to_common_vars.count(abstract_ptr_))
+		return Context().abstract_to_common_vars[abstract_ptr_];
 	environment env = abstract_ptr_->get_environment();
-	vector<var> vars = env.get_vars();
+	const vector<SymbolTable::Id> &ids = Ids();
 	set<var> result;
-	for (int i = 0 ; i < vars.size() ; ++i) {
-		string name = vars[i];
+	SymbolTable &symbols = Context().symbols_;
+	for (size_t i = 0 ; i < ids.size() ; ++i) {
 	//	if (name.find('(') != name.npos) // function call
 		//	continue;
-		if (AnalysisUtils::IsArrayInstrumentationVar(vars[i]))
+		if (SymbolTable::IsArrayInstrumentation(ids[i]))
 			continue;
-		string name_tag;
-		Utils::Names(name,name_tag);
-		if (env.contains(name) && env.contains(name_tag))
-			result.insert(name); // return only untagged
+		if (env.contains(symbols.Var(symbols.Counterpart(ids[i]))))
+			result.insert(symbols.Var(SymbolTable::IsTagged(ids[i]) ? symbols.Counterpart(ids[i]) : ids[i])); // return only untagged
 	}
-	return (abstract_to_common_vars[abstract_ptr_] = result);
+	return (Context().abstract_to_common_vars[abstract_ptr_] = result);
 }
 
 const set<var>& Abstract1::NonEquivVars() const {
 	assert(abstract_ptr_);
-	if (abstract_to_nonequiv_vars.count(abstract_ptr_))
-		return abstract_to_nonequiv_vars[abstract_ptr_];
+	if (Context().abstract_to_nonequiv_vars.count(abstract_ptr_))
+		return Context().abstract_to_nonequiv_vars[abstract_ptr_];
 	manager mgr = abstract_ptr_->get_manager();
 	environment env = abstract_ptr_->get_environment();
 	vector<var> vars = env.get_vars();
@@ -133,7 +137,7 @@ const set<var>& Abstract1::NonEquivVars() const {
 				result.insert(name);
 		}
 	}
-	abstract_to_nonequiv_vars[abstract_ptr_] = result;
+	Context().abstract_to_nonequiv_vars[abstract_ptr_] = result;
 #if(0)
 	cerr << "Checking equivalence for " << *this << ": ";
 	cerr << "No equivalence for: ";
@@ -142,13 +146,13 @@ const set<var>& Abstract1::NonEquivVars() const {
 	cerr << "\n";
 	getchar();
 #endif
-	return abstract_to_nonequiv_vars[abstract_ptr_];
+	return Context().abstract_to_nonequiv_vars[abstract_ptr_];
 }
 
 
 Abstract1::operator string() const {
-	if (abstract_to_string.count(abstract_ptr_))
-		return abstract_to_string[abstract_ptr_];
+	if (Context().abstract_to_string.count(abstract_ptr_))
+		return Context().abstract_to_string[abstract_ptr_];
 
 	assert(abstract_ptr_);
 	stringstream ss;
@@ -192,9 +196,9 @@ Abstract1::operator string() const {
 		}
 		equiv_ss << ")";
 		// replace T_ prefix with ' postfix
-		return (abstract_to_string[abstract_ptr_] = equiv_ss.str() + ReplaceTagPrefix(splitted_ss.str()));
+		return (Context().abstract_to_string[abstract_ptr_] = equiv_ss.str() + ReplaceTagPrefix(splitted_ss.str()));
 	}
-	return (abstract_to_string[abstract_ptr_] = ss.str());
+	return (Context().abstract_to_string[abstract_ptr_] = ss.str());
 }
 
 /**
@@ -6,6 +6,7 @@
 #include <set>
 #include <string>
 #include <sstream>
+#include <vector>
 using namespace std;
 
 #include "apronxx/apronxx.hh"
@@ -13,19 +14,18 @@ using namespace apron;
 
 #include <llvm/Support/raw_ostream.h>
 
+#include "DomainContext.h"
+
 namespace differential {
 
 class Abstract1 {
 
 
 	/**
-	 * To avoid duplication of memory consuming abstracts, we keep them all in one global map
+	 * To avoid duplication of memory consuming abstracts, we keep them all in one map (of the current DomainContext)
 	 * which maps the string print-out of the state to the state itself (this is the best way to truly avoid duplication)
 	 */
-	static map<string,const abstract1*> abstract_dictionary;
-	static map<const abstract1*,set<var> > abstract_to_common_vars; // to avoid recomputing common vars
-	static map<const abstract1*,set<var> > abstract_to_nonequiv_vars; // to avoid recomputing equivalence
-	static map<const abstract1*,string > abstract_to_string; // to avoid recomputing the print
+	static DomainContext &Context() { return DomainContext::Current(); }
 	static Abstract1 AddAbstractToAll(const abstract1 &abstract);
 
 	const abstract1 * abstract_ptr_;
@@ -49,6 +49,8 @@ public:
 
 	operator string() const;
 
+	// the symbol table ids of the variables, in the order of the environment
+	const vector<SymbolTable::Id>& Ids() const;
 	const set<var>& CommonVars() const;
 	const set<var>& NonEquivVars() const;
 
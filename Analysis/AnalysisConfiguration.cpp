@@ -30,45 +30,46 @@ const char * AnalysisConfiguration::kManagerTypePolkaPPLStrict =    "polka_ppl_s
 const char * AnalysisConfiguration::kManagerTypeTaylor1Plus =    	"t1p";
 const char * AnalysisConfiguration::kManagerTypes =                 "box|oct|polka|polka_strict|ppl(default)|ppl_strict|ppl_grids|polka_ppl|polka_ppl_strict";
 
-manager * AnalysisConfiguration::ParseManager(ClList manager_type) {
-	outs() << "Domain: ";
+manager * AnalysisConfiguration::ParseManager(ClList manager_type, bool print) {
+	raw_ostream &os = print ? outs() : nulls();
+	os << "Domain: ";
 	if (manager_type.size()) {
 		if (manager_type[0] == kManagerTypeBox) {
-			outs() << "Box\n";
+			os << "Box\n";
 			return new box_manager();
 		} else if (manager_type[0] == kManagerTypeOctagon) {
-			outs() << "Octagon\n";
+			os << "Octagon\n";
 			return new oct_manager();
 		} else if (manager_type[0] == kManagerTypePolka) {
-			outs() << "Polka (loose)\n";
+			os << "Polka (loose)\n";
 			return new polka_manager();
 		} else if (manager_type[0] == kManagerTypePolkaStrict) {
-			outs() << "Polka (strict)\n";
+			os << "Polka (strict)\n";
 			return new polka_manager(true);
 		} else if (manager_type[0] == kManagerTypePPL) {
-			outs() << "PPL (polyhedra, loose)\n";
+			os << "PPL (polyhedra, loose)\n";
 			return new ppl_poly_manager();
 		} else if (manager_type[0] == kManagerTypePPLStrict) {
-			outs() << "PPL (polyhedra, strict)\n";
+			os << "PPL (polyhedra, strict)\n";
 			return new ppl_poly_manager(true);
 		} else if (manager_type[0] == kManagerTypePPLGrids) {
-			outs() << "PPL (grids)\n";
+			os << "PPL (grids)\n";
 			return new ppl_grid_manager();
 		} else if (manager_type[0] == kManagerTypePolkaPPL) {
-			outs() << "Product Polka (loose) * PPL grids\n";
+			os << "Product Polka (loose) * PPL grids\n";
 			return new pkgrid_manager(false);
 		} else if (manager_type[0] == kManagerTypePolkaPPLStrict) {
-			outs() << "Product Polka (strict) * PPL grids\n";
+			os << "Product Polka (strict) * PPL grids\n";
 			return new pkgrid_manager(true);
 //		} else if (manager_type[0] == kManagerTypeTaylor1Plus) {
-//			outs() << "Taylor1plus\n";
+//			os << "Taylor1plus\n";
 //			return new t1p_manager();
 		} else {
-			outs() << "PPL (polyhedra, loose)\n";
+			os << "PPL (polyhedra, loose)\n";
 			return new ppl_poly_manager();
 		}
 	} else {
-		outs() << "PPL (polyhedra, loose)\n";
+		os << "PPL (polyhedra, loose)\n";
 		return new ppl_poly_manager();
 	}
 }
@@ -228,5 +229,234 @@ int AnalysisConfiguration::ParseInterleavignLookaheadPartition(ClList partition)
 	return result;
 }
 
+const int AnalysisConfiguration::kSpeculationWorkers = 1; // default: speculate serially, in-process.
+int AnalysisConfiguration::ParseSpeculationWorkers(ClList workers) {
+	int result = kSpeculationWorkers;
+	if (workers.size()) {
+		result = atoi(workers[0].c_str());
+	}
+	if (result < 1)
+		result = 1;
+	outs() << "Speculation workers: " << result << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kSpeculationCommit = 0; // default: commit the whole window, nothing is left to reuse.
+int AnalysisConfiguration::ParseSpeculationCommit(ClList commit) {
+	int result = kSpeculationCommit;
+	if (commit.size()) {
+		result = atoi(commit[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	if (result)
+		outs() << "Speculation commits " << result << " steps per window\n";
+	else
+		outs() << "Speculation commits the whole window (snapshots are not reused)\n";
+	return result;
+}
+
+const bool AnalysisConfiguration::kSpeculationPOR = false; // default: speculate over the k+1 splits only.
+bool AnalysisConfiguration::ParseSpeculationPOR(ClList por) {
+	bool result = kSpeculationPOR;
+	if (por.size()) {
+		result = (atoi(por[0].c_str()) != 0);
+	}
+	outs() << "Speculation over " << (result ? "all interleavings (partial-order reduced)" : "splits") << '\n';
+	return result;
+}
+
+const bool AnalysisConfiguration::kAcceleration = false; // default: widen every loop, as before acceleration.
+bool AnalysisConfiguration::ParseAcceleration(ClList accelerate) {
+	bool result = kAcceleration;
+	if (accelerate.size()) {
+		result = (atoi(accelerate[0].c_str()) != 0);
+	}
+	outs() << "Loop acceleration: " << (result ? "on" : "off") << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kBand = 0; // default: interleavings are not kept to the alignment of the CFGs.
+unsigned AnalysisConfiguration::ParseBand(ClList band) {
+	int result = kBand;
+	if (band.size()) {
+		result = atoi(band[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Alignment band: ";
+	if (result)
+		outs() << result << " blocks\n";
+	else
+		outs() << "off\n";
+	return result;
+}
+
+const bool AnalysisConfiguration::kAlign = false; // default: every window is speculated over.
+bool AnalysisConfiguration::ParseAlign(ClList align) {
+	bool result = kAlign;
+	if (align.size()) {
+		result = (atoi(align[0].c_str()) != 0);
+	}
+	outs() << "Aligned stepping: " << (result ? "on (matched blocks are not speculated over)" : "off") << '\n';
+	return result;
+}
+
+const bool AnalysisConfiguration::kSummaries = false; // default: calls are opaque.
+bool AnalysisConfiguration::ParseSummaries(ClList summaries) {
+	bool result = kSummaries;
+	if (summaries.size()) {
+		result = (atoi(summaries[0].c_str()) != 0);
+	}
+	outs() << "Function summaries: " << (result ? "on" : "off") << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kTransferCacheSize = 4096; // default: 4096 entries.
+unsigned AnalysisConfiguration::ParseTransferCacheSize(ClList entries) {
+	int result = kTransferCacheSize;
+	if (entries.size()) {
+		result = atoi(entries[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Transfer cache: ";
+	if (result)
+		outs() << result << " entries\n";
+	else
+		outs() << "off\n";
+	return result;
+}
+
+const bool AnalysisConfiguration::kBatchMode = false; // default: interactive.
+bool AnalysisConfiguration::ParseBatchMode(ClList batch) {
+	bool result = kBatchMode;
+	if (batch.size()) {
+		result = (atoi(batch[0].c_str()) != 0);
+	}
+	outs() << "Mode: " << (result ? "batch" : "interactive") << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kFunctionTimeBudget = 0; // default: unbounded.
+unsigned AnalysisConfiguration::ParseFunctionTimeBudget(ClList seconds) {
+	int result = kFunctionTimeBudget;
+	if (seconds.size()) {
+		result = atoi(seconds[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Time budget per function: ";
+	if (result)
+		outs() << result << " seconds\n";
+	else
+		outs() << "none\n";
+	return result;
+}
+
+// each thread has a manager of its own, which Apron's own domains (box, oct and polka) are safe with. PPL is not
+// known to be thread-safe, so with PPL (the default, and its products) the functions are analyzed one at a time
+const int AnalysisConfiguration::kFunctionWorkers = 1; // default: analyze the functions one after the other.
+int AnalysisConfiguration::ParseFunctionWorkers(ClList workers, ClList manager_type) {
+	int result = kFunctionWorkers;
+	if (workers.size()) {
+		result = atoi(workers[0].c_str());
+	}
+	if (result < 1)
+		result = 1;
+	bool thread_safe = manager_type.size() && (manager_type[0] == kManagerTypeBox || manager_type[0] == kManagerTypeOctagon ||
+			manager_type[0] == kManagerTypePolka || manager_type[0] == kManagerTypePolkaStrict);
+	if (result > 1 && !thread_safe) {
+		outs() << "Function workers: 1 (the domain is not known to be thread-safe, use box, oct or polka)\n";
+		return 1;
+	}
+	outs() << "Function workers: " << result << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kFunctionStepBudget = 0; // default: unbounded.
+unsigned AnalysisConfiguration::ParseFunctionStepBudget(ClList steps) {
+	int result = kFunctionStepBudget;
+	if (steps.size()) {
+		result = atoi(steps[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Step budget per function: ";
+	if (result)
+		outs() << result << " steps\n";
+	else
+		outs() << "none\n";
+	return result;
+}
+
+const int AnalysisConfiguration::kFunctionDisjunctBudget = 0; // default: unbounded.
+unsigned AnalysisConfiguration::ParseFunctionDisjunctBudget(ClList disjuncts) {
+	int result = kFunctionDisjunctBudget;
+	if (disjuncts.size()) {
+		result = atoi(disjuncts[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Disjunct budget per state: ";
+	if (result)
+		outs() << result << " disjuncts\n";
+	else
+		outs() << "none\n";
+	return result;
+}
+
+std::string AnalysisConfiguration::ParseResultsFile(ClList filename) {
+	std::string result;
+	if (filename.size()) {
+		result = filename[0];
+	}
+	outs() << "Results file: " << (result.size() ? result : "none") << '\n';
+	return result;
+}
+
+std::string AnalysisConfiguration::ParseCacheDirectory(ClList dir) {
+	std::string result;
+	if (dir.size()) {
+		result = dir[0];
+	}
+	outs() << "Result cache: " << (result.size() ? result : "none") << '\n';
+	return result;
+}
+
+const int AnalysisConfiguration::kCacheSize = 256; // default: 256 MB.
+unsigned AnalysisConfiguration::ParseCacheSize(ClList megabytes) {
+	int result = kCacheSize;
+	if (megabytes.size()) {
+		result = atoi(megabytes[0].c_str());
+	}
+	if (result < 0)
+		result = 0;
+	outs() << "Result cache size: ";
+	if (result)
+		outs() << result << " MB\n";
+	else
+		outs() << "unbounded\n";
+	return result;
+}
+
+std::string AnalysisConfiguration::ParseInvariantsFile(ClList filename) {
+	std::string result;
+	if (filename.size()) {
+		result = filename[0];
+	}
+	outs() << "Invariants file: " << (result.size() ? result : "none") << '\n';
+	return result;
+}
+
+std::string AnalysisConfiguration::ParseWarmStartFile(ClList filename) {
+	std::string result;
+	if (filename.size()) {
+		result = filename[0];
+	}
+	outs() << "Warm start from: " << (result.size() ? result : "none") << '\n';
+	return result;
+}
+
 }
 
@@ -31,7 +31,7 @@ public:
 	static const char * kManagerTypePolkaPPLStrict;
 	static const char * kManagerTypeTaylor1Plus;
 	static const char * kManagerTypes;
-	static apron::manager * ParseManager(ClList manager_type);
+	static apron::manager * ParseManager(ClList manager_type, bool print = true); // print: report the domain on outs()
 
 	// Partition Points
 	typedef enum { PARTITION_AT_NONE, PARTITION_AT_JOIN, PARTITION_AT_CORR_POINT } PartitionPoint;
@@ -73,6 +73,40 @@ public:
 	static int ParseInterleavignLookaheadWindow(ClList window);
 	static const int kInterleavignLookaheadPartition;
 	static int ParseInterleavignLookaheadPartition(ClList partition);
+	static const int kSpeculationWorkers;
+	static int ParseSpeculationWorkers(ClList workers);
+	static const int kSpeculationCommit;
+	static int ParseSpeculationCommit(ClList commit);
+	static const bool kSpeculationPOR;
+	static bool ParseSpeculationPOR(ClList por);
+	static const bool kAcceleration;
+	static bool ParseAcceleration(ClList accelerate);
+	static const int kBand;
+	static unsigned ParseBand(ClList band);
+	static const bool kAlign;
+	static bool ParseAlign(ClList align);
+	static const bool kSummaries;
+	static bool ParseSummaries(ClList summaries);
+	static const int kTransferCacheSize;
+	static unsigned ParseTransferCacheSize(ClList entries);
+
+	// Batch
+	static const bool kBatchMode;
+	static bool ParseBatchMode(ClList batch);
+	static const int kFunctionTimeBudget;
+	static unsigned ParseFunctionTimeBudget(ClList seconds);
+	static const int kFunctionStepBudget;
+	static unsigned ParseFunctionStepBudget(ClList steps);
+	static const int kFunctionDisjunctBudget;
+	static unsigned ParseFunctionDisjunctBudget(ClList disjuncts);
+	static const int kFunctionWorkers;
+	static int ParseFunctionWorkers(ClList workers, ClList manager_type);
+	static std::string ParseResultsFile(ClList filename);
+	static std::string ParseCacheDirectory(ClList dir);
+	static const int kCacheSize;
+	static unsigned ParseCacheSize(ClList megabytes);
+	static std::string ParseInvariantsFile(ClList filename);
+	static std::string ParseWarmStartFile(ClList filename);
 };
 
 } // end namespace differential
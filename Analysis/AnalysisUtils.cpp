@@ -1,6 +1,7 @@
 #include "AnalysisUtils.h"
 #include "../Defines.h"
 #include "../Utils.h"
+#include "DomainContext.h"
 #include <vector>
 #include <sstream>
 
@@ -77,40 +78,33 @@ void AnalysisUtils::NegateConstraint(manager &mgr, tcons1 constraint, set<abstra
 		}
 	 */
 
+	vector<tcons1> negated;
+	NegatedConstraints(constraint,negated);
+	for (vector<tcons1>::const_iterator iter = negated.begin(), end = negated.end(); iter != end; ++iter) {
+		result.insert(AbsFromConstraint(mgr,*iter));
+	}
+#if (DEBUGNegate)
+	cerr << " Result: " << negated.size() << " abstracts" << endl;
+#endif
+}
+
+// the constraints whose disjunction is the negation of constraint (not checked for being unsatisfiable)
+void AnalysisUtils::NegatedConstraints(const tcons1 &constraint, vector<tcons1> &result) {
 	texpr1 expr = constraint.get_texpr();
-
-	if ( constraint.get_constyp()==AP_CONS_EQ || constraint.get_constyp()==AP_CONS_DISEQ ) {
-		// Turn == into != and vice versa
-		if ( constraint.get_constyp()==AP_CONS_EQ ) {
-			// Negate X == Y by creating the X > Y or X < Y states
-			// X - Y == 0 --> X - Y >= 1
-			tcons1 greater_than_cons(expr >= AnalysisUtils::kOne);
-			abstract1 greater_than_abs = AbsFromConstraint(mgr,greater_than_cons);
-			result.insert(greater_than_abs);
-			// X - Y == 0 --> -X + Y >= 1
-			tcons1 smaller_than_cons(-expr >= AnalysisUtils::kOne);
-			abstract1 smaller_than_abs = AbsFromConstraint(mgr,smaller_than_cons);
-			result.insert(smaller_than_abs);
-#if (DEBUGNegate)
-			cerr << " Result: " << greater_than_abs << " , " << smaller_than_abs << endl;
-#endif
-		} else {
-			constraint.get_constyp() = AP_CONS_EQ;
-			abstract1 negated_abs = AbsFromConstraint(mgr, constraint);
-			result.insert(negated_abs);
-#if (DEBUGNegate)
-			cerr << " Result: " << negated_abs << endl;
-#endif
-		}
-	} else {
-		// E >= 0 --> E <= -1.
-		tcons1 negated_cons(-expr >= AnalysisUtils::kOne);
-		abstract1 negated_abs = AbsFromConstraint(mgr,negated_cons);
-		result.insert(negated_abs);
-#if (DEBUGNegate)
-		cerr << " Result: " << negated_abs<< endl;
-#endif
-	}
+	if ( constraint.get_constyp()==AP_CONS_EQ ) {
+		// Negate X == Y by creating the X > Y or X < Y states
+		// X - Y == 0 --> X - Y >= 1
+		result.push_back(tcons1(expr >= AnalysisUtils::kOne));
+		// X - Y == 0 --> -X + Y >= 1
+		result.push_back(tcons1(-expr >= AnalysisUtils::kOne));
+	} else if ( constraint.get_constyp()==AP_CONS_DISEQ ) {
+		tcons1 equal = constraint;
+		equal.get_constyp() = AP_CONS_EQ;
+		result.push_back(equal);
+	} else {
+		// E >= 0 --> E <= -1.
+		result.push_back(tcons1(-expr >= AnalysisUtils::kOne));
+	}
 }
 
 Abstract2 AnalysisUtils::JoinAbstracts(manager& mgr, const AbstractSet  &abstracts) {
@@ -129,16 +123,13 @@ Abstract2 AnalysisUtils::JoinAbstracts(manager& mgr, const AbstractSet  &abstrac
 	return Abstract2(joined_vars,joined_guards);
 }
 
+// one-off queries check the prefixes (see SymbolTable::Kind), a lookup in the symbol table would cost more
 bool AnalysisUtils::IsGuard(const var &v) {
-	string name = v;
-	return ( name.find(Defines::kGuardPrefix) == 0 || name.find(Defines::kTagPrefix + Defines::kGuardPrefix) == 0 );//||
-	//name == Defines::kRetGuard || name == (Defines::kTagPrefix + Defines::kRetGuard) );
+	return SymbolTable::IsGuard(SymbolTable::Kind(v));
 }
 
 bool AnalysisUtils::IsArrayInstrumentationVar(const var &v) {
-	string name = v;
-	return (name.find(Defines::kArrayIndexPrefix) == 0 || name.find(Defines::kTagPrefix + Defines::kArrayIndexPrefix) == 0 ||
-			name.find(Defines::kArrayReadPrefix + "( ") == 0);
+	return SymbolTable::IsArrayInstrumentation(SymbolTable::Kind(v));
 }
 
 #define DEBUGIsEquivalent 	0
@@ -230,21 +221,29 @@ bool AnalysisUtils::CheckEquivalence(manager& mgr, const AbstractSet &abstracts,
 }
 
 
-// Forget all untagged variables in the given abstract state
-abstract1 AnalysisUtils::ForgetUntagged(const abstract1 &abs) {
+// Forget the given variables and remove them from the environment, in one projection
+abstract1 AnalysisUtils::Project(const abstract1 &abs, const vector<var> &forgotten) {
+	if (forgotten.empty())
+		return abs;
 	abstract1 result = abs;
 	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> variables = env.get_vars();
+	result.change_environment(mgr,result.get_environment().remove(&forgotten[0],forgotten.size()));
+	return result;
+}
+
+// Forget the variables whose kind bits (see SymbolTable) under mask are kind
+abstract1 AnalysisUtils::ForgetMasked(const abstract1 &abs, unsigned mask, unsigned kind) {
+	vector<var> variables = abs.get_environment().get_vars(), forgotten;
 	for ( unsigned i = 0 ; i < variables.size() ; ++i ) {
-		string name = variables[i];
-		if (name.find(Defines::kTagPrefix) > 0 ) {
-			result = result.forget(mgr,variables[i]);
-			env = env.remove(&variables[i],1);
-		}
+		if ((SymbolTable::Kind(variables[i]) & mask) == kind)
+			forgotten.push_back(variables[i]);
 	}
-	result.change_environment(mgr,env);
-	return result;
+	return Project(abs,forgotten);
+}
+
+// Forget all untagged variables in the given abstract state
+abstract1 AnalysisUtils::ForgetUntagged(const abstract1 &abs) {
+	return ForgetMasked(abs,SymbolTable::kTagged,0);
 }
 
 
@@ -252,81 +251,51 @@ abstract1 AnalysisUtils::ForgetUntagged(const abstract1 &abs) {
  * Forget all tagged variables in the given abstract state
  */
 abstract1 AnalysisUtils::ForgetTagged(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> variables = env.get_vars();
-	for ( unsigned i = 0 ; i < variables.size() ; ++i ) {
-		string name = variables[i];
-		if (name.find(Defines::kTagPrefix) == 0 ) {
-			result = result.forget(mgr,variables[i]);
-			env = env.remove(&variables[i],1);
-		}
-	}
-	result.change_environment(mgr,env);
-	return result;
+	return ForgetMasked(abs,SymbolTable::kTagged,SymbolTable::kTagged);
 }
 
 /**
  * Forget all initial variables in the given abstract state
  */
 abstract1 AnalysisUtils::ForgetInit(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> variables = env.get_vars();
+	vector<var> variables = abs.get_environment().get_vars(), forgotten;
 	for ( unsigned i = 0 ; i < variables.size() ; ++i ) {
 		string name = variables[i];
 		if (name.find(Defines::kInitPrefix) == 0 ||
 		    name.find(Defines::kTagPrefix + Defines::kInitPrefix) == 0) {
-			result = result.forget(mgr,name);
-			env = env.remove(&variables[i],1);
+			forgotten.push_back(variables[i]);
 		}
 	}
-	return result;
+	return Project(abs,forgotten);
 }
 
 /**
  * Forget all guard variables in the given abstract state
  */
 abstract1 AnalysisUtils::ForgetGuards(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> variables = env.get_vars();
-	for ( unsigned i = 0 ; i < variables.size() ; ++i ) {
-		if (AnalysisUtils::IsGuard(variables[i]) ) {
-			result = result.forget(mgr,variables[i]);
-			env = env.remove(&variables[i],1);
-		}
-	}
-	result.change_environment(mgr,env);
-	return result;
+	return ForgetMasked(abs,SymbolTable::kGuard,SymbolTable::kGuard);
 }
 
 /**
  * Forget all equivalent variables (v==v') in the given abstract state
  */
 abstract1 AnalysisUtils::ForgetEquivalent(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> vars = env.get_vars();
+	environment env = abs.get_environment();
+	vector<var> vars = env.get_vars(), forgotten;
+	SymbolTable &symbols = DomainContext::Current().symbols_;
 	for (size_t i = 0; i < vars.size(); ++i ) {
-		string name = vars[i],name_tag;
-		Utils::Names(name,name_tag);
-		var v(name),v_tag(name_tag);
+		SymbolTable::Id id = symbols.Find(vars[i]);
+		if (SymbolTable::IsTagged(id)) // each pair is checked from its untagged variable
+			continue;
+		const var &v = symbols.Var(id), &v_tag = symbols.Var(symbols.Counterpart(id));
 
 		// Check for equivalence
-		if (AnalysisUtils::IsEquivalent(result,v,v_tag)) {
-			result = result.forget(mgr,v);
-			result = result.forget(mgr,v_tag);
-			env = env.remove(&v,1);
-			env = env.remove(&v_tag,1);
+		if (AnalysisUtils::IsEquivalent(abs,v,v_tag)) {
+			forgotten.push_back(v);
+			forgotten.push_back(v_tag);
 		}
 	}
-	result.change_environment(mgr,env);
-	return result;
+	return Project(abs,forgotten);
 }
 
 
@@ -334,18 +303,13 @@ abstract1 AnalysisUtils::ForgetEquivalent(const abstract1 &abs) {
  * Forget all unconstrained variables (v==v') in the given abstract state and environment.
  */
 abstract1 AnalysisUtils::ForgetUnconstrained(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-	vector<var> vars = env.get_vars();
+	manager mgr = abs.get_manager();
+	vector<var> vars = abs.get_environment().get_vars(), forgotten;
 	for (size_t i = 0; i < vars.size(); ++i ) {
-		if (result.is_variable_unconstrained(mgr,vars[i])) {
-			result = result.forget(mgr,vars[i]);
-			env = env.remove(&vars[i],1);
-		}
+		if (abs.is_variable_unconstrained(mgr,vars[i]))
+			forgotten.push_back(vars[i]);
 	}
-	result.change_environment(mgr,env);
-	return result;
+	return Project(abs,forgotten);
 }
 
 /**
@@ -353,41 +317,20 @@ abstract1 AnalysisUtils::ForgetUnconstrained(const abstract1 &abs) {
  * or were added by the patch (i.e. don't have an untagged version). This includes guards.
  */
 abstract1 AnalysisUtils::ForgetUnmatched(const abstract1 &abs) {
-	abstract1 result = abs;
-	manager mgr = result.get_manager();
-	environment env = result.get_environment();
-#if (DEBUGForgetUnmatched)
-	//cerr << "Got " << result << endl;
-	//cerr << "Env = " << env << endl;
-#endif
-	vector<var> vars = env.get_vars();
+	environment env = abs.get_environment();
+	vector<var> vars = env.get_vars(), forgotten;
+	SymbolTable &symbols = DomainContext::Current().symbols_;
 	for (size_t i = 0; i < vars.size(); ++i ) {
-		string name = vars[i],name_tag;
-		Utils::Names(name,name_tag);
-		var v(name),v_tag(name_tag);
-
-		if (!env.contains(v)) {
-			result = result.forget(mgr,v_tag);
-			env = env.remove(&v_tag,1);
-#if (DEBUGForgetUnmatched)
-			cerr << "Forgetting " << v_tag << endl;
-#endif
-		} else if (!env.contains(v_tag)) {
-			result = result.forget(mgr,v);
-			env = env.remove(&v,1);
+		if (!env.contains(symbols.Var(symbols.Counterpart(symbols.Find(vars[i]))))) {
+			forgotten.push_back(vars[i]);
 #if (DEBUGForgetUnmatched)
-			cerr << "Forgetting " << v << endl;
+			cerr << "Forgetting " << vars[i] << endl;
 #endif
 		}
 	}
-	result.change_environment(mgr,env);
-#if (DEBUGForgetUnmatched)
-//cerr << "Done. Result = " << result << endl << "Env = " << result.get_environment();
-#endif
-	return result;
+	return Project(abs,forgotten);
 }
 
-
 set<abstract1> AnalysisUtils::NegateAbstract(manager &mgr, abstract1 &tau_i) {
 	// Computing ~(Tau_i) = {{~c | c \in Constrtaints}}
 
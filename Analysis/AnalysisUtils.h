@@ -4,6 +4,7 @@
 #include <string>
 #include <set>
 #include <map>
+#include <vector>
 using namespace std;
 
 #include "apronxx/apronxx.hh"
@@ -33,6 +34,7 @@ public:
 	static environment JoinEnvironments(const environment &env1, const environment &env2);
 	static void JoinExtendEnvironments(manager &mgr, abstract1 &abs1, abstract1 &abs2);
 	static void NegateConstraint(manager &mgr, tcons1 constraint, set<abstract1> &result);
+	static void NegatedConstraints(const tcons1 &constraint, vector<tcons1> &result);
 	static Abstract2 JoinAbstracts(manager& mgr, const AbstractSet &abstracts);
 	static bool IsGuard(const var &v);
 	static bool IsArrayInstrumentationVar(const var &v);
@@ -42,6 +44,8 @@ public:
 	static abstract1 MeetEquivalence(manager &mgr, const abstract1 &abs);
 	static bool CheckEquivalence(manager& mgr, const AbstractSet &abstracts, bool with_guards = false);
 
+	static abstract1 Project(const abstract1 &abs, const vector<var> &forgotten); // forget the variables and drop them from the environment, in one call
+	static abstract1 ForgetMasked(const abstract1 &abs, unsigned mask, unsigned kind); // forget the variables whose SymbolTable kind bits under mask are kind
 	static abstract1 ForgetUntagged(const abstract1 &abs); // forget all untagged variables in the given abstract state
 	static abstract1 ForgetTagged(const abstract1 &abs); // forget all tagged variables in the given abstract state
 	static abstract1 ForgetInit(const abstract1 &abs); // forget all initial variables in the given abstract state
@@ -0,0 +1,195 @@
+/*
+ * CFGLoops.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "CFGLoops.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace differential {
+
+namespace {
+
+struct Frame {
+	unsigned int block, next;
+	Frame(unsigned int block) : block(block), next(0) { }
+};
+
+}
+
+CFGLoops::CFGLoops(const CFG &cfg) : reducible_(true) {
+	const unsigned int size = cfg.getNumBlockIDs();
+	blocks_.assign(size, NULL);
+	vector< vector<unsigned int> > succs(size), preds(size);
+	for (CFG::const_iterator iter = cfg.begin(), end = cfg.end(); iter != end; ++iter) {
+		const CFGBlock *block = *iter;
+		blocks_[block->getBlockID()] = block;
+		for (CFGBlock::const_succ_iterator succ = block->succ_begin(), succ_end = block->succ_end(); succ != succ_end; ++succ) {
+			if (!*succ)
+				continue;
+			succs[block->getBlockID()].push_back((*succ)->getBlockID());
+			preds[(*succ)->getBlockID()].push_back(block->getBlockID());
+		}
+	}
+	const unsigned int entry = cfg.getEntry().getBlockID();
+
+	// depth first from the entry (with an explicit stack): the postorder, and the retreating edges, whose
+	// targets are still on the stack. Every cycle has a retreating edge, and every back edge is one.
+	enum { UNVISITED, ON_STACK, DONE };
+	vector<int> status(size, UNVISITED);
+	vector<unsigned int> postorder;
+	vector< pair<unsigned int,unsigned int> > retreating;
+	vector<Frame> frames;
+	frames.push_back(Frame(entry));
+	status[entry] = ON_STACK;
+	while (!frames.empty()) {
+		unsigned int block = frames.back().block;
+		if (frames.back().next < succs[block].size()) {
+			unsigned int succ = succs[block][frames.back().next++];
+			if (status[succ] == UNVISITED) {
+				status[succ] = ON_STACK;
+				frames.push_back(Frame(succ));
+			} else if (status[succ] == ON_STACK) {
+				retreating.push_back(make_pair(block, succ));
+			}
+			continue;
+		}
+		status[block] = DONE;
+		postorder.push_back(block);
+		frames.pop_back();
+	}
+	vector<unsigned int> rpo(postorder.rbegin(), postorder.rend());
+	order_.assign(size, UNREACHABLE);
+	for (unsigned int i = 0; i < rpo.size(); ++i) {
+		order_[rpo[i]] = i;
+	}
+
+	// dominators (Cooper, Harvey and Kennedy): iterate idom(b) = the common dominator of b's processed
+	// predecessors in reverse postorder until it is stable, which takes a couple of passes on reducible CFGs
+	idom_.assign(size, UNREACHABLE);
+	idom_[entry] = entry;
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (unsigned int i = 1; i < rpo.size(); ++i) {
+			unsigned int block = rpo[i], idom = UNREACHABLE;
+			for (vector<unsigned int>::const_iterator pred = preds[block].begin(), end = preds[block].end(); pred != end; ++pred) {
+				if (idom_[*pred] == UNREACHABLE)
+					continue;
+				idom = (idom == UNREACHABLE) ? *pred : Intersect(*pred, idom);
+			}
+			if (idom_[block] != idom) {
+				idom_[block] = idom;
+				changed = true;
+			}
+		}
+	}
+
+	// natural loops, merged by head
+	map<unsigned int, vector<bool> > members;
+	for (vector< pair<unsigned int,unsigned int> >::const_iterator edge = retreating.begin(), end = retreating.end(); edge != end; ++edge) {
+		unsigned int source = edge->first, head = edge->second;
+		heads_.insert(blocks_[head]);
+		back_edges_.insert(Edge(blocks_[source], blocks_[head]));
+		if (!Dominates(blocks_[head], blocks_[source])) {
+			reducible_ = false;
+			continue;
+		}
+		vector<bool> &body = members[head];
+		if (body.empty()) {
+			body.assign(size, false);
+			body[head] = true;
+		}
+		vector<unsigned int> work;
+		if (!body[source]) {
+			body[source] = true;
+			work.push_back(source);
+		}
+		while (!work.empty()) {
+			unsigned int block = work.back();
+			work.pop_back();
+			for (vector<unsigned int>::const_iterator pred = preds[block].begin(), preds_end = preds[block].end(); pred != preds_end; ++pred) {
+				if (order_[*pred] != UNREACHABLE && !body[*pred]) {
+					body[*pred] = true;
+					work.push_back(*pred);
+				}
+			}
+		}
+	}
+
+	// natural loops with different heads are either disjoint or nested, so the smallest loop containing a
+	// block is the innermost one
+	depth_.assign(size, 0);
+	loop_.assign(size, NULL);
+	for (map<unsigned int, vector<bool> >::const_iterator loop = members.begin(), end = members.end(); loop != end; ++loop) {
+		vector<const CFGBlock *> &body = bodies_[blocks_[loop->first]];
+		for (unsigned int id = 0; id < size; ++id) {
+			if (loop->second[id])
+				body.push_back(blocks_[id]);
+		}
+	}
+	for (map<const CFGBlock *, vector<const CFGBlock *> >::const_iterator loop = bodies_.begin(), end = bodies_.end(); loop != end; ++loop) {
+		for (vector<const CFGBlock *>::const_iterator block = loop->second.begin(), body_end = loop->second.end(); block != body_end; ++block) {
+			unsigned int id = (*block)->getBlockID();
+			depth_[id]++;
+			if (!loop_[id] || bodies_[loop_[id]].size() > loop->second.size())
+				loop_[id] = loop->first;
+		}
+	}
+}
+
+unsigned int CFGLoops::Index(const CFGBlock *block) const {
+	if (!block || block->getBlockID() >= blocks_.size() || order_[block->getBlockID()] == UNREACHABLE)
+		return UNREACHABLE;
+	return block->getBlockID();
+}
+
+// the nearest common dominator of two blocks whose dominators are already computed
+unsigned int CFGLoops::Intersect(unsigned int a, unsigned int b) const {
+	while (a != b) {
+		while (order_[a] > order_[b])
+			a = idom_[a];
+		while (order_[b] > order_[a])
+			b = idom_[b];
+	}
+	return a;
+}
+
+bool CFGLoops::Dominates(const CFGBlock *a, const CFGBlock *b) const {
+	unsigned int dominator = Index(a), block = Index(b);
+	if (dominator == UNREACHABLE || block == UNREACHABLE)
+		return false;
+	while (block != dominator) {
+		if (idom_[block] == block) // the entry
+			return false;
+		block = idom_[block];
+	}
+	return true;
+}
+
+const CFGBlock *CFGLoops::Idom(const CFGBlock *block) const {
+	unsigned int id = Index(block);
+	if (id == UNREACHABLE || idom_[id] == id)
+		return NULL;
+	return blocks_[idom_[id]];
+}
+
+unsigned int CFGLoops::Depth(const CFGBlock *block) const {
+	unsigned int id = Index(block);
+	return id == UNREACHABLE ? 0 : depth_[id];
+}
+
+const CFGBlock *CFGLoops::Head(const CFGBlock *block) const {
+	unsigned int id = Index(block);
+	return id == UNREACHABLE ? NULL : loop_[id];
+}
+
+const vector<const CFGBlock *> &CFGLoops::Body(const CFGBlock *head) const {
+	map<const CFGBlock *, vector<const CFGBlock *> >::const_iterator loop = bodies_.find(head);
+	return loop == bodies_.end() ? no_body_ : loop->second;
+}
+
+}
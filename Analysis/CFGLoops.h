@@ -0,0 +1,79 @@
+/*
+ * CFGLoops.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef CFGLOOPS_H_
+#define CFGLOOPS_H_
+
+#include <clang/Analysis/CFG.h>
+using namespace clang;
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * The loops of a CFG, computed once from its dominator tree: an edge is a back edge when its target dominates
+ * its source, the target is the loop's head, and the loop's body is the head together with every block that
+ * reaches the source without going through the head (loops sharing a head are merged).
+ * A cycle entered at more than one block (e.g. by a goto into a loop) has no dominating head; the target of
+ * its retreating edge is still reported as a head, so that every cycle goes through a head and the heads are
+ * sufficient widening points, but it has no body and does not add to the nesting depth.
+ * Blocks that are not reachable from the entry are in no loop.
+ */
+class CFGLoops {
+public:
+	typedef pair<const CFGBlock *,const CFGBlock *> Edge; // (source,target)
+
+	explicit CFGLoops(const CFG &cfg);
+	virtual ~CFGLoops() { }
+
+	bool Reachable(const CFGBlock *block) const { return Index(block) != UNREACHABLE; }
+	// whether every path from the entry to b goes through a (a block dominates itself)
+	bool Dominates(const CFGBlock *a, const CFGBlock *b) const;
+	// the immediate dominator, NULL for the entry and for unreachable blocks
+	const CFGBlock *Idom(const CFGBlock *block) const;
+
+	bool IsHead(const CFGBlock *block) const { return heads_.count(block); }
+	bool IsBackEdge(const CFGBlock *source, const CFGBlock *target) const { return back_edges_.count(Edge(source,target)); }
+	// the number of natural loops containing block, 0 outside loops
+	unsigned int Depth(const CFGBlock *block) const;
+	// the head of the innermost natural loop containing block, NULL outside loops
+	const CFGBlock *Head(const CFGBlock *block) const;
+	// the blocks of the natural loop headed by head (in block id order), empty if head is not a natural loop's head
+	const vector<const CFGBlock *> &Body(const CFGBlock *head) const;
+
+	const set<const CFGBlock *> &heads() const { return heads_; }
+	const set<Edge> &back_edges() const { return back_edges_; }
+	bool empty() const { return heads_.empty(); }
+	// false if some cycle has no dominating head
+	bool reducible() const { return reducible_; }
+
+private:
+	enum { UNREACHABLE = ~0u };
+
+	unsigned int Index(const CFGBlock *block) const;
+	unsigned int Intersect(unsigned int a, unsigned int b) const;
+
+	vector<const CFGBlock *> blocks_; // by id
+	vector<unsigned int> order_; // reverse postorder position, by id
+	vector<unsigned int> idom_; // by id
+	vector<unsigned int> depth_; // by id
+	vector<const CFGBlock *> loop_; // innermost natural loop's head, by id
+	map<const CFGBlock *, vector<const CFGBlock *> > bodies_;
+	set<const CFGBlock *> heads_;
+	set<Edge> back_edges_;
+	bool reducible_;
+	vector<const CFGBlock *> no_body_;
+};
+
+}
+
+#endif /* CFGLOOPS_H_ */
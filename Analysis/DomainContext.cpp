@@ -0,0 +1,52 @@
+/*
+ * DomainContext.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "DomainContext.h"
+
+namespace differential {
+
+__thread DomainContext *DomainContext::current_ = 0;
+DomainContext DomainContext::default_;
+
+DomainContext::DomainContext() :
+	mgr_ptr_(0),
+	partition_point_(AnalysisConfiguration::PARTITION_AT_CORR_POINT),
+	partition_strategy_(AnalysisConfiguration::JOIN_EQUIV),
+	widening_point_(AnalysisConfiguration::WIDEN_AT_BACK_EDGE),
+	widening_strategy_(AnalysisConfiguration::WIDEN_EQUIV),
+	widening_threshold_(AnalysisConfiguration::kWideningThreshold),
+	quiet_(false),
+	warnings_(0) { }
+
+// the interned abstracts are only referenced by states of this context
+DomainContext::~DomainContext() {
+	for (map<string,const abstract1*>::iterator iter = abstract_dictionary.begin(), end = abstract_dictionary.end(); iter != end; ++iter) {
+		delete iter->second;
+	}
+}
+
+void DomainContext::ForgetAbstracts() {
+	for (map<string,const abstract1*>::iterator iter = abstract_dictionary.begin(), end = abstract_dictionary.end(); iter != end; ++iter) {
+		delete iter->second;
+	}
+	abstract_dictionary.clear();
+	abstract_to_ids.clear();
+	abstract_to_common_vars.clear();
+	abstract_to_nonequiv_vars.clear();
+	abstract_to_string.clear();
+}
+
+void DomainContext::Configure(const DomainContext &other) {
+	partition_point_ = other.partition_point_;
+	partition_strategy_ = other.partition_strategy_;
+	widening_point_ = other.widening_point_;
+	widening_strategy_ = other.widening_strategy_;
+	widening_threshold_ = other.widening_threshold_;
+	quiet_ = other.quiet_;
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * DomainContext.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef DOMAINCONTEXT_H_
+#define DOMAINCONTEXT_H_
+
+#include "AnalysisConfiguration.h"
+#include "SymbolTable.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "apronxx/apronxx.hh"
+using namespace apron;
+
+namespace differential {
+
+/**
+ * The configuration and the shared tables of an analysis: the manager of the abstract domain, the partitioning
+ * and widening settings, the array read/update maps, and the tables that intern abstracts (see Abstract1).
+ * These used to be statics of ValTy and Abstract1. Each thread now analyzes in its current context, so that
+ * functions can be analyzed in parallel, each thread with a context (and a manager) of its own. Threads that
+ * did not install a context share the default one, which is where a single-threaded analysis is configured.
+ */
+class DomainContext {
+public:
+	DomainContext();
+	virtual ~DomainContext();
+
+	// copies the configuration of other (but not its manager, maps and tables)
+	void Configure(const DomainContext &other);
+	// frees the interned abstracts and empties the tables, when the manager is replaced: the states of the old
+	// manager must have been re-read (or be dropped without being used) first
+	void ForgetAbstracts();
+
+	static DomainContext &Current() { return current_ ? *current_ : default_; }
+	// make context the current context of the calling thread, NULL restores the default
+	static void Install(DomainContext *context) { current_ = context; }
+
+	manager *mgr_ptr_;
+
+	map< var, vector<var> > read_map_;   // l: v = A[i] is kept here as read(A,idx_l) -> (v,A,idx_l)
+	map< var, vector<var> > update_map_; // l: A[i] = e is kept here as update(A,idx_l) -> (A,idx_l)
+
+	AnalysisConfiguration::PartitionPoint partition_point_;
+	AnalysisConfiguration::PartitionStrategy partition_strategy_;
+
+	AnalysisConfiguration::WideningPoint widening_point_;
+	AnalysisConfiguration::WideningStrategy widening_strategy_;
+	unsigned widening_threshold_;
+
+	bool quiet_; // no progress output (batch mode)
+	// the warnings about the code analyzed (e.g. uninitialized variables) go to cerr, or to a buffer of the
+	// thread's own, printed with each function's results, when functions are analyzed in parallel
+	stringstream *warnings_;
+	ostream &Warnings() { return warnings_ ? *warnings_ : cerr; }
+
+	SymbolTable symbols_; // the variables seen so far (kept when the abstracts are forgotten, ids do not expire)
+
+	/**
+	 * To avoid duplication of memory consuming abstracts, we keep them all in one map which maps the string
+	 * print-out of the state to the state itself. Abstracts interned in one context are only valid in it.
+	 */
+	map<string,const abstract1*> abstract_dictionary;
+	map<const abstract1*,vector<SymbolTable::Id> > abstract_to_ids; // to avoid looking up the vars of an abstract
+	map<const abstract1*,set<var> > abstract_to_common_vars; // to avoid recomputing common vars
+	map<const abstract1*,set<var> > abstract_to_nonequiv_vars; // to avoid recomputing equivalence
+	map<const abstract1*,string > abstract_to_string; // to avoid recomputing the print
+
+private:
+	static __thread DomainContext *current_;
+	static DomainContext default_;
+
+	DomainContext(const DomainContext &);
+	DomainContext &operator=(const DomainContext &);
+};
+
+}
+
+#endif /* DOMAINCONTEXT_H_ */
@@ -0,0 +1,112 @@
+/*
+ * FunctionSummaries.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "FunctionSummaries.h"
+#include "Serialization.h"
+#include "../Defines.h"
+
+#include <cassert>
+#include <sstream>
+
+namespace differential {
+
+namespace {
+
+// the canonical names of a summary mapped to their names at a call site
+void Instances(const FunctionSummaries::Summary &summary, const string &call, vector<var> &from, vector<var> &to) {
+	for (unsigned int i = 0; i < summary.params.size(); ++i) {
+		from.push_back(var(Defines::kInitPrefix + summary.params[i]));
+		to.push_back(var(FunctionSummaries::Argument(call,i)));
+		from.push_back(var(Defines::kTagPrefix + Defines::kInitPrefix + summary.params[i]));
+		to.push_back(var(Defines::kTagPrefix + FunctionSummaries::Argument(call,i)));
+	}
+	from.push_back(var(Defines::kRetVal));
+	to.push_back(var(call));
+	from.push_back(var(Defines::kTagPrefix + Defines::kRetVal));
+	to.push_back(var(Defines::kTagPrefix + call));
+}
+
+}
+
+void FunctionSummaries::Add(const string &name, const vector<string> &params, const State &exit) {
+	manager &mgr = *State::Context().mgr_ptr_;
+	set<string> kept;
+	for (unsigned int i = 0; i < params.size(); ++i) {
+		kept.insert(Defines::kInitPrefix + params[i]);
+		kept.insert(Defines::kTagPrefix + Defines::kInitPrefix + params[i]);
+	}
+	kept.insert(Defines::kRetVal);
+	kept.insert(Defines::kTagPrefix + Defines::kRetVal);
+	stringstream ss;
+	ss << exit.abs_set_.size();
+	for (AbstractSet::const_iterator iter = exit.abs_set_.begin(), end = exit.abs_set_.end(); iter != end; ++iter) {
+		// the guards say nothing of the values, and the function's locals are gone at the call site
+		abstract1 abs = iter->vars;
+		environment env = abs.get_environment();
+		vector<var> vars = env.get_vars(), ints, reals;
+		for (unsigned int i = 0; i < vars.size(); ++i) {
+			if (!kept.count(vars[i]))
+				continue;
+			if (env.get_dim(vars[i]) < env.intdim())
+				ints.push_back(vars[i]);
+			else
+				reals.push_back(vars[i]);
+		}
+		abs.change_environment(mgr,environment(ints,reals));
+		Serialization::WriteAbstract(ss,mgr,abs);
+	}
+	Summary &summary = summaries_[name];
+	summary.params = params;
+	summary.abstracts = ss.str();
+}
+
+const FunctionSummaries::Summary *FunctionSummaries::Find(const string &name) const {
+	map<string,Summary>::const_iterator summary = summaries_.find(name);
+	return summary == summaries_.end() ? NULL : &summary->second;
+}
+
+void FunctionSummaries::Instantiate(const Summary &summary, const string &call, set<abstract1> &result) {
+	manager &mgr = *State::Context().mgr_ptr_;
+	vector<var> from, to;
+	Instances(summary,call,from,to);
+	stringstream ss(summary.abstracts);
+	size_t size = 0;
+	ss >> size;
+	for (size_t i = 0; i < size; ++i) {
+		abstract1 abs = Serialization::ReadAbstract(ss,mgr);
+		assert(ss && "malformed summary.");
+		// only the names the disjunct has: a return value or a parameter may have been dropped as unconstrained
+		environment env = abs.get_environment();
+		vector<var> present_from, present_to;
+		for (unsigned int j = 0; j < from.size(); ++j) {
+			if (env.contains(from[j])) {
+				present_from.push_back(from[j]);
+				present_to.push_back(to[j]);
+			}
+		}
+		if (present_from.size())
+			abs.rename(mgr,present_from,present_to);
+		result.insert(abs);
+	}
+}
+
+string FunctionSummaries::Argument(const string &call, unsigned int i) {
+	stringstream ss;
+	ss << call << '#' << i;
+	return ss.str();
+}
+
+string FunctionSummaries::ToString() const {
+	stringstream ss;
+	for (map<string,Summary>::const_iterator iter = summaries_.begin(), end = summaries_.end(); iter != end; ++iter) {
+		Serialization::WriteName(ss,iter->first);
+		ss << iter->second.abstracts;
+	}
+	return ss.str();
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ * FunctionSummaries.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef FUNCTIONSUMMARIES_H_
+#define FUNCTIONSUMMARIES_H_
+
+#include "APAbstractDomain.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * Differential summaries of the functions matched across versions: how the return values of the two
+ * versions relate to each other and to the arguments each version was called with. A summary is the exit
+ * state of a dual analysis of the function that starts with unrelated parameters, projected on the
+ * parameters' initial values (I_<param>, T_I_<param>) and the return values (RetVal, T_RetVal). It holds for
+ * any pair of calls, so at a call site it is instantiated on the call's return value and on snapshots of its
+ * arguments (<call>#<i>), whatever the other version's call was.
+ * Only functions over integers are summarized (the domain assigns integers only); calls to the others stay
+ * opaque (see TransferFuncs::AssumeTagEquivalence).
+ * The summaries are kept serialized, so that they can be read in the domain of any thread.
+ */
+class FunctionSummaries {
+public:
+	typedef APAbstractDomain_ValueTypes::ValTy State;
+
+	struct Summary {
+		vector<string> params;
+		string abstracts; // the disjuncts over the initial values and the return values, serialized
+	};
+
+	FunctionSummaries() { }
+	virtual ~FunctionSummaries() { }
+
+	// projects exit, a state of the function's dual analysis
+	void Add(const string &name, const vector<string> &params, const State &exit);
+	// NULL if the function has no summary
+	const Summary *Find(const string &name) const;
+	bool empty() const { return summaries_.empty(); }
+
+	// the summary in the current domain, with call (untagged) for the return value and call#i for the arguments
+	static void Instantiate(const Summary &summary, const string &call, set<abstract1> &result);
+	static string Argument(const string &call, unsigned int i);
+
+	// all the summaries, for keying the results that depend on them
+	string ToString() const;
+
+private:
+	map<string,Summary> summaries_;
+};
+
+}
+
+#endif /* FUNCTIONSUMMARIES_H_ */
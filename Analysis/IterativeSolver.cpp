@@ -6,18 +6,24 @@
  */
 
 #include "IterativeSolver.h"
+#include "Serialization.h"
+#include "SpeculationTree.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <limits>
-#include <pthread.h>
+
+#include <sys/time.h>
+
+#include "apronxx/apxx_box.hh"
+#include "apronxx/apxx_oct.hh"
 
 #define DEBUG 0
 #define DEBUG1 0
 
 namespace differential {
 
-ThreadArguments thread_arguments_[MAX_K + 1];
-
 void IterativeSolver::AssumeInputEquivalence(const FunctionDecl * fd,const FunctionDecl * fd2) {
 	assert(fd->getNumParams() == fd2->getNumParams());
 	// iterate over input parameters and assume equivalence
@@ -29,11 +35,71 @@ void IterativeSolver::AssumeInputEquivalence(const FunctionDecl * fd,const Funct
 	}
 	//AssumeInitialEquivalence(fd->getBody(), fd->getASTContext(), false);
 	//AssumeInitialEquivalence(fd2->getBody(), fd2->getASTContext(), true);
+	AssumeCallEquivalence(fd,fd2);
 	transformer_.getNVal() = transformer_.getVal();
-	cerr << "Initial state: " << transformer_.getVal();
+	Log() << "Initial state: " << transformer_.getVal();
 	// the resulting state will be kept in the transformer until it is copied to <entry1,entry2>
 }
 
+void IterativeSolver::AssumeSummaryInput(const FunctionDecl * fd,const FunctionDecl * fd2) {
+	assert(fd->getNumParams() == fd2->getNumParams());
+	// the versions may be called with anything, so their parameters are not related, but their initial values
+	// are kept for the summary to relate the return values to
+	for (int i = 0 ; i <  fd->getNumParams() ; ++i) {
+		string name = fd->getParamDecl(i)->getNameAsString();
+		assert (name == fd2->getParamDecl(i)->getNameAsString());
+		for (int tag = 0; tag < 2; ++tag) {
+			var param((tag ? Defines::kTagPrefix : "") + name), initial((tag ? Defines::kTagPrefix : "") + Defines::kInitPrefix + name);
+			environment env;
+			env = env.add(&param,1,0,0);
+			transformer_.getVal().Assign(env,initial,texpr1(env,param));
+		}
+	}
+	transformer_.return_var_ = Defines::kRetVal;
+	AssumeCallEquivalence(fd,fd2);
+	transformer_.getNVal() = transformer_.getVal();
+	Log() << "Initial state: " << transformer_.getVal();
+}
+
+namespace {
+
+void Calls(Stmt *node, vector<CallExpr*> &result) {
+	if (!node)
+		return;
+	if (CallExpr* call_expr = dyn_cast<CallExpr>(node))
+		result.push_back(call_expr);
+	for (Expr::child_iterator iter = node->child_begin(), end = node->child_end(); iter != end; ++iter) {
+		Calls(*iter,result);
+	}
+}
+
+}
+
+void IterativeSolver::AssumeCallEquivalence(const FunctionDecl * fd,const FunctionDecl * fd2) {
+	// a call's value is named by its text (see TransferFuncs::CallName), so the calls of the two versions that
+	// read the same are the ones assumed equal. nothing assigns or forgets these variables but a summary, which
+	// relates them itself (see TransferFuncs::ApplySummary), so the equivalence holds in every state that follows
+	vector<CallExpr*> calls, calls2;
+	Calls(fd->getBody(),calls);
+	Calls(fd2->getBody(),calls2);
+	bool tag = transformer_.tag_;
+	transformer_.tag_ = false;
+	set<string> names2;
+	for (vector<CallExpr*>::iterator iter = calls2.begin(), end = calls2.end(); iter != end; ++iter) {
+		names2.insert(transformer_.CallName(*iter));
+	}
+	set<string> assumed;
+	for (vector<CallExpr*>::iterator iter = calls.begin(), end = calls.end(); iter != end; ++iter) {
+		const string &name = transformer_.CallName(*iter);
+		if (!names2.count(name) || !assumed.insert(name).second)
+			continue;
+		Log() << "Found " << name << '\n';
+		transformer_.AssumeTagEquivalence(transformer_.getVal(),name,(*iter)->getCallReturnType().getTypePtr());
+	}
+	transformer_.tag_ = tag;
+	transformer_.calls_assumed_ = true;
+}
+
 void IterativeSolver::AssumeInitialEquivalence(Stmt* node, ASTContext &context, bool tag) {
 	if (!node)
 		return;
@@ -43,18 +109,17 @@ void IterativeSolver::AssumeInitialEquivalence(Stmt* node, ASTContext &context,
 			if ( VarDecl *decl = cast<VarDecl>(*iter) ) {
 				stringstream name;
 				name << (tag ? Defines::kTagPrefix : "") << decl->getNameAsString();
-				errs() << "Found " << name.str() << '\n';
+				Log() << "Found " << name.str() << '\n';
 				transformer_.AssumeTagEquivalence(transformer_.getVal(),name.str(),decl->getType().getTypePtr());
 			}
 		}
 	} else if (CallExpr* call_expr = dyn_cast<CallExpr>(node)) {
-		string call;
-		raw_string_ostream call_os(call);
-		call_os << (tag ? Defines::kTagPrefix : "");
-		call_expr->printPretty(call_os,context,0, PrintingPolicy(LangOptions()));
 		// assume the value of the function call is the same in both versions (TODO: this may not always be the case)
-		string call_str = Utils::ReplaceAll(call_os.str()," ",""); // remove spaces from call string
-		errs() << "Found " << call_str<< '\n';
+		bool saved = transformer_.tag_;
+		transformer_.tag_ = tag;
+		string call_str = transformer_.CallName(call_expr);
+		transformer_.tag_ = saved;
+		Log() << "Found " << call_str<< '\n';
 		transformer_.AssumeTagEquivalence(transformer_.getVal(),call_str,call_expr->getCallReturnType().getTypePtr());
 	}
 
@@ -63,56 +128,61 @@ void IterativeSolver::AssumeInitialEquivalence(Stmt* node, ASTContext &context,
 	}
 }
 
-IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_ptr, vector<IterativeSolver> solvers) {
+namespace {
+
+// abstracts are interned, so a state's contents are identified by the abstracts it points to
+void StateAbstracts(const IterativeSolver::State &state, vector<const abstract1*> &result) {
+	result.clear();
+	for (AbstractSet::const_iterator iter = state.abs_set_.begin(), end = state.abs_set_.end(); iter != end; ++iter) {
+		result.push_back(iter->vars.abstract());
+		result.push_back(iter->guards.abstract());
+	}
+}
+
+// the score of a state only depends on the abstracts of its variables
+void StateVars(const IterativeSolver::State &state, vector<const abstract1*> &result) {
+	result.clear();
+	for (AbstractSet::const_iterator iter = state.abs_set_.begin(), end = state.abs_set_.end(); iter != end; ++iter) {
+		result.push_back(iter->vars.abstract());
+	}
+}
+
+}
+
+// returns the index of the picked solver. when there is a choice, the changed locations of all solvers are reset.
+unsigned int IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_ptr, vector<IterativeSolver> &solvers) {
 	const unsigned int size = solvers.size();
 	assert(size > 0);
-	errs() << "findMinimalDiffSolver: picking from " << size << " solvers...";
+	Log() << "findMinimalDiffSolver: picking from " << size << " solvers...";
 	if (size == 1)
-		return solvers[0];
-	manager &mgr = *(transformer_.getVal().mgr_ptr_);
-
-	// define the score array and initialize to 0
-	float score[size];
-	memset(score,0,sizeof(float) * size);
+		return 0;
+	manager &mgr = *(transformer_.getVal().Context().mgr_ptr_);
 
 	// factor = |CFG x CFG'|
 	unsigned int factor = cfg_ptr->getNumBlockIDs() * cfg2_ptr->getNumBlockIDs();
 
 	// since all solvers start from the same origin, we check only the changed locations
-	//	pthread_t threads[solvers.size()];
+	vector<float> score(size);
 	for (int i = 0 ; i < solvers.size(); ++i) {
 		IterativeSolver &solver = solvers[i];
-		cerr << "\nSolver " << i << ": ";
-		//		thread_arguments_[i].is = solver;
-		//		pthread_create(threads + i, NULL, &differential::IterativeSolver::ComputeEquivalenceScore, &thread_arguments_[i]);
-		int num_scored = 0;
-		for (set<CFGBlockPair>::const_iterator iter = solver.changed_.begin(), end = solver.changed_.end(); iter != end; ++iter) {
-			const AbstractSet &abstracts = solver.statespace_[*iter].abs_set_;
-			if (abstracts.size() == 0)
-				continue;
-			unsigned int num_non_equiv = 0, num_common_vars = 0, num_equiv = 0;
-			for (AbstractSet::const_iterator abs_iter = abstracts.begin(), abs_end = abstracts.end(); abs_iter != abs_end; ++abs_iter) {
-				num_common_vars += abs_iter->vars.CommonVars().size();
-				num_non_equiv += abs_iter->vars.NonEquivVars().size();
-			}
-			if (num_common_vars) { // only abstracts that have common vars may receive a score
-				num_equiv = num_common_vars - num_non_equiv;
-				score[i] += ((float)num_equiv / num_common_vars);
-			} //otherwise they get 0
-			num_scored++;
-			errs() << "(" << iter->first->getBlockID() << "," << iter->second->getBlockID() << ") = " << ((float)num_equiv / num_common_vars) << ", ";
-		}
-		if (num_scored)
-			score[i] /= num_scored;
-		solver.changed_.clear();
-		cerr << "\nOverall normalized score = " << score[i] << "\n";
-	}
-
-	//	for (int i = 0 ; i < solvers.size(); ++i) { // wait for all threads to finish
-	//		pthread_join(threads[i],NULL);
-	//		solvers[i].changed_.clear();
-	//		score[i] = thread_arguments_[i].score;
-	//	}
+		Log() << "\nSolver " << i << ": ";
+		// interleavings that ended up in the same place get the same score, they are kept so that the tie-break is not affected
+		int same = -1;
+		for (int j = 0; j < i && same < 0; ++j) {
+			if (solver.SameSpeculation(solvers[j]))
+				same = j;
+		}
+		if (same >= 0) {
+			score[i] = score[same];
+			Log() << "same as solver " << same;
+		} else {
+			score[i] = solver.SpeculationScore();
+		}
+		Log() << "\nOverall normalized score = " << score[i] << "\n";
+	}
+	for (int i = 0 ; i < solvers.size(); ++i) {
+		solvers[i].changed_.clear();
+	}
 
 	//	for (int i = 0 ; i < solvers.size(); ++i) {
 	//		IterativeSolver &solver = solvers[i];
@@ -138,7 +208,7 @@ IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_
 	//			CFGBlockPair pcs(*iter,*iter2);
 	//			for (unsigned int i = 0; i < size ; ++i) {
 	//				if (solvers[i].statespace_.count(pcs)) {
-	//					if (AnalysisUtils::CheckEquivalence(mgr,solvers[i].statespace_[pcs].abs_set_)) {
+	//					if (AnalysisUtils::CheckEquivalence(mgr,solvers[i].statespace_[Id(pcs)].abs_set_)) {
 	//						score[i] += factor * factor;
 	//					}
 	//				}
@@ -159,7 +229,7 @@ IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_
 	//		 */
 	//		for (unsigned int i = 0; i < size ; ++i) {
 	//			if (solvers[i].statespace_.count(pcs)) {
-	//				if (AnalysisUtils::CheckEquivalence(mgr,solvers[i].statespace_[pcs].abs_set_)) {
+	//				if (AnalysisUtils::CheckEquivalence(mgr,solvers[i].statespace_[Id(pcs)].abs_set_)) {
 	//					// some solver found equivalence for the current pcs
 	//					score[i] += factor;
 	//					equivalence = true;
@@ -173,7 +243,7 @@ IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_
 	//		// to ones that did visit and had a diff. TODO: this might result in reduced precision
 	//		bool empty_diff = false;
 	//		for (unsigned int i = 0; i < size ; ++i) {
-	//			if (solvers[i].statespace_.count(pcs) == 0 ||  solvers[i].statespace_[pcs].size() == 0) {
+	//			if (solvers[i].statespace_.count(pcs) == 0 ||  solvers[i].statespace_[Id(pcs)].size() == 0) {
 	//				score[i]++;
 	//				empty_diff = true;
 	//			}
@@ -188,7 +258,7 @@ IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_
 	//		int min = std::numeric_limits<int>::max();
 	//		for (unsigned int i = 0; i < size ; ++i) {
 	//			if (solvers[i].statespace_.count(pcs)) {
-	//					diff[i] = solvers[i].statespace_[pcs].ComputeDiff(true,false,false,delta_plus,delta_minus).size();
+	//					diff[i] = solvers[i].statespace_[Id(pcs)].ComputeDiff(true,false,false,delta_plus,delta_minus).size();
 	//				if (min > diff[i]) {
 	//					diff[i] = min;
 	//				}
@@ -204,28 +274,139 @@ IterativeSolver IterativeSolver::FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_
 	//	}
 
 	// pick the solver with the highest score
+#if (DEBUG)
+	for (unsigned int i = 0; i < size ; ++i) {
+		cerr << "Solver #" << i << " has score " << score[i] << " : " << solvers[i];
+	}
+#endif
+	unsigned int index = PickSolver(score);
+#if (1)
+	Log() << "Solver #" << index /*<< " : " << solvers[index]*/ << " with score " << score[index] << " was picked.\n";
+//			getchar();
+#endif
+
+	Log() << "done.\n";
+	return index;
+}
+
+// whether this and other (speculated from the same origin) changed the same locations to the same states
+bool IterativeSolver::SameSpeculation(const IterativeSolver &other) const {
+	if (changed_ != other.changed_ || workset_ != other.workset_)
+		return false;
+	vector<const abstract1*> abstracts, other_abstracts;
+	for (set<CFGBlockPair>::const_iterator iter = changed_.begin(), end = changed_.end(); iter != end; ++iter) {
+		const State *state = statespace_.find(Id(*iter)), *other_state = other.statespace_.find(Id(*iter));
+		if (!state != !other_state)
+			return false;
+		if (!state)
+			continue;
+		StateAbstracts(*state,abstracts);
+		StateAbstracts(*other_state,other_abstracts);
+		if (abstracts != other_abstracts)
+			return false;
+	}
+	return true;
+}
+
+bool IterativeSolver::Score(unsigned int id, float &score) {
+	const State *state = statespace_.find(id);
+	vector<const abstract1*> vars;
+	if (state)
+		StateVars(*state,vars);
+	const StateScore *cached = scores_.find(id);
+	if (cached && cached->vars == vars) {
+		score = cached->score;
+		return cached->scored;
+	}
+	StateScore &entry = scores_[id];
+	entry.vars = vars;
+	entry.scored = false;
+	entry.score = score = 0;
+	if (!state || state->abs_set_.size() == 0)
+		return false;
+	const AbstractSet &abstracts = state->abs_set_;
+	unsigned int num_non_equiv = 0, num_common_vars = 0;
+	for (AbstractSet::const_iterator abs_iter = abstracts.begin(), abs_end = abstracts.end(); abs_iter != abs_end; ++abs_iter) {
+		num_common_vars += abs_iter->vars.CommonVars().size();
+		num_non_equiv += abs_iter->vars.NonEquivVars().size();
+	}
+	if (num_common_vars) // only abstracts that have common vars may receive a score, otherwise they get 0
+		entry.score = score = ((float)(num_common_vars - num_non_equiv) / num_common_vars);
+	entry.scored = true;
+	return true;
+}
+
+// scores the states at locations ahead of time, so that the snapshots taken from this one only score what they change
+void IterativeSolver::ScoreLocations(const set<CFGBlockPair> &locations) {
+	float score;
+	for (set<CFGBlockPair>::const_iterator iter = locations.begin(), end = locations.end(); iter != end; ++iter) {
+		Score(Id(*iter),score);
+	}
+}
+
+// the average equivalence ratio (equivalent common vars / common vars) over the locations changed by the speculation
+float IterativeSolver::ComputeEquivalenceScore() {
+	float score = 0;
+	int num_scored = 0;
+	for (set<CFGBlockPair>::const_iterator iter = changed_.begin(), end = changed_.end(); iter != end; ++iter) {
+		float location_score;
+		if (!Score(Id(*iter),location_score))
+			continue;
+		score += location_score;
+		num_scored++;
+		Log() << "(" << iter->first->getBlockID() << "," << iter->second->getBlockID() << ") = " << location_score << ", ";
+	}
+	if (num_scored)
+		score /= num_scored;
+	return score;
+}
+
+// equivalence scores are between 0 and 1, so a speculation that leaves the band scores below any that keeps to
+// it (even one scoring 0, which it would tie with if it lost only 1), and is only picked when all the others leave
+// it too (and then by its equivalence score, as usual): the run still advances wherever it must, and the band is a
+// preference
+const float kOutOfBandPenalty = 2;
+
+float IterativeSolver::SpeculationScore() {
+	float score = ComputeEquivalenceScore();
+	if (OutOfBand()) {
+		Log() << "out of band, ";
+		score -= kOutOfBandPenalty;
+	}
+	return score;
+}
+
+// whether the speculation changed or is to advance from a pair farther from the alignment than band_
+bool IterativeSolver::OutOfBand() const {
+	if (!band_ || !graph_)
+		return false;
+	const set<CFGBlockPair> *pairs[2] = { &changed_, &workset_ };
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (set<CFGBlockPair>::const_iterator iter = pairs[i]->begin(), end = pairs[i]->end(); iter != end; ++iter) {
+			if (graph_->Distance(*iter) > band_)
+				return true;
+		}
+	}
+	return false;
+}
+
+// the index of the highest score. in case of equality, the more balanced solution (closer to the middle split) wins
+unsigned int IterativeSolver::PickSolver(const vector<float> &score) {
+	const unsigned int size = score.size();
+	assert(size > 0);
 	unsigned int index = 0;
 	float max = score[index];
 	for (unsigned int i = index + 1; i < size ; ++i) {
 		if (score[i] > max ||
-				(score[i] == max && abs(i - (size/2)) < abs(index - (size/2)))) { // in case of equality, choose the more balanced solution
+				(score[i] == max && abs((int)i - (int)(size/2)) < abs((int)index - (int)(size/2)))) {
 			max = score[i];
 			index = i;
 		}
-#if (DEBUG)
-		cerr << "Solver #" << i << " has score " << score[i] << " : " << solvers[i];
-#endif
 	}
-#if (1)
-	cerr << "Solver #" << index /*<< " : " << solvers[index]*/ << " with score " << max << " was picked.\n";
-//			getchar();
-#endif
-
-	errs() << "done.\n";
-	return solvers[index];
+	return index;
 }
 
-void IterativeSolver::GetSuccesors(set<CFGBlockPair> &result, CFGBlockPair pcs, const CFGBlock * advance_block) {
+void IterativeSolver::GetSuccesors(set<CFGBlockPair> &result, CFGBlockPair pcs, const CFGBlock * advance_block) const {
 	CFGBlockPair succ_pcs;
 	const CFGBlock *first_succ = (advance_block->succ_size() > 0) ? *(advance_block->succ_begin()) : NULL;
 	const CFGBlock *last_succ = (advance_block->succ_size() > 1) ? *(advance_block->succ_begin() + 1) : NULL;
@@ -254,7 +435,7 @@ void IterativeSolver::GetSuccesors(set<CFGBlockPair> &result, CFGBlockPair pcs,
 	}
 }
 
-void IterativeSolver::Succesors(set<CFGBlockPair> pairs, GraphPick which, set<CFGBlockPair> &result) {
+void IterativeSolver::Succesors(set<CFGBlockPair> pairs, GraphPick which, set<CFGBlockPair> &result) const {
 	for (set<CFGBlockPair>::const_iterator iter = pairs.begin(), end = pairs.end(); iter != end ; ++iter) {
 		// figure out on which block we are advancing
 		if (which == FIRST_GRAPH) {
@@ -275,7 +456,34 @@ void IterativeSolver::Succesors(set<CFGBlockPair> pairs, GraphPick which, set<CF
 	}
 }
 
-// perform a BFS step in the analysis: take all pcs in the work set and advance one step from them on the selected graph (while clearing the work set).
+/**
+ * The pcs of the work set to advance in the next step, in the weak topological order of the product graph:
+ * those of the innermost component that contains the first pending pcs. The rest wait until that component is
+ * stable, so inner loops stabilize before the outer ones and nothing past a loop is advanced while it iterates.
+ */
+void IterativeSolver::Schedule(vector<CFGBlockPair> &result) const {
+	result.clear();
+	if (!graph_) {
+		result.assign(workset_.begin(), workset_.end());
+		return;
+	}
+	const WeakTopologicalOrder &wto = graph_->wto();
+	vector< pair<unsigned int, CFGBlockPair> > pending;
+	for (set<CFGBlockPair>::const_iterator iter = workset_.begin(), end = workset_.end(); iter != end; ++iter) {
+		unsigned int position = wto.Position(Id(*iter));
+		assert(position != WeakTopologicalOrder::UNORDERED && "pcs is not reachable in the product graph.");
+		pending.push_back(make_pair(position,*iter));
+	}
+	if (pending.empty())
+		return;
+	sort(pending.begin(),pending.end());
+	WeakTopologicalOrder::Span component = wto.Component(pending.front().first);
+	for (vector< pair<unsigned int, CFGBlockPair> >::const_iterator iter = pending.begin(), end = pending.end(); iter != end && iter->first < component.second; ++iter) {
+		result.push_back(iter->second);
+	}
+}
+
+// perform a BFS step in the analysis: take the scheduled pcs out of the work set and advance one step from them on the selected graph.
 bool IterativeSolver::Step(CFG * cfg_ptr, CFG * other_cfg_ptr, GraphPick which) {
 #if(DEBUG)
 	errs() << "Taking a step from: {";
@@ -284,15 +492,18 @@ bool IterativeSolver::Step(CFG * cfg_ptr, CFG * other_cfg_ptr, GraphPick which)
 	}
 	errs() << "}\n";
 #endif
-	set<CFGBlockPair> step_blocks = workset_;
-	workset_.clear();
+	vector<CFGBlockPair> step_blocks;
+	Schedule(step_blocks);
+	for (vector<CFGBlockPair>::const_iterator iter = step_blocks.begin(), end = step_blocks.end(); iter != end ; ++iter) {
+		workset_.erase(*iter);
+	}
 	bool can_advance = false;
-	for (set<CFGBlockPair>::const_iterator iter = step_blocks.begin(), end = step_blocks.end(); iter != end ; ++iter) {
+	for (vector<CFGBlockPair>::const_iterator iter = step_blocks.begin(), end = step_blocks.end(); iter != end ; ++iter) {
 		// if cannot advance on the chosen graph, but can on the other graph
 		if ((which == FIRST_GRAPH && iter->first->succ_empty() && !iter->second->succ_empty()) ||
 				(which == SECOND_GRAPH && iter->second->succ_empty() && !iter->first->succ_empty())   ) {
 #if(1)
-			errs() << "Can't advance over graph " << which + 1 << " from (" << iter->first->getBlockID() << "," <<
+			Log() << "Can't advance over graph " << which + 1 << " from (" << iter->first->getBlockID() << "," <<
 					iter->second->getBlockID() << ").\n";
 #endif
 			// return it to the work set
@@ -312,7 +523,7 @@ bool IterativeSolver::Step(CFG * cfg_ptr, CFG * other_cfg_ptr, GraphPick which)
 }
 
 #define DEBUGCanPOR 0
-bool IterativeSolver::CanPOR(void) {
+bool IterativeSolver::CanPOR(void) const {
 	// Apply a POR here: if G1->G2-> reaches the same block pairs as G2->G1->, and no partitioning occurs in between, do just one of them
 #if(DEBUGCanPOR)
 	errs() << "Starting from: {";
@@ -349,36 +560,26 @@ bool IterativeSolver::CanPOR(void) {
 	return (succs1 == succs2);
 }
 
-void * IterativeSolver::ComputeEquivalenceScoreParallel(void * arguments) {
-	ThreadArguments * ta = (ThreadArguments*)arguments;
-	IterativeSolver &solver = ta->is;
-	ta->score = 0;
-	int num_scored = 0;
-	for (set<CFGBlockPair>::const_iterator iter = solver.changed_.begin(), end = solver.changed_.end(); iter != end; ++iter) {
-		const AbstractSet &abstracts = solver.statespace_[*iter].abs_set_;
-		if (abstracts.size() == 0)
-			continue;
-		float num_equiv = 0.0;
-		for (AbstractSet::const_iterator abs_iter = abstracts.begin(), abs_end = abstracts.end(); abs_iter != abs_end; ++abs_iter) {
-			if (abs_iter->vars.NonEquivVars().size() == 0)
-				num_equiv++;
-		}
-		ta->score += num_equiv / abstracts.size();
-		num_scored++;
-		errs() << "(" << iter->first->getBlockID() << "," << iter->second->getBlockID() << ") = " << num_equiv / abstracts.size() << ", ";
+/**
+ *  Where the two versions are the same, the interleaving to pick is known: when every pending pair is matched
+ *  (see ProductGraph::Matched), the window steps once on the first graph and once on the second, and
+ *  speculation is left to the windows that start from an unmatched pair, around the changed code. False if a
+ *  pending pair is not matched, or if the steps cannot advance.
+ */
+bool IterativeSolver::Lockstep(SpeculationTree &tree, IterativeSolver &chosen, Interleaving &interleaving) {
+	if (!graph_ || workset_.empty())
+		return false;
+	for (set<CFGBlockPair>::const_iterator iter = workset_.begin(), end = workset_.end(); iter != end; ++iter) {
+		if (!graph_->Matched(*iter))
+			return false;
 	}
-	ta->score /= num_scored;
-	return arguments;
-}
-
-// the problem here is that this method invoked parallel access to the abstracts dictionary, which is unsafe
-void * IterativeSolver::SpeculateParallel(void * arguments) {
-	ThreadArguments * ta = (ThreadArguments*)arguments;
-	cerr << "Recieved: " << ta->is << "\n" << ta->cfg_ptrs[0] << "," << ta->cfg_ptrs[1] << "\n" << ta->k[0] << "," << ta->k[1] << "\n";
-	vector<IterativeSolver> result;
-	ta->is.Speculate(ta->cfg_ptrs[0],ta->cfg_ptrs[1],ta->k[0],ta->k[1]);
-	cerr << "Result: " << ta->is;
-	return arguments;
+	bool can_advance = false;
+	const IterativeSolver &stepped = tree.Get(SpeculationTree::Split(1,1),can_advance);
+	if (!can_advance)
+		return false;
+	chosen = stepped;
+	interleaving = SpeculationTree::Split(1,1);
+	return true;
 }
 
 /**
@@ -424,179 +625,1007 @@ bool IterativeSolver::Speculate(CFG * cfg_ptr,CFG * cfg2_ptr,unsigned int k1, un
 	//	}
 }
 
-void IterativeSolver::FindBackedges(const CFGBlock* initial, set<const CFGBlock*> visited, set<const CFGBlock*> &result) {
-	if (initial->succ_size() == 0)
+namespace {
+
+// pairs are passed by their ids in the product graph
+bool ReadId(istream &is, const ProductGraph &graph, unsigned int &id) {
+	is >> id;
+	if (!is || id >= graph.size() || !graph.Pair(id).first || !graph.Pair(id).second) {
+		is.setstate(ios::failbit);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * One interleaving of the speculation, run by a worker.
+ * It reports whether the interleaving advanced and its score, followed by the array accesses it registered
+ * and (if it advanced) everything it changed relative to the solver it started from.
+ */
+struct SpeculationJob : public WorkerPool::Job {
+	IterativeSolver *origin_;
+	SpeculationTree *tree_; // the worker continues from the snapshots its parent already has
+	IterativeSolver::Interleaving interleaving_;
+
+	SpeculationJob(IterativeSolver *origin, SpeculationTree *tree, const IterativeSolver::Interleaving &interleaving) :
+		origin_(origin), tree_(tree), interleaving_(interleaving) { }
+
+	void Run(ostream &out) {
+		bool can_advance = false;
+		IterativeSolver is = tree_->Get(interleaving_,can_advance);
+		float score = can_advance ? is.SpeculationScore() : 0;
+		// the score is passed bit-exact, the tie-break in PickSolver compares scores for equality
+		unsigned int score_bits = 0;
+		memcpy(&score_bits,&score,sizeof(score_bits));
+		out << "split " << can_advance << ' ' << score_bits << '\n';
+		Serialization::WriteVarMap(out,State::Context().read_map_);
+		Serialization::WriteVarMap(out,State::Context().update_map_);
+		if (can_advance)
+			is.WriteSpeculation(out,*origin_);
+	}
+};
+
+// reads the header of a split's output, with the array accesses its worker knew of once it was done
+bool ReadSplit(istream &is, bool &can_advance, float &score, map< var, vector<var> > &read_map, map< var, vector<var> > &update_map) {
+	unsigned int score_bits = 0;
+	read_map.clear();
+	update_map.clear();
+	if (!Serialization::Expect(is,"split"))
+		return false;
+	is >> can_advance >> score_bits;
+	memcpy(&score,&score_bits,sizeof(score));
+	Serialization::ReadVarMap(is,read_map);
+	Serialization::ReadVarMap(is,update_map);
+	return is.good();
+}
+
+IterativeSolver::Interleaving FromString(const string &text) {
+	IterativeSolver::Interleaving interleaving;
+	for (size_t i = 0; i < text.size(); ++i) {
+		interleaving.push_back((text[i] == '1') ? IterativeSolver::FIRST_GRAPH : IterativeSolver::SECOND_GRAPH);
+	}
+	return interleaving;
+}
+
+/**
+ * A long-lived speculation worker (see WorkerPool::Start). It holds the solver its parent had when they last
+ * synchronized, and each request brings what changed since (see WriteSync) and the interleavings to speculate
+ * from there. The reply holds the output of each interleaving's SpeculationJob, in the order asked, each as
+ * "<size>\n<output>".
+ */
+struct SpeculationServer : public WorkerPool::Server {
+	IterativeSolver &resident_; // in the worker, its copy of the parent's synced solver
+	CFG *cfg_ptr_, *cfg2_ptr_;
+
+	SpeculationServer(IterativeSolver &resident, CFG * cfg_ptr, CFG * cfg2_ptr) :
+		resident_(resident), cfg_ptr_(cfg_ptr), cfg2_ptr_(cfg2_ptr) { }
+
+	bool Serve(istream &request, ostream &out) {
+		size_t size = 0;
+		if (!resident_.ReadSync(request) || !Serialization::Expect(request,"interleavings"))
+			return false;
+		request >> size;
+		SpeculationTree tree(cfg_ptr_,cfg2_ptr_);
+		tree.Reset(resident_);
+		for (size_t i = 0; i < size; ++i) {
+			string text;
+			request >> text;
+			if (!request)
+				return false;
+			SpeculationJob split(&resident_,&tree,FromString(text));
+			stringstream split_out;
+			split.Run(split_out);
+			out << split_out.str().size() << '\n' << split_out.str();
+		}
+		return true;
+	}
+};
+
+// one split's output out of a worker's reply
+bool Unframe(istream &is, string &data) {
+	size_t size = 0;
+	is >> size;
+	if (!is || is.get() != '\n')
+		return false;
+	data.resize(size);
+	if (size)
+		is.read(&data[0],size);
+	return is.good() || (is.eof() && (size_t)is.gcount() == size);
+}
+
+// speculates a split in-process, with the accesses registered so far, as a crashed worker's is
+void RedoSplit(SpeculationJob &split, string &output) {
+	stringstream out;
+	split.Run(out);
+	output = out.str();
+}
+
+}
+
+string IterativeSolver::ToString(const Interleaving &interleaving) {
+	string result;
+	for (Interleaving::const_iterator iter = interleaving.begin(), end = interleaving.end(); iter != end; ++iter) {
+		result += (*iter == FIRST_GRAPH) ? '1' : '2';
+	}
+	return result;
+}
+
+/**
+ *  The interleavings speculated over in a window.
+ *  By default these are the k+1 splits (j steps on the first graph, then i = k-j on the second), ordered by i.
+ *  With por_, all interleavings of k steps are considered, and interleavings that only differ by the order of
+ *  commuting steps are explored once (sleep sets, with CanPOR deciding whether the steps commute). When all
+ *  steps commute this yields exactly the k+1 splits, in the same order.
+ */
+void IterativeSolver::Interleavings(SpeculationTree &tree, vector<Interleaving> &result) {
+	result.clear();
+	if (!por_) {
+		for (unsigned int i = 0, j = k_; i <= k_; ++i, --j) {
+			result.push_back(SpeculationTree::Split(j,i));
+		}
 		return;
-	visited.insert(initial);
-	const CFGBlock * left = *(initial->succ_begin());
-	if (left) {
-		if (result.count(left) == 0 && visited.count(left) == 0) {
-			FindBackedges(left,visited,result);
-		} else {
-#if(DEBUG1)
-			errs() << "found left backedge into " << left->getBlockID() << "\n";
+	}
+	Interleaving prefix;
+	ReduceInterleavings(tree,prefix,set<GraphPick>(),result);
+#if(DEBUG)
+	errs() << "Interleavings: {";
+	for (vector<Interleaving>::const_iterator iter = result.begin(), end = result.end(); iter != end; ++iter) {
+		errs() << ToString(*iter) << ",";
+	}
+	errs() << "}\n";
 #endif
-			result.insert(left);
+}
+
+/**
+ *  Explore the extensions of prefix, the first graph first. A step in sleep was already explored from an
+ *  earlier prefix and commutes with the steps taken since, so taking it here would repeat an interleaving.
+ *  Partitioning and widening only happen between windows, so they never come between two speculated steps.
+ */
+void IterativeSolver::ReduceInterleavings(SpeculationTree &tree, Interleaving &prefix, const set<GraphPick> &sleep, vector<Interleaving> &result) {
+	if (prefix.size() == k_) {
+		result.push_back(prefix);
+		return;
+	}
+	bool can_advance = false;
+	bool commute = tree.Get(prefix,can_advance).CanPOR();
+	set<GraphPick> done;
+	const GraphPick picks[] = { FIRST_GRAPH, SECOND_GRAPH };
+	for (unsigned int i = 0; i < 2; ++i) {
+		if (sleep.count(picks[i]))
+			continue;
+		set<GraphPick> next_sleep;
+		if (commute) { // the other step stays asleep (or falls asleep once explored)
+			next_sleep.insert(sleep.begin(),sleep.end());
+			next_sleep.insert(done.begin(),done.end());
+		}
+		prefix.push_back(picks[i]);
+		ReduceInterleavings(tree,prefix,next_sleep,result);
+		prefix.pop_back();
+		done.insert(picks[i]);
+	}
+}
+
+/**
+ *  Speculate over the window's interleavings and pick one with FindMinimalDiffSolver. The interleavings
+ *  are taken from the speculation tree, so they share their common prefixes.
+ */
+unsigned int IterativeSolver::SpeculateSerially(SpeculationTree &tree, CFG * cfg_ptr, CFG * cfg2_ptr, IterativeSolver &chosen, Interleaving &interleaving) {
+	vector<Interleaving> interleavings;
+	Interleavings(tree,interleavings);
+	vector<IterativeSolver> results;
+	vector<unsigned int> candidates;
+	for (unsigned int i = 0; i < interleavings.size(); ++i) {
+		bool can_advance = false;
+		const IterativeSolver &is = tree.Get(interleavings[i],can_advance);
+		if (can_advance) {
+			results.push_back(is);
+			candidates.push_back(i);
 		}
 	}
-	if (initial->succ_size() == 1)
-		return;
-	const CFGBlock * right = *(initial->succ_begin() + 1);
-	if (right && left != right) {
-		if (visited.count(right) == 0) {
-			FindBackedges(right,visited,result);
-		} else {
 #if(DEBUG1)
-			errs() << "found right backedge into " << right->getBlockID() << "\n";
+	cerr << "Results:\n";
+	int i = 0;
+	for (vector<IterativeSolver>::const_iterator solvers_iter = results.begin(), solvers_end = results.end(); solvers_iter != solvers_end; ++solvers_iter) {
+		IterativeSolver s = *solvers_iter;
+		errs() << "Solver #" << ++i << " : " << s << "\n";
+	}
 #endif
-			result.insert(right);
+	unsigned int index = FindMinimalDiffSolver(cfg_ptr,cfg2_ptr,results);
+	chosen = results[index];
+	interleaving = interleavings[candidates[index]];
+	return results.size();
+}
+
+/**
+ *  Same as SpeculateSerially, but the interleavings are speculated and scored by the worker pool. Candidates
+ *  are collected in the same order and picked with the same tie-break.
+ *  The workers are forked once, with this solver, and kept: each window sends them only what changed since
+ *  the last one (see WriteSync), and each worker speculates a contiguous run of the interleavings, which share
+ *  their prefixes in its own speculation tree. They start over (forked with the current solver) after a
+ *  worker fails, and after a degradation.
+ *  The serial mode speculates each split with the array accesses the splits before it registered. A worker
+ *  speculates its run with the accesses of the window's start and those its own splits register, and the
+ *  outputs are merged in split order: a split that started without accesses an earlier split of another worker
+ *  registered is speculated again, in-process, with them. Within the window, the chosen solver is then the one
+ *  the serial mode would choose (except that identical results are scored by each worker, not skipped), but a
+ *  function whose splits keep registering new array accesses is speculated mostly serially: this mode only
+ *  parallelizes the windows that do not. A worker that dies or whose output cannot be read is redone
+ *  in-process as well.
+ *  With por_, the reduction itself needs the intermediate states, so only the last steps are left to the workers.
+ */
+unsigned int IterativeSolver::SpeculateInParallel(WorkerPool &pool, IterativeSolver &synced, SpeculationTree &tree, CFG * cfg_ptr, CFG * cfg2_ptr,
+		IterativeSolver &chosen, Interleaving &interleaving) {
+	if (!pool.started()) {
+		synced = *this;
+		SpeculationServer server(synced,cfg_ptr,cfg2_ptr);
+		if (!pool.Start(server)) {
+			errs() << "Speculation workers could not be started, speculating in-process.\n";
+			return SpeculateSerially(tree,cfg_ptr,cfg2_ptr,chosen,interleaving);
+		}
+	}
+	vector<Interleaving> interleavings;
+	Interleavings(tree,interleavings);
+	vector<SpeculationJob> splits;
+	for (unsigned int i = 0; i < interleavings.size(); ++i) {
+		splits.push_back(SpeculationJob(this,&tree,interleavings[i]));
+	}
+	stringstream sync;
+	WriteSync(sync,synced);
+	synced = *this;
+	// worker w speculates the splits from first[w] up to first[w + 1]
+	const unsigned int size = splits.size(), workers = pool.size();
+	vector<unsigned int> first(workers + 1);
+	vector<string> requests(workers);
+	for (unsigned int w = 0; w <= workers; ++w) {
+		first[w] = w * size / workers;
+	}
+	for (unsigned int w = 0; w < workers; ++w) {
+		stringstream request;
+		request << sync.str() << "interleavings " << first[w + 1] - first[w];
+		for (unsigned int i = first[w]; i < first[w + 1]; ++i) {
+			request << ' ' << ToString(interleavings[i]);
 		}
+		requests[w] = request.str();
 	}
+	vector<string> replies, outputs(size);
+	vector<bool> received, succeeded(size,false);
+	pool.Call(requests,replies,received);
+	for (unsigned int w = 0; w < workers; ++w) {
+		istringstream in(replies[w]);
+		for (unsigned int i = first[w]; i < first[w + 1] && received[w]; ++i) {
+			succeeded[i] = Unframe(in,outputs[i]);
+		}
+	}
+
+	vector<unsigned int> candidates;
+	vector<float> score;
+	const map< var, vector<var> > window_read_map = State::Context().read_map_, window_update_map = State::Context().update_map_;
+	for (unsigned int w = 0; w < workers; ++w) {
+		// the accesses the worker started its next split with, if known (its previous split's output was read)
+		map< var, vector<var> > read_map = window_read_map, update_map = window_update_map;
+		bool known = true;
+		for (unsigned int i = first[w]; i < first[w + 1]; ++i) {
+			bool can_advance = false, parsed = false, read = false;
+			float split_score = 0;
+			map< var, vector<var> > split_read_map, split_update_map;
+			istringstream in(outputs[i]);
+			if (!succeeded[i]) {
+				errs() << "Speculation worker for interleaving " << ToString(splits[i].interleaving_) << " failed, speculating in-process.\n";
+			} else if (!(parsed = ReadSplit(in,can_advance,split_score,split_read_map,split_update_map))) {
+				errs() << "Speculation worker for interleaving " << ToString(splits[i].interleaving_) << " returned a malformed result, speculating in-process.\n";
+			} else if (!known || State::Context().read_map_ != read_map || State::Context().update_map_ != update_map) {
+				Log() << "Interleaving " << ToString(splits[i].interleaving_) << " missed earlier array accesses, speculating in-process...";
+			} else {
+				read = true;
+			}
+			known = parsed;
+			read_map = split_read_map;
+			update_map = split_update_map;
+			if (!read) { // with the accesses registered so far, which the in-process run adds its own to
+				RedoSplit(splits[i],outputs[i]);
+				istringstream again(outputs[i]);
+				read = ReadSplit(again,can_advance,split_score,split_read_map,split_update_map);
+			}
+			assert(read && "malformed speculation result.");
+			State::Context().read_map_ = split_read_map;
+			State::Context().update_map_ = split_update_map;
+			if (can_advance) {
+				candidates.push_back(i);
+				score.push_back(split_score);
+			}
+		}
+	}
+
+	const unsigned int candidates_size = candidates.size();
+	assert(candidates_size > 0);
+	Log() << "findMinimalDiffSolver: picking from " << candidates_size << " solvers...";
+	unsigned int index = (candidates_size == 1) ? 0 : PickSolver(score);
+	if (candidates_size > 1)
+		Log() << "Solver #" << index << " with score " << score[index] << " was picked.\n";
+
+	chosen = *this;
+	istringstream in(outputs[candidates[index]]);
+	bool can_advance = false;
+	float split_score = 0;
+	map< var, vector<var> > split_read_map, split_update_map;
+	if (!ReadSplit(in,can_advance,split_score,split_read_map,split_update_map) || !chosen.ReadSpeculation(in)) {
+		errs() << "Speculation worker for interleaving " << ToString(splits[candidates[index]].interleaving_) << " returned malformed states, speculating in-process.\n";
+		RedoSplit(splits[candidates[index]],outputs[candidates[index]]);
+		chosen = *this;
+		istringstream again(outputs[candidates[index]]);
+		bool read = ReadSplit(again,can_advance,split_score,split_read_map,split_update_map) && chosen.ReadSpeculation(again);
+		assert(read && "malformed speculation result.");
+	}
+	if (candidates_size > 1) // as in FindMinimalDiffSolver, changed locations are reset only when there was a choice
+		chosen.changed_.clear();
+	interleaving = interleavings[candidates[index]];
+	Log() << "done.\n";
+	return candidates_size;
+}
+
+void IterativeSolver::WriteSpeculation(ostream &os, const IterativeSolver &origin) const {
+	// only states that are new or were changed by the speculation
+	WriteDifference(os,origin,false);
+}
+
+void IterativeSolver::WriteDifference(ostream &os, const IterativeSolver &origin, bool compared) const {
+	os << "workset " << workset_.size();
+	for (set<CFGBlockPair>::const_iterator iter = workset_.begin(), end = workset_.end(); iter != end; ++iter) {
+		os << ' ' << Id(*iter);
+	}
+	os << "\nchanged " << changed_.size();
+	for (set<CFGBlockPair>::const_iterator iter = changed_.begin(), end = changed_.end(); iter != end; ++iter) {
+		os << ' ' << Id(*iter);
+	}
+	os << "\nvisits " << visits_.size();
+	for (unsigned int id = visits_.first(); id != visits_.end(); id = visits_.next(id)) {
+		os << ' ' << id << ' ' << *visits_.find(id);
+	}
+	const StateSpace *spaces[2] = { &statespace_, &prev_statespace_ };
+	const StateSpace *origin_spaces[2] = { &origin.statespace_, &origin.prev_statespace_ };
+	vector<const abstract1*> abstracts, origin_abstracts;
+	for (unsigned int i = 0; i < 2; ++i) {
+		vector<unsigned int> states;
+		for (unsigned int id = spaces[i]->first(); id != spaces[i]->end(); id = spaces[i]->next(id)) {
+			const State *state = spaces[i]->find(id), *origin_state = origin_spaces[i]->find(id);
+			bool differs = !origin_state;
+			if (!differs && !compared) {
+				differs = changed_.count(graph_->Pair(id));
+			} else if (!differs) {
+				StateAbstracts(*state,abstracts);
+				StateAbstracts(*origin_state,origin_abstracts);
+				differs = abstracts != origin_abstracts || state->at_diff_point_ != origin_state->at_diff_point_ || state->env_ != origin_state->env_;
+			}
+			if (differs)
+				states.push_back(id);
+		}
+		os << "\nstates " << states.size() << '\n';
+		for (unsigned int j = 0; j < states.size(); ++j) {
+			os << ' ' << states[j];
+			Serialization::WriteState(os,*spaces[i]->find(states[j]));
+		}
+	}
+}
+
+void IterativeSolver::WriteSync(ostream &os, const IterativeSolver &synced) const {
+	// states are only ever removed all at once (when a warm start is refuted), and then all are sent again
+	bool full = false;
+	const StateSpace *spaces[2] = { &statespace_, &prev_statespace_ };
+	const StateSpace *synced_spaces[2] = { &synced.statespace_, &synced.prev_statespace_ };
+	for (unsigned int i = 0; i < 2 && !full; ++i) {
+		for (unsigned int id = synced_spaces[i]->first(); id != synced_spaces[i]->end() && !full; id = synced_spaces[i]->next(id)) {
+			full = !spaces[i]->count(id);
+		}
+	}
+	os << "sync " << steps_ << ' ' << full << '\n';
+	Serialization::WriteVarMap(os,State::Context().read_map_);
+	Serialization::WriteVarMap(os,State::Context().update_map_);
+	const IterativeSolver none;
+	WriteDifference(os,full ? none : synced,true);
+	os << '\n';
 }
 
-void IterativeSolver::Partition() {
+bool IterativeSolver::ReadSync(istream &is) {
+	bool full = false;
+	if (!Serialization::Expect(is,"sync"))
+		return false;
+	is >> steps_ >> full;
+	if (full) {
+		statespace_.clear();
+		prev_statespace_.clear();
+	}
+	DomainContext &context = State::Context();
+	context.read_map_.clear();
+	context.update_map_.clear();
+	Serialization::ReadVarMap(is,context.read_map_);
+	Serialization::ReadVarMap(is,context.update_map_);
+	return ReadSpeculation(is);
+}
+
+bool IterativeSolver::ReadSpeculation(istream &is) {
+	size_t size = 0;
+	unsigned int id = 0;
+	workset_.clear();
+	if (!Serialization::Expect(is,"workset"))
+		return false;
+	is >> size;
+	for (size_t i = 0; i < size && ReadId(is,*graph_,id); ++i) {
+		workset_.insert(graph_->Pair(id));
+	}
+	changed_.clear();
+	if (!Serialization::Expect(is,"changed"))
+		return false;
+	is >> size;
+	for (size_t i = 0; i < size && ReadId(is,*graph_,id); ++i) {
+		changed_.insert(graph_->Pair(id));
+	}
+	visits_.clear();
+	if (!Serialization::Expect(is,"visits"))
+		return false;
+	is >> size;
+	for (size_t i = 0; i < size && ReadId(is,*graph_,id); ++i) {
+		is >> visits_[id];
+	}
+	StateSpace *spaces[2] = { &statespace_, &prev_statespace_ };
+	for (unsigned int i = 0; i < 2; ++i) {
+		if (!Serialization::Expect(is,"states"))
+			return false;
+		is >> size;
+		for (size_t j = 0; j < size && ReadId(is,*graph_,id); ++j) {
+			if (!Serialization::ReadState(is,(*spaces[i])[id]))
+				return false;
+		}
+	}
+	return !is.fail();
+}
+
+bool IterativeSolver::Partition() {
+	bool changed = false;
+	vector<const abstract1*> before, after;
 	{
-		cerr << "Partition: { ";
+		Log() << "Partition: { ";
 		// partition work set every p steps overall
-		bool backedges_exist = (backedge_blocks_.first.size() || backedge_blocks_.second.size());
+		bool backedges_exist = !(graph_->loops().empty() && graph_->loops2().empty());
 		//		for (set<CFGBlockPair>::iterator iter = workset_.begin(), end = workset_.end(); iter != end; ++iter) {
-		for (map<CFGBlockPair, State>::iterator iter = statespace_.begin(),
-				end = statespace_.end(); iter != end; ++iter) {
+		for (unsigned int id = statespace_.first(); id != statespace_.end(); id = statespace_.next(id)) {
+			CFGBlockPair pcs = graph_->Pair(id);
+			State &state = statespace_[id];
 #if(DEBUG1)
-			errs() << "Partitioning state at (" << iter->first.first->getBlockID() << "," << iter->first.second->getBlockID() << ")\n";
+			errs() << "Partitioning state at (" << pcs.first->getBlockID() << "," << pcs.second->getBlockID() << ")\n";
 #endif
+			StateAbstracts(state,before);
 			if (!backedges_exist) { // no back edges
-				iter->second.Partition();
+				state.Partition();
+				StateAbstracts(state,after);
+				changed |= (before != after);
 				continue;
 			}
-			CFGBlockPair pcs = iter->first;
 			//			if (Backedges(pcs)) { // partition at back-edges only
 			//prev_statespace_[iter->first] = iter->second;
-			iter->second.Partition();
+			state.Partition();
+			StateAbstracts(state,after);
+			changed |= (before != after);
 			//			}
 			// widen if threshold reached and either blocks have back-edges
-			if (visits_[pcs] > transformer_.getVal().widening_threshold_) {
+			if (visits_[id] > transformer_.getVal().Context().widening_threshold_) {
 				//TODO: if window size too small, widening won't occur as we will never reach the pair of back-edge blocks!
 				if (Backedges(pcs)) {
 					Widen(pcs);
+					changed = true;
 				}
 			}
 			//				new_statespace[iter->first] = iter->second;
 			//				new_workset.insert(iter->first);
 			//			}
 		}
-		cerr << "}\n";
+		Log() << "}\n";
 		//		if (backedge_blocks_.first.size()) {
 		//			prev_statespace_= statespace_;
 		//			workset_ = new_workset;
 		//			statespace_ = new_statespace;
 	}
+	return changed;
+}
+
+namespace {
+
+double Seconds() {
+	timeval now;
+	gettimeofday(&now,NULL);
+	return now.tv_sec + now.tv_usec / 1e6;
 }
 
-void IterativeSolver::RunOnCFGs(CFG * cfg_ptr,CFG * cfg2_ptr) {
+}
+
+// the version of the analysis the results are cached under (see ResultCache): bump it with any change to the
+// solver, the domain, the transfer functions or their helpers that may change a result
+const int IterativeSolver::kVersion = 4;
+
+IterativeSolver::Result IterativeSolver::RunOnCFGs(CFG * cfg_ptr,CFG * cfg2_ptr) {
+	const double start = Seconds();
+	Result result;
 	CFGBlockPair initial_pcs(*(cfg_ptr->rbegin()),*(cfg2_ptr->rbegin())),
 			exit_pcs(*(cfg_ptr->begin()),*(cfg2_ptr->begin()));
 	// initial state = { V==V' } (this resides in the transformer after assumeInputEquivalence() has been run)
 	State initial_state = transformer_.getVal();
 	int balance = 0;
+	// what degradation may change, restored for the next run
+	DomainContext &context = State::Context();
+	manager *mgr_ptr = context.mgr_ptr_;
+	const AnalysisConfiguration::PartitionStrategy partition_strategy = context.partition_strategy_;
+	const unsigned int widening_threshold = context.widening_threshold_;
+	unsigned int stage = 0, disjuncts = 0;
+	bool stopped = false;
 
-	initial_state.read_map_.clear();
+	initial_state.Context().read_map_.clear();
 
-	errs() << "Done parsing CFGs. Press Enter to continue...";
-	getchar();
+	if (!State::Context().quiet_) {
+		errs() << "Done parsing CFGs. Press Enter to continue...";
+		getchar();
 
-	cfg_ptr->dump(LangOptions());
-	cfg2_ptr->dump(LangOptions());
+		cfg_ptr->dump(LangOptions());
+		cfg2_ptr->dump(LangOptions());
 
-	errs() << "CFGs dumped. Press Enter to continue...";
-	getchar();
-
-	FindBackedges(initial_pcs.first,set<const CFGBlock*>(),backedge_blocks_.first );
-	FindBackedges(initial_pcs.second,set<const CFGBlock*>(),backedge_blocks_.second );
+		errs() << "CFGs dumped. Press Enter to continue...";
+		getchar();
+	}
 
-	errs() << "CFG 1 back-edges: {";
-	for (set<const CFGBlock*>::const_iterator iter = backedge_blocks_.first.begin(), end = backedge_blocks_.first.end(); iter != end; ++iter) {
-		errs() << (*iter)->getBlockID() << ",";
+	ProductGraph graph(*cfg_ptr,*cfg2_ptr,initial_pcs);
+	graph_ = &graph;
+	if (band_ || align_)
+		graph.Align();
+	unsigned int lockstep_windows = 0, windows = 0;
+	LoopAcceleration acceleration(graph.loops()), acceleration2(graph.loops2());
+	if (accelerate_) {
+		acceleration_ = &acceleration;
+		acceleration2_ = &acceleration2;
 	}
-	errs() << "}\n";
-	errs() << "CFG 2 back-edges: {";
-	for (set<const CFGBlock*>::const_iterator iter = backedge_blocks_.second.begin(), end = backedge_blocks_.second.end(); iter != end; ++iter) {
-		errs() << (*iter)->getBlockID() << ",";
+	TransferCache transfer_cache(transfer_cache_size_);
+	transfer_cache_ = &transfer_cache;
+	const CFGLoops *loops[2] = { &graph.loops(), &graph.loops2() };
+	const LoopAcceleration *accelerations[2] = { &acceleration, &acceleration2 };
+	for (unsigned int i = 0; i < 2; ++i) {
+		Log() << "CFG " << i + 1 << " loop heads: {";
+		for (set<const CFGBlock*>::const_iterator iter = loops[i]->heads().begin(), end = loops[i]->heads().end(); iter != end; ++iter) {
+			Log() << (*iter)->getBlockID() << "(depth " << loops[i]->Depth(*iter)
+				  << (accelerate_ && accelerations[i]->Find(*iter) ? ", accelerated" : "") << "),";
+		}
+		Log() << "}" << (loops[i]->reducible() ? "" : " (irreducible)") << "\n";
 	}
-	errs() << "}\n";
-	errs() << "Back edges found. Press Enter to continue...";
-	getchar();
-	cerr << "Starting!\n";
+	if (!State::Context().quiet_) {
+		errs() << "Back edges found. Press Enter to continue...";
+		getchar();
+	}
+	Log() << "Starting!\n";
+#if(DEBUG)
+	errs() << "Product graph order: ";
+	for (unsigned int i = 0; i < graph.wto().size(); ++i) {
+		unsigned int id = graph.wto().Node(i);
+		CFGBlockPair pcs = graph.Pair(id);
+		errs() << (graph.wto().IsHead(id) ? "*(" : "(") << pcs.first->getBlockID() << "," << pcs.second->getBlockID() << ") ";
+	}
+	errs() << "\n";
+#endif
+
+	WorkerPool pool(workers_);
+	IterativeSolver synced; // what the pool's workers hold
 
 	// worklist = { (entry1,entry2) }, statespace = { (entry1,entry2)->{ V==V' } }
 	workset_.insert(initial_pcs);
-	statespace_[initial_pcs] = initial_state;
+	statespace_[Id(initial_pcs)] = initial_state;
+	map<unsigned int,State> candidates;
+	SeedCandidates(candidates);
+	if (candidates.size()) {
+		Log() << "Warm start: " << candidates.size() << " candidate invariants.\n";
+		result.warm_start = "validated";
+	}
+	// we want to speculate from the same point each iteration, the tree holds the snapshots taken from it
+	SpeculationTree tree(cfg_ptr,cfg2_ptr);
+	tree.Reset(*this);
 	while (!workset_.empty()) {
-		vector<IterativeSolver> results;
-		errs() << "Speculating over k = " << k_ << "...";
-		for (int i = 0, j = k_; i <= k_; ++i, --j) {
-			IterativeSolver is = *this; // we want to speculate from the same point each iteration
-			if (is.Speculate(cfg_ptr,cfg2_ptr,j,i))
-				results.push_back(is);
+		// the budgets are checked between windows, a window that is under way is finished
+		if (stage < DEGRADATION_STAGES && OverBudget(Seconds() - start,disjuncts,stage)) {
+			string name;
+			while (stage < DEGRADATION_STAGES && !Degrade(stage++,name))
+				;
+			if (name.size()) {
+				Log() << "Over budget, degrading to " << name << ".\n";
+				result.degradations.push_back(name);
+				tree.Reset(*this);
+				pool.Stop(); // the workers are forked again with the degraded settings
+				// a degraded run is no longer comparable with the candidates (and may be in another domain)
+				if (candidates.size()) {
+					result.warm_start = "unvalidated";
+					candidates.clear();
+				}
+			}
 		}
-#if(DEBUG1)
-		cerr << "Results:\n";
-		int i = 0;
-		for (vector<IterativeSolver>::const_iterator solvers_iter = results.begin(), solvers_end = results.end(); solvers_iter != solvers_end; ++solvers_iter) {
-			IterativeSolver s = *solvers_iter;
-			errs() << "Solver #" << ++i << " : " << s << "\n";
+		// the last stage does not make a run converge any faster, past the whole budget it stops where it is
+		if (stage == DEGRADATION_STAGES && Exhausted(Seconds() - start)) {
+			Log() << "Out of budget, stopping.\n";
+			result.degradations.push_back("stop");
+			stopped = true;
+			break;
 		}
-#endif
-		// pick the best result and proceed from it
-		*this = FindMinimalDiffSolver(cfg_ptr,cfg2_ptr,results);
-		steps_++;
-		if (p_ && (steps_ % p_ == 0))
-			Partition();
-		errs() << "done.\n";
+		IterativeSolver chosen;
+		Interleaving interleaving;
+		unsigned int explored = 0;
+		++windows;
+		if (align_ && Lockstep(tree,chosen,interleaving)) {
+			Log() << "Stepping over matched blocks...";
+			explored = 1;
+			++lockstep_windows;
+		} else if (pool.size() > 1) {
+			Log() << "Speculating over k = " << k_ << "...";
+			explored = SpeculateInParallel(pool,synced,tree,cfg_ptr,cfg2_ptr,chosen,interleaving);
+		} else {
+			Log() << "Speculating over k = " << k_ << "...";
+			explored = SpeculateSerially(tree,cfg_ptr,cfg2_ptr,chosen,interleaving);
+		}
+		// proceed from the first c steps of the best result
+		Interleaving commit = SpeculationTree::Prefix(interleaving,c_);
+		unsigned int steps = steps_;
+		if (commit.size() == interleaving.size()) {
+			*this = chosen;
+		} else {
+			bool can_advance = false;
+			*this = tree.Get(commit,can_advance);
+			if (explored > 1)
+				changed_.clear();
+		}
+		steps_ = steps + 1; // snapshots kept from earlier windows carry an older count
+		disjuncts = 0;
+		for (unsigned int id = statespace_.first(); id != statespace_.end(); id = statespace_.next(id)) {
+			disjuncts = max<unsigned int>(disjuncts,statespace_.find(id)->abs_set_.size());
+		}
+		result.peak_disjuncts = max(result.peak_disjuncts,disjuncts);
+		if (candidates.size() && Refuted(candidates)) {
+			Log() << "Warm start: a candidate invariant does not hold, starting over.\n";
+			result.warm_start = "refuted";
+			candidates.clear();
+			workset_.clear();
+			changed_.clear();
+			statespace_.clear();
+			prev_statespace_.clear();
+			visits_.clear();
+			scores_.clear();
+			workset_.insert(initial_pcs);
+			statespace_[Id(initial_pcs)] = initial_state;
+			tree.Reset(*this);
+			Log() << "done.\n";
+			continue;
+		}
+		// the snapshots below the committed one are still valid, unless partitioning or widening changed it
+		if (p_ && (steps_ % p_ == 0) && Partition()) {
+			tree.Reset(*this);
+		} else {
+			tree.Reroot(commit,*this);
+		}
+		Log() << "done.\n";
 	}
+	if (align_)
+		Log() << "Alignment: " << lockstep_windows << " of " << windows << " windows stepped over matched blocks.\n";
+	if (pool.size() == 1)
+		Log() << "Speculation: " << tree.computed() << " steps computed for " << tree.requested() << " speculated steps.\n";
 	// print the result at exit point
-	outs() << "Result:\n" << *this << '\n';
+	if (!State::Context().quiet_)
+		outs() << "Result:\n" << *this << '\n';
 	State delta_minus,delta_plus;
-	string exit_delta = statespace_[exit_pcs].ComputeDiff(true,false,false,delta_minus,delta_plus);
-	outs() << "Delta at (EXIT,EXIT):\n" << (exit_delta.size() ? exit_delta : "Empty.") << '\n';
+	result.exit_delta = statespace_[Id(exit_pcs)].ComputeDiff(true,false,false,delta_minus,delta_plus);
+	stringstream exit_state;
+	Serialization::WriteState(exit_state,statespace_[Id(exit_pcs)]);
+	result.states.push_back(make_pair(exit_pcs,exit_state.str()));
 
-	for (CFG::const_iterator iter = cfg_ptr->begin(), end = cfg_ptr->end(); iter != end; ++iter) {
-		for (CFG::const_iterator iter2 = cfg2_ptr->begin(), end2 = cfg2_ptr->end(); iter2 != end2; ++iter2) {
+	// the blocks that call printf are found once per CFG, rather than once per pair
+	vector<const CFGBlock *> printfs, printfs2;
+	CFG *cfgs[2] = { cfg_ptr, cfg2_ptr };
+	vector<const CFGBlock *> *printf_blocks[2] = { &printfs, &printfs2 };
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (CFG::const_iterator iter = cfgs[i]->begin(), end = cfgs[i]->end(); iter != end; ++iter) {
+			string s;
+			raw_string_ostream ros(s);
+			(*iter)->print(ros,cfgs[i],LangOptions());
+			if (ros.str().find("printf") != ros.str().npos)
+				printf_blocks[i]->push_back(*iter);
+		}
+	}
+	for (vector<const CFGBlock *>::const_iterator iter = printfs.begin(), end = printfs.end(); iter != end; ++iter) {
+		for (vector<const CFGBlock *>::const_iterator iter2 = printfs2.begin(), end2 = printfs2.end(); iter2 != end2; ++iter2) {
 			CFGBlockPair printf_pcs(*iter,*iter2);
-			string s,s2;
-			raw_string_ostream ros(s),ros2(s2);
-			printf_pcs.first->print(ros,cfg_ptr,LangOptions());
-			printf_pcs.second->print(ros2,cfg2_ptr,LangOptions());
-			if (ros.str().find("printf") != ros.str().npos && ros2.str().find("printf") != ros2.str().npos) {
-				outs() << "State at (" << printf_pcs.first->getBlockID() << "," << printf_pcs.second->getBlockID() << ") : " << statespace_[printf_pcs];
-				string delta = statespace_[printf_pcs].ComputeDiff(true,false,false,delta_minus,delta_plus);
-				outs() << "Delta at (" << printf_pcs.first->getBlockID() << "," << printf_pcs.second->getBlockID() << ") (blocks contain printf): "<< (delta.size() ? delta : "Empty.") << '\n';
-			}
+			if (!State::Context().quiet_)
+				outs() << "State at (" << printf_pcs.first->getBlockID() << "," << printf_pcs.second->getBlockID() << ") : " << statespace_[Id(printf_pcs)];
+			string delta = statespace_[Id(printf_pcs)].ComputeDiff(true,false,false,delta_minus,delta_plus);
+			result.deltas.push_back(make_pair(printf_pcs,delta));
+			stringstream state;
+			Serialization::WriteState(state,statespace_[Id(printf_pcs)]);
+			result.states.push_back(make_pair(printf_pcs,state.str()));
 		}
 	}
+	// the loop heads, the candidate invariants of a later run
+	for (unsigned int id = statespace_.first(); id != statespace_.end(); id = statespace_.next(id)) {
+		CFGBlockPair pcs = graph.Pair(id);
+		if (!Backedges(pcs))
+			continue;
+		stringstream state;
+		Serialization::WriteState(state,*statespace_.find(id));
+		result.states.push_back(make_pair(pcs,state.str()));
+	}
+	pool.Stop();
+	graph_ = NULL; // the product graph does not outlive the run
+	acceleration_ = acceleration2_ = NULL;
+	transfer_cache_ = NULL;
+	result.transfer_hits = transfer_cache.hits();
+	result.transfer_misses = transfer_cache.misses();
+	if (result.transfer_hits + result.transfer_misses)
+		Log() << "Transfer cache: " << result.transfer_hits << " hits, " << result.transfer_misses << " misses ("
+			  << (100 * result.transfer_hits / (result.transfer_hits + result.transfer_misses)) << "%).\n";
+	if (context.mgr_ptr_ != mgr_ptr) {
+		context.ForgetAbstracts(); // the states of the degraded domain are not used after the run
+		delete context.mgr_ptr_;
+		context.mgr_ptr_ = mgr_ptr;
+	}
+	context.partition_strategy_ = partition_strategy;
+	context.widening_threshold_ = widening_threshold;
+	// the states of a stopped run are not a fixpoint: neither an empty delta nor the deltas found are conclusive
+	result.verdict = stopped ? "unknown" : (result.exit_delta.size() ? "delta" : "equivalent");
+	result.steps = steps_;
+	result.seconds = Seconds() - start;
+	return result;
 }
 
-bool IterativeSolver::Backedges(const CFGBlockPair& pcs) {
-	if ((backedge_blocks_.first.count(pcs.first) && backedge_blocks_.second.size() == 0) ||
-			(backedge_blocks_.second.count(pcs.second) && backedge_blocks_.first.size() == 0)) {
+void IterativeSolver::PrintDeltas(raw_ostream &os, const Result &result) {
+	os << "Delta at (EXIT,EXIT):\n" << (result.exit_delta.size() ? result.exit_delta : "Empty.") << '\n';
+	for (vector< pair<CFGBlockPair,string> >::const_iterator iter = result.deltas.begin(), end = result.deltas.end(); iter != end; ++iter) {
+		os << "Delta at (" << iter->first.first->getBlockID() << "," << iter->first.second->getBlockID() << ") (blocks contain printf): "
+		   << (iter->second.size() ? iter->second : "Empty.") << '\n';
+	}
+}
+
+// stage s is due once (DEGRADATION_STAGES + s) / (2 * DEGRADATION_STAGES) of a budget is spent: the first half
+// runs as configured, and the stages are spread over the second
+bool IterativeSolver::OverBudget(double seconds, unsigned int disjuncts, unsigned int stage) const {
+	const unsigned int due = DEGRADATION_STAGES + stage, whole = 2 * DEGRADATION_STAGES;
+	if (step_budget_ && (double)steps_ * whole >= (double)step_budget_ * due)
 		return true;
-	} else if (visits_[pcs] < 2 * transformer_.getVal().widening_threshold_) {
-		return (backedge_blocks_.first.count(pcs.first) && backedge_blocks_.second.count(pcs.second));
-	} else {// adaptive - if we can't break out of the loop after trying for a while
-		return (backedge_blocks_.first.count(pcs.first) || backedge_blocks_.second.count(pcs.second));
+	if (time_budget_ && seconds * whole >= (double)time_budget_ * due)
+		return true;
+	return disjunct_budget_ && disjuncts > disjunct_budget_;
+}
+
+// the whole of the time or step budget is spent (the disjunct budget only ever degrades a run)
+bool IterativeSolver::Exhausted(double seconds) const {
+	return (step_budget_ && steps_ >= step_budget_) || (time_budget_ && seconds >= time_budget_);
+}
+
+bool IterativeSolver::Degrade(unsigned int stage, string &name) {
+	DomainContext &context = State::Context();
+	switch (stage) {
+	case DEGRADE_JOIN_ALL:
+		if (context.partition_strategy_ == AnalysisConfiguration::JOIN_ALL)
+			return false;
+		context.partition_strategy_ = AnalysisConfiguration::JOIN_ALL;
+		Partition();
+		name = "join-all";
+		return true;
+	case DEGRADE_WINDOW:
+		if (k_ <= 1)
+			return false;
+		k_ = c_ = 1;
+		name = "k=1";
+		return true;
+	case DEGRADE_DOMAIN: {
+		// polyhedra and grids to octagons, octagons to boxes
+		string library = context.mgr_ptr_->get_library();
+		if (library.find("box") != string::npos)
+			return false;
+		bool octagons = library.find("oct") != string::npos;
+		ChangeManager(octagons ? (manager*)new box_manager() : (manager*)new oct_manager());
+		name = octagons ? "domain=box" : "domain=oct";
+		return true;
+	}
+	case DEGRADE_WIDENING:
+		if (context.widening_threshold_ == 0 && p_ == 1)
+			return false;
+		context.widening_threshold_ = 0;
+		p_ = 1;
+		name = "widen-always";
+		return true;
+	}
+	return false;
+}
+
+// the states are written out as constraints and read back in the new domain, which over-approximates them
+void IterativeSolver::ChangeManager(manager *mgr_ptr) {
+	StateSpace *spaces[2] = { &statespace_, &prev_statespace_ };
+	vector< pair<unsigned int,string> > states[2];
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (unsigned int id = spaces[i]->first(); id != spaces[i]->end(); id = spaces[i]->next(id)) {
+			stringstream ss;
+			Serialization::WriteState(ss,*spaces[i]->find(id));
+			states[i].push_back(make_pair(id,ss.str()));
+		}
+	}
+	// the run's manager is restored (and this one freed) at the end of the run
+	if (transfer_cache_)
+		transfer_cache_->Clear(); // its disjuncts are of the old domain
+	DomainContext &context = State::Context();
+	// no state of the run refers to the old abstracts once they are all read back (the snapshots that still do
+	// are dropped without being used), and freeing them keeps a degraded run from keeping the old domain's too
+	context.mgr_ptr_ = mgr_ptr;
+	context.ForgetAbstracts();
+	for (unsigned int i = 0; i < 2; ++i) {
+		for (vector< pair<unsigned int,string> >::const_iterator iter = states[i].begin(), end = states[i].end(); iter != end; ++iter) {
+			stringstream ss(iter->second);
+			bool read = Serialization::ReadState(ss,(*spaces[i])[iter->first]);
+			assert(read && "malformed state.");
+		}
+	}
+	scores_.clear();
+	transformer_.getVal() = State();
+	transformer_.getNVal() = State();
+}
+
+namespace {
+
+const string kIterations = Defines::kTempPrefix + "Iterations";
+
+// x := x + t * translation[x] for every x of translation, for any t >= 0
+void Translate(IterativeSolver::State &state, const map<string,long> &translation) {
+	manager &mgr = *IterativeSolver::State::Context().mgr_ptr_;
+	var t(kIterations);
+	AbstractSet translated;
+	for (AbstractSet::const_iterator iter = state.abs_set_.begin(), end = state.abs_set_.end(); iter != end; ++iter) {
+		abstract1 abs = iter->vars;
+		environment env = abs.get_environment(), multiplied = env.add(&t,1,0,0);
+		abs.change_environment(mgr,multiplied);
+		abstract1 positive = AnalysisUtils::AbsFromConstraint(mgr,tcons1(texpr1(multiplied,t) >= AnalysisUtils::kZero));
+		positive.change_environment(mgr,multiplied);
+		abs.meet(mgr,positive);
+		for (map<string,long>::const_iterator var_iter = translation.begin(), var_end = translation.end(); var_iter != var_end; ++var_iter) {
+			var x(var_iter->first);
+			if (!env.contains(x))
+				continue;
+			abs.assign(mgr,x,texpr1(texpr1(multiplied,x) + texpr1::builder(multiplied,(int)var_iter->second) * texpr1(multiplied,t)));
+		}
+		abs.change_environment(mgr,env);
+		if (!abs.is_bottom(mgr))
+			translated.insert(Abstract2(abs,iter->guards));
 	}
+	state.abs_set_ = translated;
+}
+
+}
+
+/**
+ * Joins into the state at a pair of loop heads the states after any number of iterations of their accelerated
+ * loops (in lockstep when both are): one iteration, then the states staying in the loop translated by any
+ * multiple of the increments, followed by a last iteration. The head's condition is convex, so a translated
+ * state that satisfies it satisfied it at every iteration in between.
+ */
+void IterativeSolver::Accelerate(const CFGBlockPair &pcs, State &state) {
+	const LoopAcceleration::Loop *loops[2] = { acceleration_->Find(pcs.first), acceleration2_->Find(pcs.second) };
+	if (!loops[FIRST_GRAPH] && !loops[SECOND_GRAPH])
+		return;
+	Log() << "Accelerating at (" << pcs.first->getBlockID() << ',' << pcs.second->getBlockID() << ").\n";
+	// the transformer is in the middle of advancing over a block
+	State val = transformer_.getVal(), nval = transformer_.getNVal();
+	const bool tag = transformer_.tag_;
+	State once = state;
+	map<string,long> translation;
+	for (unsigned int i = FIRST_GRAPH; i <= SECOND_GRAPH; ++i) {
+		if (!loops[i])
+			continue;
+		Iterate(*loops[i],(GraphPick)i,false,once);
+		for (map<string,long>::const_iterator iter = loops[i]->translation.begin(), end = loops[i]->translation.end(); iter != end; ++iter) {
+			translation[(i == SECOND_GRAPH ? Defines::kTagPrefix : "") + iter->first] = iter->second;
+		}
+	}
+	if (translation.size()) {
+		State more = once;
+		for (unsigned int i = FIRST_GRAPH; i <= SECOND_GRAPH; ++i) {
+			if (loops[i])
+				Iterate(*loops[i],(GraphPick)i,true,more);
+		}
+		Translate(more,translation);
+		for (unsigned int i = FIRST_GRAPH; i <= SECOND_GRAPH; ++i) {
+			if (loops[i])
+				Iterate(*loops[i],(GraphPick)i,false,more);
+		}
+		once.Join(more);
+	}
+	state.Join(once);
+	transformer_.getVal() = val;
+	transformer_.getNVal() = nval;
+	transformer_.tag_ = tag;
+}
+
+// as AdvanceOnBlock does over the head and then over the blocks of the path
+void IterativeSolver::Iterate(const LoopAcceleration::Loop &loop, GraphPick which, bool enter_only, State &state) {
+	transformer_.tag_ = (which == SECOND_GRAPH);
+	transformer_.getVal() = state;
+	transformer_.ApplyBlock(loop.head);
+	transformer_.getNVal() = transformer_.getVal();
+	transformer_.ApplyCondition(loop.head);
+	state = loop.on_true ? transformer_.getVal() : transformer_.getNVal();
+	if (enter_only || state.size() == 0)
+		return;
+	transformer_.getVal() = state;
+	for (vector<const CFGBlock *>::const_iterator block = loop.path.begin(), block_end = loop.path.end(); block != block_end; ++block) {
+		transformer_.ApplyBlock(*block);
+	}
+	state = transformer_.getVal();
+}
+
+void IterativeSolver::Transfer(const CFGBlock *block, GraphPick which, const State &state) {
+	State val = state;
+	val.abs_set_.clear();
+	transformer_.Declarations(block,val.env_);
+	State nval = val;
+	for (AbstractSet::const_iterator iter = state.abs_set_.begin(), end = state.abs_set_.end(); iter != end; ++iter) {
+		TransferCache::Key key(block->getBlockID(),which == SECOND_GRAPH,*iter);
+		const TransferCache::Entry *entry = transfer_cache_->Find(key);
+		if (!entry) {
+			State disjunct = state;
+			disjunct.abs_set_.clear();
+			disjunct.abs_set_.insert(*iter);
+			transformer_.getVal() = disjunct;
+			transformer_.ApplyBlock(block);
+			transformer_.getNVal() = transformer_.getVal();
+			transformer_.ApplyCondition(block); // none, unless the terminator is an if or a for
+			entry = &transfer_cache_->Store(key,transformer_.getVal().abs_set_,transformer_.getNVal().abs_set_);
+		}
+		val.abs_set_.insert(entry->val.begin(),entry->val.end());
+		nval.abs_set_.insert(entry->nval.begin(),entry->nval.end());
+	}
+	transformer_.getVal() = val;
+	transformer_.getNVal() = nval;
+}
+
+// the candidates at loop heads the product graph reaches, which join the work set
+void IterativeSolver::SeedCandidates(map<unsigned int,State> &candidates) {
+	candidates.clear();
+	if (!warm_start_)
+		return;
+	for (vector< pair<CFGBlockPair,string> >::const_iterator iter = warm_start_->begin(), end = warm_start_->end(); iter != end; ++iter) {
+		const CFGBlockPair &pcs = iter->first;
+		if (!Backedges(pcs) || graph_->wto().Position(Id(pcs)) == WeakTopologicalOrder::UNORDERED || candidates.count(Id(pcs)))
+			continue;
+		State candidate;
+		stringstream ss(iter->second);
+		if (!Serialization::ReadState(ss,candidate) || candidate.size() == 0)
+			continue;
+		candidates[Id(pcs)] = candidate;
+		statespace_[Id(pcs)] = candidate;
+		workset_.insert(pcs);
+	}
+}
+
+// whether the state at a seeded head has left its candidate: what reached it is not covered by the candidate
+bool IterativeSolver::Refuted(const map<unsigned int,State> &candidates) const {
+	for (map<unsigned int,State>::const_iterator iter = candidates.begin(), end = candidates.end(); iter != end; ++iter) {
+		const State *state = statespace_.find(iter->first);
+		if (state && !(*state <= iter->second))
+			return true;
+	}
+	return false;
+}
+
+// widening points are the pairs where either block is a loop head of its CFG: a cycle of the product graph
+// is a cycle of at least one of the CFGs, and so goes through one of its heads
+bool IterativeSolver::Backedges(const CFGBlockPair& pcs) {
+	return graph_->loops().IsHead(pcs.first) || graph_->loops2().IsHead(pcs.second);
 }
 
 /**
  * Advances on all the edges of one of the blocks (according to @advance_on_first) and updates the state space.
  */
 void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, GraphPick which) {
-	if (visits_.count(pcs) == 0) {
-		visits_[pcs] = 0;
+	if (visits_.count(Id(pcs)) == 0) {
+		visits_[Id(pcs)] = 0;
 	}
 	/**
 	 * TODO: when/if we introduce correlation point, set the state flag accordingly
-	 * statespace_[pcs].at_diff_point_ = ?;
+	 * statespace_[Id(pcs)].at_diff_point_ = ?;
 	 */
 
 	//	if (Backedges(pcs)) { // partition all states every time we arrive at a pair of back edges
@@ -622,34 +1651,32 @@ void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, Gra
 		stay_block = pcs.first;
 	}
 #if(DEBUG)
-	errs() << "Advancing from (" << pcs.first->getBlockID() << "," << pcs.second->getBlockID() << ") on CFG " << which + 1 << " block (visit number " << visits_[pcs] << ")\n";
+	errs() << "Advancing from (" << pcs.first->getBlockID() << "," << pcs.second->getBlockID() << ") on CFG " << which + 1 << " block (visit number " << visits_[Id(pcs)] << ")\n";
 #endif
 #if(DEBUG)
 	advance_block->print(errs(),&cfg,LangOptions());
-	errs() << "Transforming from state: " << statespace_[pcs] << "\n";
+	errs() << "Transforming from state: " << statespace_[Id(pcs)] << "\n";
 #endif
 
-	visits_[pcs]++;
+	visits_[Id(pcs)]++;
 
-	// apply the effect of advancing over a block (by iterating over the block statements)
-	transformer_.getVal() = statespace_[pcs]; // start off from the current state
-	for ( CFGBlock::const_iterator iter = advance_block->begin(), end = advance_block->end(); iter != end; ++iter ) {
-		CFGElement e = *iter;
-		if ( const CFGStmt *statement = e.getAs<CFGStmt>()) {
-			// apply the statement
-#if(DEBUG1)
-			statement->getStmt()->dump();
-#endif
-			transformer_.BlockStmt_Visit(const_cast<Stmt*>(statement->getStmt()));
+	// apply the effect of advancing over a block (by replaying the block's compiled statements), or look it up
+	const State &state = statespace_[Id(pcs)];
+	const bool cached = transfer_cache_ && transfer_cache_->enabled() && state.size() > 0 && transformer_.Distributive(advance_block);
+	if (cached) {
+		Transfer(advance_block,which,state); // the terminator's condition included
+	} else {
+		transformer_.getVal() = state; // start off from the current state
+		transformer_.ApplyBlock(advance_block);
+	}
 #if(DEBUG1)
-			errs() << "\nState after statement: " << transformer_.getVal() << "\n";
+	errs() << "\nState after block: " << transformer_.getVal() << "\n";
 #endif
-		}
-	}
 
 	// visit terminator
 	if (const Stmt * terminator_statement = advance_block->getTerminator().getStmt()) {
-		transformer_.getNVal() = transformer_.getVal();
+		if (!cached)
+			transformer_.getNVal() = transformer_.getVal();
 #if(DEBUG1)
 		errs() << "Terminator :";
 		terminator_statement->dump();
@@ -669,7 +1696,8 @@ void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, Gra
 		case Stmt::IfStmtClass:
 		case Stmt::ForStmtClass:
 		{
-			transformer_.BlockStmt_Visit(const_cast<Stmt*>(terminator_statement));
+			if (!cached)
+				transformer_.ApplyCondition(advance_block);
 			const CFGBlock *last_succ = (advance_block->succ_size() > 1) ? *(advance_block->succ_begin() + 1) : NULL;
 			if (last_succ) {
 				CFGBlockPair new_pcs = (which == FIRST_GRAPH) ?
@@ -677,7 +1705,7 @@ void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, Gra
 						make_pair(stay_block,last_succ);
 				AdvanceOnEdge(new_pcs,true,false);
 #if(DEBUG)
-				errs() << "State at new pcs: (" << new_pcs.first->getBlockID() << "," << new_pcs.second->getBlockID() << ") :"<< statespace_[new_pcs];
+				errs() << "State at new pcs: (" << new_pcs.first->getBlockID() << "," << new_pcs.second->getBlockID() << ") :"<< statespace_[Id(new_pcs)];
 #endif
 			}
 			break;
@@ -727,7 +1755,7 @@ void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, Gra
 				make_pair(stay_block,first_succ);
 		AdvanceOnEdge(new_pcs,advance_block->succ_size() > 1,true);
 #if(DEBUG)
-		errs() << "State at new pcs: (" << new_pcs.first->getBlockID() << "," << new_pcs.second->getBlockID() << ") :"<< statespace_[new_pcs];
+		errs() << "State at new pcs: (" << new_pcs.first->getBlockID() << "," << new_pcs.second->getBlockID() << ") :"<< statespace_[Id(new_pcs)];
 #endif
 	}
 
@@ -737,7 +1765,9 @@ void IterativeSolver::AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, Gra
 }
 
 void IterativeSolver::AdvanceOnEdge(const CFGBlockPair &new_pcs, bool conditional, bool true_branch) {
-	prev_statespace_[new_pcs] = statespace_[new_pcs]; // save the previous state of new_pcs
+	const unsigned int id = Id(new_pcs);
+	State &state = statespace_[id], &prev_state = prev_statespace_[id];
+	prev_state = state; // save the previous state of new_pcs
 	State final_state;
 	if (!conditional || true_branch) {
 		final_state = transformer_.getVal(); // non-conditional or a true branch
@@ -749,25 +1779,26 @@ void IterativeSolver::AdvanceOnEdge(const CFGBlockPair &new_pcs, bool conditiona
 	errs() << "Advanced on edge, meeting with " << final_state << "\n";
 #endif
 
-	statespace_[new_pcs] = statespace_[new_pcs].Join(final_state);
-	State state = statespace_[new_pcs], prev_state = prev_statespace_[new_pcs];
+	state.Join(final_state);
 	changed_.insert(new_pcs);
 
 	// see if the resulting state of new_pcs > previous state or this is the first visit
-	if ((prev_statespace_[new_pcs].size() == 0 &&  statespace_[new_pcs].size() > 0) ||
+	if ((prev_state.size() == 0 && state.size() > 0) ||
 			!(state <= prev_state)) {
+		if (acceleration_ && Backedges(new_pcs))
+			Accelerate(new_pcs,state);
 		//		if (Backedges(new_pcs)) {
 		//			cerr << state << " <= " << prev_state << " ? " << (state <= prev_state) << endl;
 		//			getchar();
 		//		}
 #if(1)
-		//		if (visits_[new_pcs] > transformer_.getVal().widening_threshold_) {
-		errs() << "("<< new_pcs.first->getBlockID() << ',' << new_pcs.second->getBlockID() <<
-				") added to workset, visit #" << visits_[new_pcs] << ".\n";// << statespace_[new_pcs];
+		//		if (visits_[Id(new_pcs)] > transformer_.getVal().Context().widening_threshold_) {
+		Log() << "("<< new_pcs.first->getBlockID() << ',' << new_pcs.second->getBlockID() <<
+				") added to workset, visit #" << visits_[id] << ".\n";// << state;
 		//			getchar();
 		//		}
 #endif
-		//		cerr << "Added (" << new_pcs.first->getBlockID() << ',' << new_pcs.second->getBlockID() << ") : " << statespace_[new_pcs]  << " to workset.\n";
+		//		cerr << "Added (" << new_pcs.first->getBlockID() << ',' << new_pcs.second->getBlockID() << ") : " << statespace_[Id(new_pcs)]  << " to workset.\n";
 		//		getchar();
 		workset_.insert(new_pcs); // if so, add it to the work set
 	}
@@ -775,15 +1806,17 @@ void IterativeSolver::AdvanceOnEdge(const CFGBlockPair &new_pcs, bool conditiona
 
 #define DEBUGWiden 0
 void IterativeSolver::Widen(const CFGBlockPair pcs) {
-	errs() << "Widening at ("<< pcs.first->getBlockID() << ',' << pcs.second->getBlockID() << ").\n";
+	Log() << "Widening at ("<< pcs.first->getBlockID() << ',' << pcs.second->getBlockID() << ").\n";
+	const unsigned int id = Id(pcs);
+	State &state = statespace_[id], &prev_state = prev_statespace_[id];
 #if(DEBUGWiden)
-	errs() << " from: " << prev_statespace_[pcs] << "," << statespace_[pcs];
+	errs() << " from: " << prev_state << "," << state;
 #endif
 	State result;
-	statespace_[pcs].Widening(prev_statespace_[pcs],statespace_[pcs],result);
-	prev_statespace_[pcs] = statespace_[pcs];
-	statespace_[pcs] = result;
-	if (!(statespace_[pcs] <= prev_statespace_[pcs]))
+	state.Widening(prev_state,state,result);
+	prev_state = state;
+	state = result;
+	if (!(state <= prev_state))
 		workset_.insert(pcs);
 #if(DEBUGWiden)
 	errs() << " to " << result;
@@ -11,7 +11,12 @@
 #include "AnalysisUtils.h"
 #include "AnalysisConfiguration.h"
 #include "APAbstractDomain.h"
+#include "LoopAcceleration.h"
+#include "PagedArray.h"
+#include "ProductGraph.h"
+#include "TransferCache.h"
 #include "TransferFuncs.h"
+#include "WorkerPool.h"
 
 #include <clang/Analysis/CFG.h>
 using namespace clang;
@@ -23,28 +28,68 @@ namespace differential {
 
 enum { MAX_K = 20 };
 
+class SpeculationTree;
+
 class IterativeSolver {
 
 public:
 
-	IterativeSolver() {} // deault c'tor defined for threading
+	IterativeSolver() : time_budget_(0), step_budget_(0), disjunct_budget_(0), warm_start_(NULL), accelerate_(false), band_(0), align_(false),
+		transfer_cache_size_(AnalysisConfiguration::kTransferCacheSize), graph_(NULL), acceleration_(NULL), acceleration2_(NULL),
+		transfer_cache_(NULL) {}
 
-	IterativeSolver(APAbstractDomain domain, unsigned int k, unsigned int p) : transformer_(domain.getAnalysisData()), k_(k), p_(p), steps_(0) { assert(k <= MAX_K); }
+	IterativeSolver(APAbstractDomain domain, unsigned int k, unsigned int p, unsigned int c = 0, bool por = false, unsigned int workers = 1) :
+		transformer_(domain.getAnalysisData()), k_(k), p_(p), steps_(0), c_((c && c < k) ? c : k), por_(por), workers_(workers),
+		time_budget_(0), step_budget_(0), disjunct_budget_(0), warm_start_(NULL), accelerate_(false), band_(0), align_(false),
+		transfer_cache_size_(AnalysisConfiguration::kTransferCacheSize), graph_(NULL), acceleration_(NULL), acceleration2_(NULL),
+		transfer_cache_(NULL) { assert(k <= MAX_K); }
 	virtual ~IterativeSolver() { }
 
 	void AssumeInputEquivalence(const FunctionDecl * fd,const FunctionDecl * fd2);
+	void AssumeSummaryInput(const FunctionDecl * fd,const FunctionDecl * fd2); // unrelated parameters, kept in I_<param> (see FunctionSummaries)
 	void AssumeInitialEquivalence(Stmt* root, ASTContext &context, bool tag); // search CFG for declarations and UFs and assume equivalence for them
-
-	void RunOnCFGs(CFG * cfg_ptr,CFG * cfg2_ptr);
+	// the calls both versions make return the same values: assumed once here rather than at every visit of a call
+	void AssumeCallEquivalence(const FunctionDecl * fd,const FunctionDecl * fd2);
 
 	typedef APAbstractDomain_ValueTypes::ValTy State;
 	typedef pair<const CFGBlock *,const CFGBlock *> CFGBlockPair;
-	pair < set< const CFGBlock *>,set< const CFGBlock *> > backedge_blocks_;
+
+	// the outcome of a run: the verdict, the deltas, and what it took to get them
+	struct Result {
+		string verdict; // equivalent|delta (at the exit), or unknown when the run stopped out of budget
+		string exit_delta;
+		vector< pair<CFGBlockPair,string> > deltas; // at the pairs of blocks that both call printf
+		unsigned int steps;
+		double seconds;
+		unsigned int peak_disjuncts; // the most disjuncts a committed state had before partitioning
+		vector<string> degradations; // the cheaper settings the run switched to when over budget, in order
+		vector< pair<CFGBlockPair,string> > states; // at the exit, the deltas' pairs and the loop heads, serialized
+		bool cached; // read from the result cache rather than computed
+		string warm_start; // none|validated|refuted (the run started over)|unvalidated (degraded before validating)
+		unsigned long transfer_hits, transfer_misses; // disjuncts whose transfer over a block was looked up, and computed
+		Result() : steps(0), seconds(0), peak_disjuncts(0), cached(false), warm_start("none"), transfer_hits(0), transfer_misses(0) { }
+	};
+	Result RunOnCFGs(CFG * cfg_ptr,CFG * cfg2_ptr);
+	// the deltas of a run, as RunOnCFGs' callers report them
+	static void PrintDeltas(raw_ostream &os, const Result &result);
+	static const int kVersion; // of the analysis, cached results of other versions are not reused
+	// progress output, silenced in batch mode
+	static raw_ostream &Log() { return State::Context().quiet_ ? nulls() : errs(); }
 
 	set< CFGBlockPair > workset_;
 	set< CFGBlockPair > changed_;
-	map< CFGBlockPair , State > statespace_, prev_statespace_;
-	map< CFGBlockPair , unsigned int > visits_;
+	// indexed by the pairs' ids in the product graph
+	typedef PagedArray<State> StateSpace;
+	StateSpace statespace_, prev_statespace_;
+	PagedArray<unsigned int> visits_;
+	// the equivalence score of a state, kept until the (interned) abstracts of the state change
+	struct StateScore {
+		vector<const abstract1*> vars; // the abstracts the score was computed for
+		bool scored; // empty states are not scored
+		float score;
+		StateScore() : scored(false), score(0) { }
+	};
+	PagedArray<StateScore> scores_;
 
 	enum { NOT_COMPUTED = -1, EQUIVALENCE = 0 };
 
@@ -52,17 +97,56 @@ public:
 
 	// this holds on which of the graphs {first,second} we advanced for each pair of nodes (effectively, this is the interleaving)
 	typedef enum { FIRST_GRAPH, SECOND_GRAPH } GraphPick ;
+	typedef vector<GraphPick> Interleaving; // the graph advanced on at each step of a speculation
+	static string ToString(const Interleaving &interleaving);
 	unsigned int k_, p_, steps_;
+	unsigned int c_; // number of steps of the chosen interleaving committed per window (the rest is speculated again)
+	bool por_; // speculate over all interleavings up to commuting steps, rather than over the k+1 splits only
+	unsigned int workers_; // number of worker processes used for speculation (1 = speculate in-process)
+	unsigned int time_budget_, step_budget_; // seconds and steps a run may take (0 = unbounded)
+	unsigned int disjunct_budget_; // disjuncts a committed state may have (0 = unbounded)
+	const vector< pair<CFGBlockPair,string> > *warm_start_; // candidate invariants (serialized) for the loop heads, or NULL
+	bool accelerate_; // summarize the loops that translate and reset variables by constants, rather than widen them
+	unsigned int band_; // speculation prefers to keep within this distance from the alignment of the CFGs (see ProductGraph), 0 = any
+	bool align_; // windows that start from matched pairs only (see ProductGraph) step both graphs once, without speculating
+	unsigned long transfer_cache_size_; // entries of the transfer cache (0 = no caching)
+	const ProductGraph *graph_; // shared by all the snapshots of a run
+	const LoopAcceleration *acceleration_, *acceleration2_; // of the CFGs of a run, shared likewise
+	TransferCache *transfer_cache_; // of a run, shared likewise
+
+	unsigned int Id(const CFGBlockPair &pcs) const { return graph_->Id(pcs); }
 
 	void AdvanceOnBlock(const CFG &cfg, const CFGBlockPair pcs, GraphPick which);
 	void AdvanceOnEdge(const CFGBlockPair &new_pcs, bool conditional, bool true_branch);
 	void Widen(const CFGBlockPair pcs);
-	IterativeSolver FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_ptr, vector<IterativeSolver> solvers);
+	unsigned int FindMinimalDiffSolver(CFG * cfg_ptr,CFG * cfg2_ptr, vector<IterativeSolver> &solvers);
+	float ComputeEquivalenceScore();
+	float SpeculationScore(); // the equivalence score, less 2 for a speculation that strays from the band
+	bool OutOfBand() const;
+	bool Score(unsigned int id, float &score); // false if the state at id is not scored
+	void ScoreLocations(const set<CFGBlockPair> &locations);
+	static unsigned int PickSolver(const vector<float> &score);
 	bool Step(CFG * cfg_ptr, CFG * other_cfg_ptr, GraphPick which);
+	void Schedule(vector<CFGBlockPair> &result) const;
 	bool Speculate(CFG * cfg_ptr,CFG * cfg2_ptr,unsigned int k1, unsigned int k2);
-
-	void Succesors(set<CFGBlockPair> pairs, GraphPick which, set<CFGBlockPair> &result);
-	void GetSuccesors(set<CFGBlockPair> &result, CFGBlockPair from_block, const CFGBlock * advance_block);
+	bool Lockstep(SpeculationTree &tree, IterativeSolver &chosen, Interleaving &interleaving);
+	void Interleavings(SpeculationTree &tree, vector<Interleaving> &result);
+	// both return the number of candidate interleavings, the chosen one is returned in interleaving and its result in chosen
+	unsigned int SpeculateSerially(SpeculationTree &tree, CFG * cfg_ptr, CFG * cfg2_ptr, IterativeSolver &chosen, Interleaving &interleaving);
+	// synced is the solver the pool's workers hold
+	unsigned int SpeculateInParallel(WorkerPool &pool, IterativeSolver &synced, SpeculationTree &tree, CFG * cfg_ptr, CFG * cfg2_ptr, IterativeSolver &chosen, Interleaving &interleaving);
+	bool SameSpeculation(const IterativeSolver &other) const;
+
+	// ship the result of a speculation (everything that changed relative to origin) between processes
+	void WriteSpeculation(ostream &os, const IterativeSolver &origin) const;
+	bool ReadSpeculation(istream &is);
+	// bring a worker holding synced up to this solver (everything that differs, and the array accesses)
+	void WriteSync(ostream &os, const IterativeSolver &synced) const;
+	bool ReadSync(istream &is);
+
+	void Succesors(set<CFGBlockPair> pairs, GraphPick which, set<CFGBlockPair> &result) const;
+	void GetSuccesors(set<CFGBlockPair> &result, CFGBlockPair from_block, const CFGBlock * advance_block) const;
+	bool CanPOR(void) const;
 
 	operator string() const {
 		stringstream ss;
@@ -71,8 +155,13 @@ public:
 			ss << "(" << iter->first->getBlockID() << "," << iter->second->getBlockID() << "),";
 		}
 		ss << " }\n";
-		for (map< CFGBlockPair , State >::const_reverse_iterator iter = statespace_.rbegin(), end = statespace_.rend(); iter != end; ++iter) {
-			ss << "(" << iter->first.first->getBlockID() << "," << iter->first.second->getBlockID() << ") : " << iter->second << "\n";
+		vector<unsigned int> ids;
+		for (unsigned int id = statespace_.first(); id != statespace_.end(); id = statespace_.next(id)) {
+			ids.push_back(id);
+		}
+		for (vector<unsigned int>::const_reverse_iterator iter = ids.rbegin(), end = ids.rend(); iter != end; ++iter) {
+			CFGBlockPair pcs = graph_->Pair(*iter);
+			ss << "(" << pcs.first->getBlockID() << "," << pcs.second->getBlockID() << ") : " << *statespace_.find(*iter) << "\n";
 		}
 		return ss.str();
 	}
@@ -83,23 +172,38 @@ public:
 	bool operator<(const IterativeSolver& rhs) const { return (*this != rhs) && (*this <= rhs); }
 
 private:
-	void FindBackedges(const CFGBlock* initial, set<const CFGBlock*> visited, set<const CFGBlock*> &result);
-	bool CanPOR(void);
+	// the locations, and the states of this that are not in origin or differ from origin's: changed by this
+	// solver's speculation (changed_), or by anything (compared)
+	void WriteDifference(ostream &os, const IterativeSolver &origin, bool compared) const;
+	void ReduceInterleavings(SpeculationTree &tree, Interleaving &prefix, const set<GraphPick> &sleep, vector<Interleaving> &result);
 	bool Backedges(const CFGBlockPair& pcs);
-	void Partition();
-
-	// experimental!
-	static void * SpeculateParallel(void * arguments);
-	static void * ComputeEquivalenceScoreParallel(void * arguments);
-};
-
-// for threading (experimental):
-struct ThreadArguments {
-	IterativeSolver is;
-	CFG * cfg_ptrs[2];
-	int k[2];
-	float score;
-	ThreadArguments() {}
+	void Accelerate(const CFGBlockPair &pcs, State &state);
+	// one iteration of loop from state (at its head), or only entering the loop when enter_only is set
+	void Iterate(const LoopAcceleration::Loop &loop, GraphPick which, bool enter_only, State &state);
+	// the block's statements and condition applied to state disjunct by disjunct, through the transfer cache
+	void Transfer(const CFGBlock *block, GraphPick which, const State &state);
+	bool Partition(); // true if any state was changed by partitioning or widening
+
+	/**
+	 * A warm start seeds the loop heads with candidate invariants (typically the states of an earlier run on a
+	 * previous version) and advances from them right away. As long as every state reaching a head stays within
+	 * its candidate, the candidates are inductive and the run stabilizes without widening; once one does not,
+	 * the run starts over from the entry alone.
+	 */
+	void SeedCandidates(map<unsigned int,State> &candidates);
+	bool Refuted(const map<unsigned int,State> &candidates) const;
+
+	/**
+	 * A run that goes over its budget degrades in stages, each cheaper than the one before, and still
+	 * runs to a fixpoint (so that its result is sound): joining all disjuncts when partitioning, no
+	 * speculation, a cheaper domain, and widening whenever a loop head's state is partitioned. A run that
+	 * has spent the whole of its time or step budget with every stage applied stops, with no verdict.
+	 */
+	enum { DEGRADE_JOIN_ALL, DEGRADE_WINDOW, DEGRADE_DOMAIN, DEGRADE_WIDENING, DEGRADATION_STAGES };
+	bool OverBudget(double seconds, unsigned int disjuncts, unsigned int stage) const;
+	bool Exhausted(double seconds) const;
+	bool Degrade(unsigned int stage, string &name); // false if the stage does not apply to the current settings
+	void ChangeManager(manager *mgr_ptr); // re-reads all the states in mgr_ptr's domain
 };
 
 }
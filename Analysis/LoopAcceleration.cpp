@@ -0,0 +1,202 @@
+/*
+ * LoopAcceleration.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "LoopAcceleration.h"
+
+#include <algorithm>
+
+namespace differential {
+
+namespace {
+
+// an integer literal, possibly negated
+bool Constant(const Expr *expr, long &value) {
+	expr = expr->IgnoreParenImpCasts();
+	if (const IntegerLiteral *literal = dyn_cast<IntegerLiteral>(expr)) {
+		value = (long)literal->getValue().getSExtValue();
+		return true;
+	}
+	if (const UnaryOperator *op = dyn_cast<UnaryOperator>(expr)) {
+		if (op->getOpcode() == UO_Minus && Constant(op->getSubExpr(),value)) {
+			value = -value;
+			return true;
+		}
+	}
+	return false;
+}
+
+// the name of an integer variable referred to by expr, empty if it is anything else
+string Variable(const Expr *expr) {
+	if (const DeclRefExpr *ref = dyn_cast<DeclRefExpr>(expr->IgnoreParenImpCasts())) {
+		if (const VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl())) {
+			if (decl->getType()->isIntegerType() && !decl->getType().isVolatileQualified())
+				return decl->getNameAsString();
+		}
+	}
+	return "";
+}
+
+// whether evaluating stmt changes nothing
+bool Pure(const Stmt *stmt) {
+	if (!stmt)
+		return true;
+	if (isa<CallExpr>(stmt) || isa<DeclStmt>(stmt) || isa<StmtExpr>(stmt))
+		return false;
+	if (const BinaryOperator *op = dyn_cast<BinaryOperator>(stmt)) {
+		if (op->isAssignmentOp() || op->isCompoundAssignmentOp())
+			return false;
+	}
+	if (const UnaryOperator *op = dyn_cast<UnaryOperator>(stmt)) {
+		if (op->isIncrementDecrementOp())
+			return false;
+	}
+	for (Stmt::child_iterator iter = const_cast<Stmt*>(stmt)->child_begin(), end = const_cast<Stmt*>(stmt)->child_end(); iter != end; ++iter) {
+		if (!Pure(*iter))
+			return false;
+	}
+	return true;
+}
+
+// the effect of an iteration so far, by variable: whether it was reset, and to what (or what was added to it)
+typedef map< string,pair<bool,long> > Effects;
+
+void Translate(Effects &effects, const string &name, long value) {
+	Effects::iterator effect = effects.find(name);
+	if (effect == effects.end())
+		effects[name] = make_pair(false,value);
+	else
+		effect->second.second += value;
+}
+
+// false if stmt does anything but translate or reset an integer variable by a constant
+bool Effect(const Stmt *stmt, Effects &effects) {
+	if (Pure(stmt))
+		return true;
+	long value = 0;
+	if (const UnaryOperator *op = dyn_cast<UnaryOperator>(stmt)) {
+		string name = Variable(op->getSubExpr());
+		if (!op->isIncrementDecrementOp() || name.empty())
+			return false;
+		Translate(effects,name,op->isIncrementOp() ? 1 : -1);
+		return true;
+	}
+	const BinaryOperator *op = dyn_cast<BinaryOperator>(stmt);
+	if (!op)
+		return false;
+	string name = Variable(op->getLHS());
+	if (name.empty())
+		return false;
+	switch (op->getOpcode()) {
+	case BO_AddAssign:
+	case BO_SubAssign:
+		if (!Constant(op->getRHS(),value))
+			return false;
+		Translate(effects,name,op->getOpcode() == BO_AddAssign ? value : -value);
+		return true;
+	case BO_Assign: {
+		const Expr *rhs = op->getRHS()->IgnoreParenImpCasts();
+		if (Constant(rhs,value)) {
+			effects[name] = make_pair(true,value);
+			return true;
+		}
+		// x = x + c, x = c + x, x = x - c
+		const BinaryOperator *sum = dyn_cast<BinaryOperator>(rhs);
+		if (!sum || (sum->getOpcode() != BO_Add && sum->getOpcode() != BO_Sub))
+			return false;
+		if (Variable(sum->getLHS()) == name && Constant(sum->getRHS(),value)) {
+			Translate(effects,name,sum->getOpcode() == BO_Add ? value : -value);
+			return true;
+		}
+		if (sum->getOpcode() == BO_Add && Variable(sum->getRHS()) == name && Constant(sum->getLHS(),value)) {
+			Translate(effects,name,value);
+			return true;
+		}
+		return false;
+	}
+	default:
+		return false;
+	}
+}
+
+bool ByID(const CFGBlock *a, const CFGBlock *b) {
+	return a->getBlockID() < b->getBlockID();
+}
+
+// the body is in block id order
+bool InBody(const vector<const CFGBlock *> &body, const CFGBlock *block) {
+	return binary_search(body.begin(), body.end(), block, ByID);
+}
+
+}
+
+LoopAcceleration::LoopAcceleration(const CFGLoops &loops) {
+	for (set<const CFGBlock *>::const_iterator iter = loops.heads().begin(), end = loops.heads().end(); iter != end; ++iter) {
+		Loop loop;
+		if (Analyze(*iter,loops,loop))
+			loops_[*iter] = loop;
+	}
+}
+
+const LoopAcceleration::Loop *LoopAcceleration::Find(const CFGBlock *head) const {
+	map<const CFGBlock *,Loop>::const_iterator loop = loops_.find(head);
+	return loop == loops_.end() ? NULL : &loop->second;
+}
+
+bool LoopAcceleration::Analyze(const CFGBlock *head, const CFGLoops &loops, Loop &loop) const {
+	const vector<const CFGBlock *> &body = loops.Body(head);
+	if (body.size() < 2)
+		return false;
+	// the head branches on an if or a for condition, one way into the body and the other out of it
+	const Stmt *terminator = head->getTerminator().getStmt();
+	if (!terminator || (terminator->getStmtClass() != Stmt::IfStmtClass && terminator->getStmtClass() != Stmt::ForStmtClass))
+		return false;
+	if (head->succ_size() != 2 || !*head->succ_begin() || !*(head->succ_begin() + 1))
+		return false;
+	const CFGBlock *first = *head->succ_begin(), *last = *(head->succ_begin() + 1);
+	if (InBody(body,first) == InBody(body,last))
+		return false;
+	loop.head = head;
+	loop.on_true = InBody(body,first);
+	Effects effects;
+	for (CFGBlock::const_iterator iter = head->begin(), end = head->end(); iter != end; ++iter) {
+		CFGElement e = *iter;
+		if (const CFGStmt *statement = e.getAs<CFGStmt>()) {
+			if (!Pure(statement->getStmt()))
+				return false;
+		}
+	}
+	// the rest of the body is a chain back to the head
+	const CFGBlock *block = loop.on_true ? first : last;
+	while (block != head) {
+		if (loop.path.size() + 1 >= body.size() || !InBody(body,block) || block->succ_size() != 1 || !*block->succ_begin())
+			return false;
+		if (const Stmt *jump = block->getTerminator().getStmt()) {
+			if (jump->getStmtClass() != Stmt::GotoStmtClass && jump->getStmtClass() != Stmt::ContinueStmtClass)
+				return false;
+		}
+		for (CFGBlock::const_iterator iter = block->begin(), end = block->end(); iter != end; ++iter) {
+			CFGElement e = *iter;
+			if (const CFGStmt *statement = e.getAs<CFGStmt>()) {
+				if (!Effect(statement->getStmt(),effects))
+					return false;
+			}
+		}
+		loop.path.push_back(block);
+		block = *block->succ_begin();
+	}
+	if (loop.path.size() + 1 != body.size())
+		return false;
+	for (Effects::const_iterator iter = effects.begin(), end = effects.end(); iter != end; ++iter) {
+		if (iter->second.first)
+			loop.reset[iter->first] = iter->second.second;
+		else if (iter->second.second)
+			loop.translation[iter->first] = iter->second.second;
+	}
+	return true;
+}
+
+}
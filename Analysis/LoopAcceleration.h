@@ -0,0 +1,57 @@
+/*
+ * LoopAcceleration.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef LOOPACCELERATION_H_
+#define LOOPACCELERATION_H_
+
+#include "CFGLoops.h"
+
+#include <clang/Analysis/CFG.h>
+using namespace clang;
+
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * The loops of a CFG whose iterations can be summarized in closed form: every iteration takes the same path
+ * (the head's condition, then a chain of blocks back to the head), and its only effects are adding integer
+ * constants to variables (i++, i += 2, i = i - 1) or setting them to constants (x = 0). k iterations of such
+ * a loop translate the variables by k times the increments, so all of them are obtained at once by adding
+ * a fresh non-negative multiplier (see IterativeSolver::Accelerate).
+ * Any other statement (a call, an assignment of anything else, a declaration) or a branch out of the body
+ * rules the loop out, and it is left to widening.
+ */
+class LoopAcceleration {
+public:
+	struct Loop {
+		const CFGBlock *head;
+		bool on_true; // whether the head's true branch is the one staying in the loop
+		vector<const CFGBlock *> path; // the blocks of an iteration after the head, in order
+		map<string,long> translation; // what an iteration adds to a variable
+		map<string,long> reset; // the constant an iteration leaves a variable at
+	};
+
+	explicit LoopAcceleration(const CFGLoops &loops);
+	virtual ~LoopAcceleration() { }
+
+	// NULL if head does not head a loop that can be accelerated
+	const Loop *Find(const CFGBlock *head) const;
+	bool empty() const { return loops_.empty(); }
+
+private:
+	bool Analyze(const CFGBlock *head, const CFGLoops &loops, Loop &loop) const;
+
+	map<const CFGBlock *,Loop> loops_;
+};
+
+}
+
+#endif /* LOOPACCELERATION_H_ */
@@ -0,0 +1,137 @@
+/*
+ * PagedArray.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef PAGEDARRAY_H_
+#define PAGEDARRAY_H_
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * A sparse array over dense indices, allocated in fixed-size pages that are only created when one of their
+ * entries is. Copies share their pages and a page is copied the first time it is written through a shared
+ * copy, so copying an array (e.g. when snapshotting a solver) costs one pointer per page, and a copy that
+ * is then changed in a few places only pays for the pages it changed.
+ */
+template <typename T>
+class PagedArray {
+	enum { PAGE_BITS = 6, PAGE_SIZE = 1 << PAGE_BITS };
+
+	struct Page {
+		unsigned int refs;
+		T *entries[PAGE_SIZE]; // NULL for entries that are not in the array
+
+		Page() : refs(1) {
+			for (unsigned int i = 0; i < PAGE_SIZE; ++i)
+				entries[i] = NULL;
+		}
+		Page(const Page &other) : refs(1) {
+			for (unsigned int i = 0; i < PAGE_SIZE; ++i)
+				entries[i] = other.entries[i] ? new T(*other.entries[i]) : NULL;
+		}
+		~Page() {
+			for (unsigned int i = 0; i < PAGE_SIZE; ++i)
+				delete entries[i];
+		}
+	private:
+		Page &operator=(const Page &);
+	};
+
+	vector<Page*> pages_;
+	size_t size_;
+
+	void Release() {
+		for (size_t i = 0; i < pages_.size(); ++i) {
+			if (pages_[i] && --pages_[i]->refs == 0)
+				delete pages_[i];
+		}
+		pages_.clear();
+		size_ = 0;
+	}
+
+	// the page holding index, copied first if it is shared
+	Page *WritablePage(unsigned int index) {
+		size_t page = index >> PAGE_BITS;
+		if (page >= pages_.size())
+			pages_.resize(page + 1, NULL);
+		if (!pages_[page]) {
+			pages_[page] = new Page();
+		} else if (pages_[page]->refs > 1) {
+			--pages_[page]->refs;
+			pages_[page] = new Page(*pages_[page]);
+		}
+		return pages_[page];
+	}
+
+public:
+	PagedArray() : size_(0) { }
+	PagedArray(const PagedArray &other) : pages_(other.pages_), size_(other.size_) {
+		for (size_t i = 0; i < pages_.size(); ++i) {
+			if (pages_[i])
+				++pages_[i]->refs;
+		}
+	}
+	PagedArray &operator=(const PagedArray &other) {
+		if (this != &other) {
+			PagedArray copy(other);
+			pages_.swap(copy.pages_);
+			swap(size_, copy.size_);
+		}
+		return *this;
+	}
+	virtual ~PagedArray() { Release(); }
+
+	void clear() { Release(); }
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	size_t count(unsigned int index) const { return find(index) != NULL; }
+
+	// NULL if index is not in the array
+	const T *find(unsigned int index) const {
+		size_t page = index >> PAGE_BITS;
+		if (page >= pages_.size() || !pages_[page])
+			return NULL;
+		return pages_[page]->entries[index & (PAGE_SIZE - 1)];
+	}
+
+	// inserts a default value if index is not in the array
+	T &operator[](unsigned int index) {
+		T *&entry = WritablePage(index)->entries[index & (PAGE_SIZE - 1)];
+		if (!entry) {
+			entry = new T();
+			++size_;
+		}
+		return *entry;
+	}
+
+	/**
+	 * Iteration over the indices in the array, in increasing order:
+	 *  for (unsigned int i = array.first(); i != array.end(); i = array.next(i))
+	 */
+	unsigned int end() const { return pages_.size() << PAGE_BITS; }
+	unsigned int first() const { return find(0) ? 0 : next(0); }
+	unsigned int next(unsigned int index) const {
+		for (++index; index < end(); ++index) {
+			const Page *page = pages_[index >> PAGE_BITS];
+			if (!page) {
+				index |= PAGE_SIZE - 1; // skip the whole page
+				continue;
+			}
+			if (page->entries[index & (PAGE_SIZE - 1)])
+				return index;
+		}
+		return end();
+	}
+};
+
+}
+
+#endif /* PAGEDARRAY_H_ */
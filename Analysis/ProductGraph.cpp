@@ -0,0 +1,120 @@
+/*
+ * ProductGraph.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "ProductGraph.h"
+
+#include <clang/AST/PrettyPrinter.h>
+
+#include "../DTL/dtl.hpp"
+using namespace dtl;
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace differential {
+
+void ProductGraph::Index(const CFG &cfg, vector<const CFGBlock *> &blocks, vector< vector<const CFGBlock *> > &succs) {
+	blocks.assign(cfg.getNumBlockIDs(), NULL);
+	succs.assign(cfg.getNumBlockIDs(), vector<const CFGBlock *>());
+	for (CFG::const_iterator iter = cfg.begin(), end = cfg.end(); iter != end; ++iter) {
+		const CFGBlock *block = *iter;
+		blocks[block->getBlockID()] = block;
+		for (CFGBlock::const_succ_iterator succ = block->succ_begin(), succ_end = block->succ_end(); succ != succ_end; ++succ) {
+			if (*succ)
+				succs[block->getBlockID()].push_back(*succ);
+		}
+	}
+}
+
+// the blocks from the entry on (clang numbers them backwards), each with the text of its statements
+void ProductGraph::Line(const vector<const CFGBlock *> &blocks, vector<unsigned int> &positions, vector<string> &texts) {
+	positions.assign(blocks.size(), 0);
+	texts.clear();
+	for (unsigned int id = blocks.size(); id-- > 0; ) {
+		const CFGBlock *block = blocks[id];
+		if (!block)
+			continue;
+		string text;
+		llvm::raw_string_ostream os(text);
+		for (CFGBlock::const_iterator iter = block->begin(), end = block->end(); iter != end; ++iter) {
+			CFGElement e = *iter;
+			if (const CFGStmt *statement = e.getAs<CFGStmt>()) {
+				statement->getStmt()->printPretty(os, NULL, PrintingPolicy(LangOptions()));
+				os << ';';
+			}
+		}
+		if (const Stmt *terminator = block->getTerminator().getStmt())
+			os << terminator->getStmtClassName();
+		positions[id] = texts.size();
+		texts.push_back(os.str());
+	}
+}
+
+void ProductGraph::Align() {
+	vector<string> texts, texts2;
+	Line(blocks_, positions_, texts);
+	Line(blocks2_, positions2_, texts2);
+	aligned_.assign(texts.size(), 0);
+	aligned2_.assign(texts2.size(), 0);
+	Diff< string, vector<string> > diff(texts, texts2);
+	diff.compose();
+	vector< pair<string, elemInfo> > seq = diff.getSes().getSequence();
+	// a block that is only in one line is aligned with where it would go in the other
+	unsigned int position = 0, position2 = 0;
+	for (unsigned int i = 0; i < seq.size(); ++i) {
+		switch (seq[i].second.type) {
+		case SES_COMMON:
+			aligned_[position++] = position2;
+			aligned2_[position2++] = position - 1;
+			break;
+		case SES_DELETE:
+			aligned_[position++] = position2;
+			break;
+		case SES_ADD:
+			aligned2_[position2++] = position;
+			break;
+		}
+	}
+}
+
+unsigned int ProductGraph::Distance(const CFGBlockPair &pcs) const {
+	if (aligned_.empty() || aligned2_.empty())
+		return 0;
+	unsigned int position = positions_[pcs.first->getBlockID()], position2 = positions2_[pcs.second->getBlockID()];
+	return min(abs((int)aligned_[position] - (int)position2), abs((int)aligned2_[position2] - (int)position));
+}
+
+// a block that is only in one line is aligned with where the other line goes on, so only the common blocks
+// are aligned both ways
+bool ProductGraph::Matched(const CFGBlockPair &pcs) const {
+	if (aligned_.empty() || aligned2_.empty())
+		return false;
+	unsigned int position = positions_[pcs.first->getBlockID()], position2 = positions2_[pcs.second->getBlockID()];
+	return aligned_[position] == position2 && aligned2_[position2] == position;
+}
+
+ProductGraph::ProductGraph(const CFG &cfg, const CFG &cfg2, const CFGBlockPair &initial) : loops_(cfg), loops2_(cfg2) {
+	Index(cfg, blocks_, succs_);
+	Index(cfg2, blocks2_, succs2_);
+	// pairs advance on the first graph, then on the second
+	WeakTopologicalOrder::Graph graph(size());
+	for (unsigned int id = 0; id < size(); ++id) {
+		CFGBlockPair pcs = Pair(id);
+		if (!pcs.first || !pcs.second)
+			continue;
+		const vector<const CFGBlock *> &succs = Succs(pcs.first), &succs2 = Succs2(pcs.second);
+		for (vector<const CFGBlock *>::const_iterator iter = succs.begin(), end = succs.end(); iter != end; ++iter) {
+			graph[id].push_back(Id(CFGBlockPair(*iter, pcs.second)));
+		}
+		for (vector<const CFGBlock *>::const_iterator iter = succs2.begin(), end = succs2.end(); iter != end; ++iter) {
+			graph[id].push_back(Id(CFGBlockPair(pcs.first, *iter)));
+		}
+	}
+	wto_.Compute(graph, Id(initial));
+}
+
+}
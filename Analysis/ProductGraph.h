@@ -0,0 +1,84 @@
+/*
+ * ProductGraph.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef PRODUCTGRAPH_H_
+#define PRODUCTGRAPH_H_
+
+#include "CFGLoops.h"
+#include "WeakTopologicalOrder.h"
+
+#include <clang/Analysis/CFG.h>
+using namespace clang;
+
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * The product of two CFGs, where a pair of blocks advances on either of them.
+ * Pairs are identified by dense ids (id1 * N2 + id2, from the blocks' ids), so that per-pair data can be kept
+ * in arrays, and the successors and the loops of every block are computed once.
+ * Once aligned, the blocks of each CFG are lined up (from the entry, in the order of their ids) and the two
+ * sequences are diffed by the blocks' statements. The distance of a pair is then how far its blocks are from
+ * being aligned with each other, in blocks. Pairs close to the alignment are where matching code meets, and in
+ * banded mode (see IterativeSolver::band_) the speculation keeps to them when it can. A pair is matched when
+ * its blocks are the same in both lines and aligned with each other; in aligned mode (IterativeSolver::align_)
+ * such pairs advance in lockstep, without speculation.
+ */
+class ProductGraph {
+public:
+	typedef pair<const CFGBlock *,const CFGBlock *> CFGBlockPair;
+
+	// the weak topological order is computed over the pairs reachable from initial
+	ProductGraph(const CFG &cfg, const CFG &cfg2, const CFGBlockPair &initial);
+	virtual ~ProductGraph() { }
+
+	unsigned int size() const { return blocks_.size() * blocks2_.size(); }
+	unsigned int Id(const CFGBlockPair &pcs) const { return pcs.first->getBlockID() * blocks2_.size() + pcs.second->getBlockID(); }
+	CFGBlockPair Pair(unsigned int id) const { return CFGBlockPair(blocks_[id / blocks2_.size()], blocks2_[id % blocks2_.size()]); }
+
+	// blocks by id, NULL for ids that have no block
+	const CFGBlock *Block(unsigned int id) const { return id < blocks_.size() ? blocks_[id] : NULL; }
+	const CFGBlock *Block2(unsigned int id) const { return id < blocks2_.size() ? blocks2_[id] : NULL; }
+
+	// the successors of a block of the first/second CFG (unreachable successors are left out)
+	const vector<const CFGBlock *> &Succs(const CFGBlock *block) const { return succs_[block->getBlockID()]; }
+	const vector<const CFGBlock *> &Succs2(const CFGBlock *block) const { return succs2_[block->getBlockID()]; }
+
+	// the loops of the first/second CFG
+	const CFGLoops &loops() const { return loops_; }
+	const CFGLoops &loops2() const { return loops2_; }
+
+	const WeakTopologicalOrder &wto() const { return wto_; }
+
+	void Align();
+	// 0 until aligned
+	unsigned int Distance(const CFGBlockPair &pcs) const;
+	// false until aligned
+	bool Matched(const CFGBlockPair &pcs) const;
+
+private:
+	static void Index(const CFG &cfg, vector<const CFGBlock *> &blocks, vector< vector<const CFGBlock *> > &succs);
+	static void Line(const vector<const CFGBlock *> &blocks, vector<unsigned int> &positions, vector<string> &texts);
+
+	vector<const CFGBlock *> blocks_, blocks2_;
+	vector< vector<const CFGBlock *> > succs_, succs2_;
+	vector<unsigned int> positions_, positions2_; // of the blocks in their line, by id
+	vector<unsigned int> aligned_, aligned2_; // the position in the other line each position is aligned with
+	CFGLoops loops_, loops2_;
+	WeakTopologicalOrder wto_;
+
+	ProductGraph(const ProductGraph &);
+	ProductGraph &operator=(const ProductGraph &);
+};
+
+}
+
+#endif /* PRODUCTGRAPH_H_ */
@@ -0,0 +1,130 @@
+/*
+ * ResultCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "ResultCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace differential {
+
+namespace {
+
+// 64 bit FNV-1a from the given basis
+unsigned long long Fnv(const string &text, unsigned long long hash) {
+	for (string::const_iterator iter = text.begin(), end = text.end(); iter != end; ++iter) {
+		hash ^= (unsigned char)*iter;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+struct Entry {
+	string path;
+	time_t time;
+	unsigned long bytes;
+	bool operator<(const Entry &other) const { return time < other.time; }
+};
+
+}
+
+ResultCache::ResultCache(const string &dir, unsigned long max_bytes) : dir_(dir), max_bytes_(max_bytes) {
+	if (dir_.size() && mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+		perror(dir_.c_str());
+		dir_.clear();
+	}
+}
+
+// two FNV-1a hashes, the second over the text followed by its length so that the halves are independent
+string ResultCache::Key(const string &text) {
+	stringstream length;
+	length << text.size();
+	char key[33];
+	snprintf(key, sizeof(key), "%016llx%016llx", Fnv(text, 14695981039346656037ULL), Fnv(text + length.str(), 0x6c62272e07bb0142ULL));
+	return key;
+}
+
+bool ResultCache::Lookup(const string &key, string &value) const {
+	if (!enabled())
+		return false;
+	ifstream in(Path(key).c_str(), ios::binary);
+	if (!in.is_open())
+		return false;
+	stringstream ss;
+	ss << in.rdbuf();
+	value = ss.str();
+	utime(Path(key).c_str(), NULL); // recently used
+	return true;
+}
+
+void ResultCache::Store(const string &key, const string &value) const {
+	if (!enabled())
+		return;
+	stringstream temp;
+	temp << Path(key) << ".tmp." << getpid();
+	{
+		ofstream out(temp.str().c_str(), ios::binary);
+		if (!out.is_open())
+			return;
+		out << value;
+		if (!out) {
+			out.close();
+			unlink(temp.str().c_str());
+			return;
+		}
+	}
+	if (rename(temp.str().c_str(), Path(key).c_str()) != 0) {
+		unlink(temp.str().c_str());
+		return;
+	}
+	Evict();
+}
+
+void ResultCache::Evict() const {
+	if (!max_bytes_)
+		return;
+	vector<Entry> entries;
+	unsigned long total = 0;
+	DIR *dir_ptr = opendir(dir_.c_str());
+	if (!dir_ptr)
+		return;
+	while (struct dirent *dirent_ptr = readdir(dir_ptr)) {
+		string name = dirent_ptr->d_name;
+		if (name.size() != 32) // entries only, not temporaries or anything else
+			continue;
+		Entry entry;
+		entry.path = Path(name);
+		struct stat buffer;
+		if (stat(entry.path.c_str(), &buffer) != 0 || !S_ISREG(buffer.st_mode))
+			continue;
+		entry.time = buffer.st_mtime;
+		entry.bytes = buffer.st_size;
+		total += entry.bytes;
+		entries.push_back(entry);
+	}
+	closedir(dir_ptr);
+	if (total <= max_bytes_)
+		return;
+	// down to 90% of the limit, so that every store does not evict
+	sort(entries.begin(), entries.end());
+	for (vector<Entry>::const_iterator iter = entries.begin(), end = entries.end(); iter != end && total > max_bytes_ / 10 * 9; ++iter) {
+		if (unlink(iter->path.c_str()) == 0)
+			total -= iter->bytes;
+	}
+}
+
+}
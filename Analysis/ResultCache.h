@@ -0,0 +1,47 @@
+/*
+ * ResultCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef RESULTCACHE_H_
+#define RESULTCACHE_H_
+
+#include <string>
+using namespace std;
+
+namespace differential {
+
+/**
+ * An on-disk cache of analysis results across runs, content addressed: an entry is a file of the cache
+ * directory named by the hash of everything the result depends on (the functions' text, the configuration
+ * and the version of the tool), so a changed input simply misses. Entries are written to a temporary file
+ * and renamed, so that processes sharing the directory never see a partial entry. When the entries take
+ * more than the size limit, the least recently used ones (by modification time, which a hit updates) are
+ * removed.
+ */
+class ResultCache {
+public:
+	ResultCache(const string &dir, unsigned long max_bytes);
+	virtual ~ResultCache() { }
+
+	// a 128 bit hash of text, in hex
+	static string Key(const string &text);
+
+	bool enabled() const { return dir_.size() > 0; }
+	// false on a miss
+	bool Lookup(const string &key, string &value) const;
+	void Store(const string &key, const string &value) const;
+
+private:
+	string Path(const string &key) const { return dir_ + "/" + key; }
+	void Evict() const;
+
+	string dir_; // empty when caching is off
+	unsigned long max_bytes_;
+};
+
+}
+
+#endif /* RESULTCACHE_H_ */
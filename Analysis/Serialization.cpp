@@ -0,0 +1,274 @@
+/*
+ * Serialization.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "Serialization.h"
+
+#include <iomanip>
+
+namespace differential {
+
+namespace {
+
+void WriteScalar(ostream &os, const scalar &s) {
+	int infty_sign = s.is_infty();
+	if (infty_sign) {
+		os << (infty_sign > 0 ? " +oo" : " -oo");
+	} else if (s.get_discr() == AP_SCALAR_MPQ) {
+		os << " q " << s.get_mpq().get_str();
+	} else { // double and mpfr scalars go through a double, 17 digits make it round-trip
+		double d = 0;
+		ap_double_set_scalar(&d, const_cast<ap_scalar_t*>(s.get_ap_scalar_t()), GMP_RNDN);
+		os << " d " << setprecision(17) << d;
+	}
+}
+
+scalar ReadScalar(istream &is) {
+	string kind;
+	is >> kind;
+	if (kind == "+oo") {
+		return scalar(infty(1));
+	} else if (kind == "-oo") {
+		return scalar(infty(-1));
+	} else if (kind == "q") {
+		string q;
+		is >> q;
+		return scalar(mpq_class(q));
+	} else if (kind == "d") {
+		double d = 0;
+		is >> d;
+		return scalar(d);
+	}
+	is.setstate(ios::failbit);
+	return scalar(0);
+}
+
+void WriteCoeff(ostream &os, const coeff &c) {
+	if (c.get_discr() == AP_COEFF_SCALAR) {
+		os << " s";
+		WriteScalar(os, c.get_scalar());
+	} else {
+		os << " i";
+		WriteScalar(os, c.get_interval().get_inf());
+		WriteScalar(os, c.get_interval().get_sup());
+	}
+}
+
+coeff ReadCoeff(istream &is) {
+	string kind;
+	is >> kind;
+	if (kind == "s") {
+		return coeff(ReadScalar(is));
+	} else if (kind == "i") {
+		scalar inf = ReadScalar(is);
+		scalar sup = ReadScalar(is);
+		return coeff(interval(inf, sup));
+	}
+	is.setstate(ios::failbit);
+	return coeff(0);
+}
+
+bool IsZero(const coeff &c) {
+	return ap_coeff_zero(const_cast<ap_coeff_t*>(c.get_ap_coeff_t()));
+}
+
+}
+
+void Serialization::WriteName(ostream &os, const string &name) {
+	os << ' ' << name.size() << ':' << name;
+}
+
+string Serialization::ReadName(istream &is) {
+	size_t size = 0;
+	char colon = 0;
+	is >> size >> colon;
+	if (!is || colon != ':') {
+		is.setstate(ios::failbit);
+		return "";
+	}
+	string name(size, ' ');
+	if (size)
+		is.read(&name[0], size);
+	return name;
+}
+
+bool Serialization::Expect(istream &is, const string &token) {
+	string read;
+	is >> read;
+	if (read != token)
+		is.setstate(ios::failbit);
+	return is.good();
+}
+
+void Serialization::WriteEnvironment(ostream &os, const environment &env) {
+	vector<var> vars = env.get_vars();
+	size_t intdim = env.intdim();
+	os << " env " << intdim;
+	for (size_t i = 0; i < intdim; ++i)
+		WriteName(os, vars[i]);
+	os << ' ' << vars.size() - intdim;
+	for (size_t i = intdim; i < vars.size(); ++i)
+		WriteName(os, vars[i]);
+}
+
+environment Serialization::ReadEnvironment(istream &is) {
+	vector<var> int_vars, real_vars;
+	size_t size = 0;
+	if (!Expect(is, "env"))
+		return environment();
+	is >> size;
+	for (size_t i = 0; i < size && is; ++i)
+		int_vars.push_back(var(ReadName(is)));
+	is >> size;
+	for (size_t i = 0; i < size && is; ++i)
+		real_vars.push_back(var(ReadName(is)));
+	if (!is)
+		return environment();
+	return environment(int_vars, real_vars);
+}
+
+/**
+ * an abstract is written as its environment followed by either top, bottom or its linear constraints:
+ *  cons <n> { <constyp> <#terms> { <var> <coeff> } <constant> [<modulo>] }
+ */
+void Serialization::WriteAbstract(ostream &os, manager &mgr, const abstract1 &abs) {
+	environment env = abs.get_environment();
+	WriteEnvironment(os, env);
+	if (abs.is_bottom(mgr)) {
+		os << " bottom\n";
+		return;
+	}
+	if (abs.is_top(mgr)) {
+		os << " top\n";
+		return;
+	}
+	vector<var> vars = env.get_vars();
+	lincons1_array constraints = abs.to_lincons_array(mgr);
+	os << " cons " << constraints.size() << '\n';
+	for (size_t i = 0; i < constraints.size(); ++i) {
+		lincons1 cons = constraints.get(i);
+		vector<var> term_vars;
+		for (size_t j = 0; j < vars.size(); ++j) {
+			if (!IsZero(cons.get_coeff(vars[j])))
+				term_vars.push_back(vars[j]);
+		}
+		os << (int)cons.get_constyp() << ' ' << term_vars.size();
+		for (size_t j = 0; j < term_vars.size(); ++j) {
+			WriteName(os, term_vars[j]);
+			WriteCoeff(os, cons.get_coeff(term_vars[j]));
+		}
+		WriteCoeff(os, cons.get_cst());
+		if (cons.get_constyp() == AP_CONS_EQMOD)
+			WriteScalar(os, cons.get_modulo());
+		os << '\n';
+	}
+}
+
+// malformed input sets the failbit of is: the abstract returned then is not what was written, and must not be
+// used (top would pass for a sound result)
+abstract1 Serialization::ReadAbstract(istream &is, manager &mgr) {
+	environment env = ReadEnvironment(is);
+	string kind;
+	is >> kind;
+	if (!is)
+		return abstract1(mgr, env, bottom());
+	if (kind == "bottom")
+		return abstract1(mgr, env, bottom());
+	if (kind == "top")
+		return abstract1(mgr, env, top());
+	if (kind != "cons") {
+		is.setstate(ios::failbit);
+		return abstract1(mgr, env, bottom());
+	}
+	size_t size = 0;
+	is >> size;
+	vector<tcons1> constraints;
+	for (size_t i = 0; i < size && is; ++i) {
+		int constyp = 0;
+		size_t terms = 0;
+		is >> constyp >> terms;
+		vector<pair<var,coeff> > linear_terms;
+		for (size_t j = 0; j < terms && is; ++j) {
+			var v(ReadName(is));
+			linear_terms.push_back(make_pair(v, ReadCoeff(is)));
+		}
+		texpr1 expr = texpr1::builder(env, ReadCoeff(is));
+		for (size_t j = 0; j < linear_terms.size(); ++j)
+			expr = texpr1::builder(expr) + texpr1::builder(env, linear_terms[j].second) * texpr1::builder(env, linear_terms[j].first);
+		if (constyp == AP_CONS_EQMOD) {
+			scalar modulo = ReadScalar(is);
+			constraints.push_back(tcons1((ap_constyp_t)constyp, texpr1::builder(expr), modulo));
+		} else {
+			constraints.push_back(tcons1((ap_constyp_t)constyp, texpr1::builder(expr)));
+		}
+	}
+	if (!is)
+		return abstract1(mgr, env, bottom());
+	if (constraints.empty())
+		return abstract1(mgr, env, top());
+	return abstract1(mgr, env, top()).meet(mgr, tcons1_array(constraints.size(), &constraints[0]));
+}
+
+void Serialization::WriteState(ostream &os, const State &state) {
+	manager &mgr = *state.Context().mgr_ptr_;
+	os << " state " << state.at_diff_point_;
+	WriteEnvironment(os, state.env_);
+	os << ' ' << state.abs_set_.size() << '\n';
+	for (AbstractSet::const_iterator iter = state.abs_set_.begin(), end = state.abs_set_.end(); iter != end; ++iter) {
+		WriteAbstract(os, mgr, *iter->vars.abstract());
+		WriteAbstract(os, mgr, *iter->guards.abstract());
+	}
+}
+
+bool Serialization::ReadState(istream &is, State &state) {
+	manager &mgr = *state.Context().mgr_ptr_;
+	state.abs_set_.clear();
+	if (!Expect(is, "state"))
+		return false;
+	is >> state.at_diff_point_;
+	state.env_ = ReadEnvironment(is);
+	size_t size = 0;
+	is >> size;
+	for (size_t i = 0; i < size && is; ++i) {
+		abstract1 vars = ReadAbstract(is, mgr);
+		abstract1 guards = ReadAbstract(is, mgr);
+		if (is)
+			state.abs_set_.insert(Abstract2(vars, guards));
+	}
+	if (!is) // a state missing some of its disjuncts is not sound
+		state.abs_set_.clear();
+	return !is.fail();
+}
+
+void Serialization::WriteVarMap(ostream &os, const map< var, vector<var> > &var_map) {
+	os << " map " << var_map.size();
+	for (map< var, vector<var> >::const_iterator iter = var_map.begin(), end = var_map.end(); iter != end; ++iter) {
+		WriteName(os, iter->first);
+		os << ' ' << iter->second.size();
+		for (size_t i = 0; i < iter->second.size(); ++i)
+			WriteName(os, iter->second[i]);
+	}
+	os << '\n';
+}
+
+void Serialization::ReadVarMap(istream &is, map< var, vector<var> > &var_map) {
+	size_t size = 0;
+	if (!Expect(is, "map"))
+		return;
+	is >> size;
+	for (size_t i = 0; i < size && is; ++i) {
+		var key(ReadName(is));
+		size_t values = 0;
+		is >> values;
+		vector<var> vars;
+		for (size_t j = 0; j < values && is; ++j)
+			vars.push_back(var(ReadName(is)));
+		if (is)
+			var_map[key] = vars;
+	}
+}
+
+}
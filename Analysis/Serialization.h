@@ -0,0 +1,59 @@
+/*
+ * Serialization.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef SERIALIZATION_H_
+#define SERIALIZATION_H_
+
+#include <istream>
+#include <ostream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "apronxx/apronxx.hh"
+using namespace apron;
+
+#include "APAbstractDomain.h"
+
+namespace differential {
+
+/**
+ * Text (de)serialization of abstracts and states, so that they can be moved between processes and runs.
+ * Abstracts are written as their environment and their linear constraints (exact, rationals are kept as such)
+ * and are re-interned in the dictionary when read.
+ */
+class Serialization {
+private:
+	Serialization() {}
+public:
+	typedef APAbstractDomain_ValueTypes::ValTy State;
+
+	// names are length-prefixed as variable names may contain anything but whitespace (e.g. call expressions)
+	static void WriteName(ostream &os, const string &name);
+	static string ReadName(istream &is);
+
+	static void WriteEnvironment(ostream &os, const environment &env);
+	static environment ReadEnvironment(istream &is);
+
+	// the readers set the failbit of the stream on malformed input, which the callers must check
+	static void WriteAbstract(ostream &os, manager &mgr, const abstract1 &abs);
+	static abstract1 ReadAbstract(istream &is, manager &mgr);
+
+	static void WriteState(ostream &os, const State &state);
+	static bool ReadState(istream &is, State &state);
+
+	static void WriteVarMap(ostream &os, const map< var, vector<var> > &var_map);
+	static void ReadVarMap(istream &is, map< var, vector<var> > &var_map);
+
+	// reads the next token and checks that it is the given one
+	static bool Expect(istream &is, const string &token);
+};
+
+}
+
+#endif /* SERIALIZATION_H_ */
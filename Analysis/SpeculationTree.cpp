@@ -0,0 +1,110 @@
+/*
+ * SpeculationTree.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "SpeculationTree.h"
+
+#include <algorithm>
+
+#define DEBUG 0
+
+namespace differential {
+
+void SpeculationTree::Clear() {
+	for (map<Interleaving, Node>::iterator iter = nodes_.begin(), end = nodes_.end(); iter != end; ++iter) {
+		delete iter->second.solver;
+	}
+	nodes_.clear();
+}
+
+void SpeculationTree::Reset(const IterativeSolver &root) {
+	Clear();
+	Node node;
+	node.solver = new IterativeSolver(root);
+	node.advanced = false;
+	nodes_[Interleaving()] = node;
+}
+
+const IterativeSolver &SpeculationTree::Get(const Interleaving &interleaving, bool &can_advance) {
+	assert(nodes_.count(Interleaving()) && "speculation tree has no root.");
+	requested_ += interleaving.size();
+	Compute(interleaving);
+	can_advance = false;
+	for (Interleaving current = interleaving; !current.empty(); current.pop_back()) {
+		if (nodes_[current].advanced) {
+			can_advance = true;
+			break;
+		}
+	}
+	return *nodes_[interleaving].solver;
+}
+
+void SpeculationTree::Compute(const Interleaving &interleaving) {
+	if (nodes_.count(interleaving))
+		return;
+	Interleaving parent_interleaving(interleaving.begin(), interleaving.end() - 1);
+	Compute(parent_interleaving);
+	const IterativeSolver &parent = *nodes_[parent_interleaving].solver;
+	Node node;
+	node.solver = new IterativeSolver(parent);
+	// step from a clean changed set to learn what this step alone changed
+	node.solver->changed_.clear();
+	node.advanced = node.solver->Step(cfg_ptr_, cfg2_ptr_, interleaving.back());
+	node.changed = node.solver->changed_;
+	// snapshots below this one share its scores, so each changed state is scored once in the tree
+	node.solver->ScoreLocations(node.changed);
+	node.solver->changed_.insert(parent.changed_.begin(), parent.changed_.end());
+	nodes_[interleaving] = node;
+	computed_++;
+#if(DEBUG)
+	errs() << "Speculation tree: computed " << IterativeSolver::ToString(interleaving) << "\n";
+#endif
+}
+
+bool SpeculationTree::Below(const Interleaving &interleaving, const Interleaving &ancestor) {
+	return interleaving.size() >= ancestor.size() && equal(ancestor.begin(), ancestor.end(), interleaving.begin());
+}
+
+void SpeculationTree::Reroot(const Interleaving &interleaving, const IterativeSolver &root) {
+	map<Interleaving, Node> kept;
+	for (map<Interleaving, Node>::iterator iter = nodes_.begin(), end = nodes_.end(); iter != end; ++iter) {
+		if (iter->first != interleaving && Below(iter->first, interleaving)) {
+			kept[Interleaving(iter->first.begin() + interleaving.size(), iter->first.end())] = iter->second;
+		} else {
+			delete iter->second.solver;
+		}
+	}
+	nodes_ = kept;
+	Node node;
+	node.solver = new IterativeSolver(root);
+	node.advanced = false;
+	nodes_[Interleaving()] = node;
+	// the changed locations are now relative to the new root
+	for (map<Interleaving, Node>::iterator iter = nodes_.begin(), end = nodes_.end(); iter != end; ++iter) {
+		if (iter->first.empty())
+			continue;
+		const IterativeSolver &parent = *nodes_[Interleaving(iter->first.begin(), iter->first.end() - 1)].solver;
+		iter->second.solver->changed_ = parent.changed_;
+		iter->second.solver->changed_.insert(iter->second.changed.begin(), iter->second.changed.end());
+	}
+#if(DEBUG)
+	errs() << "Speculation tree: re-rooted at " << IterativeSolver::ToString(interleaving) << ", kept " << nodes_.size() - 1 << " snapshots\n";
+#endif
+}
+
+SpeculationTree::Interleaving SpeculationTree::Split(unsigned int k1, unsigned int k2) {
+	Interleaving interleaving(k1, IterativeSolver::FIRST_GRAPH);
+	interleaving.insert(interleaving.end(), k2, IterativeSolver::SECOND_GRAPH);
+	return interleaving;
+}
+
+SpeculationTree::Interleaving SpeculationTree::Prefix(const Interleaving &interleaving, unsigned int steps) {
+	if (steps >= interleaving.size())
+		return interleaving;
+	return Interleaving(interleaving.begin(), interleaving.begin() + steps);
+}
+
+}
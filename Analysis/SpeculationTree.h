@@ -0,0 +1,71 @@
+/*
+ * SpeculationTree.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef SPECULATIONTREE_H_
+#define SPECULATIONTREE_H_
+
+#include "IterativeSolver.h"
+
+#include <map>
+#include <set>
+using namespace std;
+
+namespace differential {
+
+/**
+ * The solver snapshots computed while speculating, keyed by the interleaving of steps that leads to them
+ * from the root. An interleaving is computed from the one without its last step, so the interleavings of a
+ * window share their prefixes instead of each replaying them from the root.
+ * Once an interleaving is chosen, the tree is re-rooted at the committed snapshot and whatever was computed
+ * below it is kept for the next window.
+ */
+class SpeculationTree {
+public:
+	typedef IterativeSolver::Interleaving Interleaving;
+	typedef IterativeSolver::CFGBlockPair CFGBlockPair;
+
+	SpeculationTree(CFG * cfg_ptr, CFG * cfg2_ptr) : cfg_ptr_(cfg_ptr), cfg2_ptr_(cfg2_ptr), computed_(0), requested_(0) { }
+	virtual ~SpeculationTree() { Clear(); }
+
+	// drop all snapshots and start over from root
+	void Reset(const IterativeSolver &root);
+	// the solver after the steps of interleaving, and whether any of them advanced
+	const IterativeSolver &Get(const Interleaving &interleaving, bool &can_advance);
+	// make the snapshot at interleaving (replaced by root) the new root, keeping only the snapshots below it
+	void Reroot(const Interleaving &interleaving, const IterativeSolver &root);
+
+	// k1 steps on the first graph followed by k2 steps on the second
+	static Interleaving Split(unsigned int k1, unsigned int k2);
+	// the first steps steps of interleaving
+	static Interleaving Prefix(const Interleaving &interleaving, unsigned int steps);
+
+	// steps actually computed and steps that were asked for (as if every split were replayed from the root)
+	unsigned int computed() const { return computed_; }
+	unsigned int requested() const { return requested_; }
+
+private:
+	struct Node {
+		IterativeSolver *solver; // changed_ holds everything changed since the root
+		bool advanced; // whether the step from the parent advanced
+		set<CFGBlockPair> changed; // locations changed by the step from the parent
+	};
+
+	static bool Below(const Interleaving &interleaving, const Interleaving &ancestor);
+	void Compute(const Interleaving &interleaving);
+	void Clear();
+
+	CFG *cfg_ptr_, *cfg2_ptr_;
+	map<Interleaving, Node> nodes_; // a prefix is ordered before the interleavings that extend it
+	unsigned int computed_, requested_;
+
+	SpeculationTree(const SpeculationTree &);
+	SpeculationTree &operator=(const SpeculationTree &);
+};
+
+}
+
+#endif /* SPECULATIONTREE_H_ */
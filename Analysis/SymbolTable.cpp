@@ -0,0 +1,66 @@
+/*
+ * SymbolTable.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "SymbolTable.h"
+#include "../Defines.h"
+
+#include <cassert>
+
+namespace differential {
+
+SymbolTable::Id SymbolTable::Find(const var &v) {
+	map<var,Id>::const_iterator found = by_var_.find(v);
+	if (found != by_var_.end())
+		return found->second;
+	Id id = Find((string)v);
+	by_var_[v] = id;
+	return id;
+}
+
+SymbolTable::Id SymbolTable::Find(const string &name) {
+	map<string,Id>::const_iterator found = by_name_.find(name);
+	if (found != by_name_.end())
+		return found->second;
+	return Intern(name);
+}
+
+SymbolTable::Id SymbolTable::Counterpart(Id id) {
+	Id &counterpart = entries_[id & kIndex].counterpart;
+	if (counterpart == kNone) {
+		string name = Var(id);
+		counterpart = Find(IsTagged(id) ? name.substr(Defines::kTagPrefix.size()) : Defines::kTagPrefix + name);
+		entries_[counterpart & kIndex].counterpart = id;
+	}
+	return counterpart;
+}
+
+// the kind of a variable is read off its name, as AnalysisUtils::IsGuard and IsArrayInstrumentationVar did
+SymbolTable::Id SymbolTable::Kind(const string &name) {
+	Id kind = 0;
+	size_t untagged = 0;
+	if (name.compare(0,Defines::kTagPrefix.size(),Defines::kTagPrefix) == 0) {
+		kind |= kTagged;
+		untagged = Defines::kTagPrefix.size();
+	}
+	if (name.compare(untagged,Defines::kGuardPrefix.size(),Defines::kGuardPrefix) == 0)
+		kind |= kGuard;
+	if (name.compare(untagged,Defines::kArrayIndexPrefix.size(),Defines::kArrayIndexPrefix) == 0 ||
+		name.compare(0,Defines::kArrayReadPrefix.size() + 2,Defines::kArrayReadPrefix + "( ") == 0)
+		kind |= kArrayInstrumentation;
+	return kind;
+}
+
+SymbolTable::Id SymbolTable::Intern(const string &name) {
+	Id id = entries_.size();
+	assert(id <= kIndex);
+	id |= Kind(name);
+	entries_.push_back(Entry(var(name)));
+	by_name_[name] = id;
+	return id;
+}
+
+}
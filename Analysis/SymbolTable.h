@@ -0,0 +1,70 @@
+/*
+ * SymbolTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef SYMBOLTABLE_H_
+#define SYMBOLTABLE_H_
+
+#include <deque>
+#include <map>
+#include <string>
+using namespace std;
+
+#include "apronxx/apronxx.hh"
+using namespace apron;
+
+namespace differential {
+
+/**
+ * The variables of an analysis, each with a dense id. What used to be read off a variable's name on every
+ * use (whether it is tagged, a guard, or array instrumentation, and the name of its counterpart in the other
+ * version, see Utils::Names) is worked out once, when the variable is first seen, and kept in the high bits of
+ * its id and in its entry. The apron var of an id is created once and shared.
+ * Ids are only valid in the context that gave them (see DomainContext).
+ */
+class SymbolTable {
+public:
+	typedef unsigned int Id;
+
+	static const Id kTagged = 1u << 31;
+	static const Id kGuard = 1u << 30; // tagged or not
+	static const Id kArrayInstrumentation = 1u << 29; // index and read variables
+	static const Id kIndex = kArrayInstrumentation - 1; // the dense part of an id
+
+	SymbolTable() { }
+	virtual ~SymbolTable() { }
+
+	Id Find(const var &v);
+	Id Find(const string &name);
+	const var &Var(Id id) const { return entries_[id & kIndex].v; }
+	// the variable's other version: the tagged id of an untagged variable, and vice versa
+	Id Counterpart(Id id);
+
+	static bool IsTagged(Id id) { return id & kTagged; }
+	static bool IsGuard(Id id) { return id & kGuard; }
+	static bool IsArrayInstrumentation(Id id) { return id & kArrayInstrumentation; }
+	// the kind bits of a name, read off its prefixes without a lookup (for one-off queries on a var)
+	static Id Kind(const string &name);
+
+private:
+	static const Id kNone = ~0u;
+
+	struct Entry {
+		var v;
+		Id counterpart; // kNone until asked for
+		Entry(const var &variable) : v(variable), counterpart(kNone) { }
+	};
+
+	Id Intern(const string &name);
+
+	deque<Entry> entries_; // by index (a deque, so that the vars handed out stay put)
+	map<string,Id> by_name_;
+	map<var,Id> by_var_;
+};
+
+}
+
+#endif /* SYMBOLTABLE_H_ */
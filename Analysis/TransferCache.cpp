@@ -0,0 +1,40 @@
+/*
+ * TransferCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "TransferCache.h"
+
+namespace differential {
+
+const TransferCache::Entry *TransferCache::Find(const Key &key) {
+	map<Key,Entry>::const_iterator entry = entries_.find(key);
+	if (entry == entries_.end()) {
+		++misses_;
+		return NULL;
+	}
+	++hits_;
+	return &entry->second;
+}
+
+const TransferCache::Entry &TransferCache::Store(const Key &key, const AbstractSet &val, const AbstractSet &nval) {
+	if (entries_.size() >= capacity_ && !entries_.count(key)) {
+		entries_.erase(order_.front());
+		order_.pop_front();
+	}
+	pair<map<Key,Entry>::iterator,bool> inserted = entries_.insert(make_pair(key,Entry()));
+	if (inserted.second)
+		order_.push_back(key);
+	inserted.first->second.val = val;
+	inserted.first->second.nval = nval;
+	return inserted.first->second;
+}
+
+void TransferCache::Clear() {
+	entries_.clear();
+	order_.clear();
+}
+
+}
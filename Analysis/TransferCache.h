@@ -0,0 +1,70 @@
+/*
+ * TransferCache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef TRANSFERCACHE_H_
+#define TRANSFERCACHE_H_
+
+#include "APAbstractDomain.h"
+
+#include <deque>
+#include <map>
+using namespace std;
+
+namespace differential {
+
+/**
+ * The effect of a block on a single disjunct, remembered across visits. Disjuncts are interned (see
+ * Abstract1), so a disjunct is identified by the addresses of its abstracts; the speculative branches of a
+ * window share their prefixes and the iterations of a loop revisit states, so the same block is often applied
+ * to the same disjunct. An entry holds the disjuncts the block leaves on its true (or only) branch and on its
+ * false branch. When full, the oldest entry is dropped.
+ * Entries are only valid in the domain they were computed in, so the cache is cleared when it changes.
+ */
+class TransferCache {
+public:
+	struct Key {
+		unsigned int block;
+		bool second; // of the second CFG
+		const abstract1 *vars, *guards;
+		Key(unsigned int b, bool s, const Abstract2 &disjunct) :
+			block(b), second(s), vars(disjunct.vars.abstract()), guards(disjunct.guards.abstract()) { }
+		bool operator<(const Key &other) const {
+			if (block != other.block)
+				return block < other.block;
+			if (second != other.second)
+				return second < other.second;
+			if (vars != other.vars)
+				return vars < other.vars;
+			return guards < other.guards;
+		}
+	};
+	struct Entry {
+		AbstractSet val, nval;
+	};
+
+	explicit TransferCache(unsigned long capacity) : capacity_(capacity), hits_(0), misses_(0) { }
+	virtual ~TransferCache() { }
+
+	bool enabled() const { return capacity_ > 0; }
+	// NULL on a miss
+	const Entry *Find(const Key &key);
+	const Entry &Store(const Key &key, const AbstractSet &val, const AbstractSet &nval);
+	void Clear();
+
+	unsigned long hits() const { return hits_; }
+	unsigned long misses() const { return misses_; }
+
+private:
+	unsigned long capacity_; // entries (0 = no caching)
+	map<Key,Entry> entries_;
+	deque<Key> order_; // of insertion, the oldest first
+	unsigned long hits_, misses_;
+};
+
+}
+
+#endif /* TRANSFERCACHE_H_ */
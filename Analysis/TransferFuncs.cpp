@@ -28,8 +28,9 @@ ostream& operator<<(ostream& os, const ExpressionState &es){
 
 void TransferFuncs::AssumeTagEquivalence(State &state, string v, const Type * type){
 	AnalysisUtils::VarType var_type;
-	string v_tag;
-	Utils::Names(v,v_tag);
+	SymbolTable &symbols = State::Context().symbols_;
+	SymbolTable::Id id = symbols.Find(v);
+	SymbolTable::Id untagged = SymbolTable::IsTagged(id) ? symbols.Counterpart(id) : id;
 	if (type->isIntegerType() || (type->isPointerType() && type->getPointeeType()->isIntegerType())) {
 		var_type = AnalysisUtils::Int;
 	} else if (type->isFloatingType() || (type->isPointerType() && type->getPointeeType()->isFloatingType())) {
@@ -37,7 +38,7 @@ void TransferFuncs::AssumeTagEquivalence(State &state, string v, const Type * ty
 	} else {
 		return;
 	}
-	tcons1 equal_cons = AnalysisUtils::GetEquivCons(state.env_,v,v_tag,var_type);
+	tcons1 equal_cons = AnalysisUtils::GetEquivCons(state.env_,symbols.Var(untagged),symbols.Var(symbols.Counterpart(untagged)),var_type);
 	state &= equal_cons;
 }
 
@@ -55,9 +56,7 @@ ExpressionState TransferFuncs::VisitDeclRefExpr(DeclRefExpr* node) {
 	ExpressionState result;
 	if ( VarDecl* decl = dyn_cast<VarDecl>(node->getDecl()) ) {
 		const Type * type = decl->getType().getTypePtr();
-		stringstream name;
-		name << (tag_ ? Defines::kTagPrefix : "") << decl->getNameAsString();
-		var v(name.str());
+		const var &v = State::Context().symbols_.Var(State::Context().symbols_.Find((tag_ ? Defines::kTagPrefix : "") + decl->getNameAsString()));
 		if (type->isIntegerType() || (type->isPointerType() && type->getPointeeType()->isIntegerType())) {
 			result = texpr1(environment().add(&v,1,0,0),v);
 		} else if (type->isFloatingType() || (type->isPointerType() && type->getPointeeType()->isFloatingType())) {
@@ -72,11 +71,7 @@ ExpressionState TransferFuncs::VisitCallExpr(CallExpr *node) {
 	ExpressionState result;
 	const Type * type = node->getCallReturnType().getTypePtr();
 
-	string call;
-	raw_string_ostream call_os(call);
-	call_os << (tag_ ? Defines::kTagPrefix : "");
-	node->printPretty(call_os,analysis_data_ptr_->getContext(),0, PrintingPolicy(LangOptions()));
-	string call_str = Utils::ReplaceAll(call_os.str()," ",""); // remove spaces from call string
+	const string &call_str = CallName(node);
 	var v(call_str);
 	environment env;
 	if ( type->isIntegerType() )
@@ -85,14 +80,78 @@ ExpressionState TransferFuncs::VisitCallExpr(CallExpr *node) {
 		result = texpr1(env.add(0,0,&v,1),v);
 	else
 		return result;
-	// assume the value of the function call is the same in both versions (TODO: this may not always be the case)
-	AssumeTagEquivalence(state_,call_str,type);
-	AssumeTagEquivalence(nstate_,call_str,type);
+	// assume the value of the function call is the same in both versions (TODO: this may not always be the case),
+	// unless the callee's summary tells how the values relate, or the equivalence was assumed up front
+	if (!ApplySummary(node,call_str) && !calls_assumed_) {
+		AssumeTagEquivalence(state_,call_str,type);
+		AssumeTagEquivalence(nstate_,call_str,type);
+	}
 
 	expr_map_[node] = result;
 	return result;
 }
 
+const string &TransferFuncs::CallName(CallExpr *node) {
+	pair<const CallExpr*,bool> key(node,tag_);
+	map< pair<const CallExpr*,bool>,string >::iterator name = call_names_->by_call.find(key);
+	if (name == call_names_->by_call.end()) {
+		string call;
+		raw_string_ostream call_os(call);
+		call_os << (tag_ ? Defines::kTagPrefix : "");
+		node->printPretty(call_os,analysis_data_ptr_->getContext(),0, PrintingPolicy(LangOptions()));
+		name = call_names_->by_call.insert(make_pair(key,Utils::ReplaceAll(call_os.str()," ",""))).first; // remove spaces from call string
+	}
+	return name->second;
+}
+
+// the call's return value is fresh and relates to its arguments (snapshot in call#i) and to the other version's
+// call as the summary says. false if the callee has no summary.
+bool TransferFuncs::ApplySummary(CallExpr *node, const string &call_str) {
+	if (!summaries_)
+		return false;
+	const FunctionDecl *callee = node->getDirectCallee();
+	if (!callee)
+		return false;
+	const FunctionSummaries::Summary *summary = summaries_->Find(callee->getNameAsString());
+	if (!summary || summary->params.size() != node->getNumArgs())
+		return false;
+	string call = call_str, call_tag;
+	Utils::Names(call,call_tag);
+	set<abstract1> instance;
+	FunctionSummaries::Instantiate(*summary,call,instance);
+	if (instance.empty()) // the callee never returns, nothing to relate
+		return false;
+	state_.Forget(call_str);
+	nstate_.Forget(call_str);
+	for (unsigned int i = 0; i < node->getNumArgs(); ++i) {
+		var argument(FunctionSummaries::Argument(call_str,i));
+		state_.Forget(argument);
+		nstate_.Forget(argument);
+		// an argument with side effects is left unknown rather than evaluated twice
+		Expr *arg = node->getArg(i);
+		if (arg->HasSideEffects(analysis_data_ptr_->getContext()) || !arg->getType()->isIntegerType())
+			continue;
+		ExpressionState value = BlockStmt_Visit(arg);
+		state_.Assign(value.e_.get_environment(),argument,value.e_);
+		nstate_.Assign(value.e_.get_environment(),argument,value.e_);
+	}
+	state_.Assume(instance);
+	nstate_.Assume(instance);
+	return true;
+}
+
+// when summarizing, the returned value is assigned to return_var_ (tagged as the transformer is)
+ExpressionState TransferFuncs::VisitReturnStmt(ReturnStmt *node) {
+	ExpressionState result;
+	Expr *value = node->getRetValue();
+	if (return_var_.empty() || !value || !value->getType()->isIntegerType())
+		return result;
+	result = BlockStmt_Visit(value);
+	var v((tag_ ? Defines::kTagPrefix : "") + return_var_);
+	state_.Assign(result.e_.get_environment(),v,result.e_);
+	return result;
+}
+
 ExpressionState TransferFuncs::VisitParenExpr(ParenExpr *node) {
 	return expr_map_[node] = BlockStmt_Visit(node->getSubExpr());
 }
@@ -127,8 +186,8 @@ ExpressionState TransferFuncs::VisitImplicitCastExpr(ImplicitCastExpr * node) {
 			state_.MeetGuard(tcons1(texpr1(env,name_os.str()) == AnalysisUtils::kOne));
 			nstate_.MeetGuard(tcons1(texpr1(env,name_os.str()) == AnalysisUtils::kZero));
 		} else { // if (v) ; v can be any expression
-			if (expr_map_.count(node) == 0) {// print warning just one time
-				cerr << "Careful! the boolean condition (" << result.e_ <<
+			if (warned_.insert(node).second) {// print warning just one time
+				state_.Context().Warnings() << "Careful! the boolean condition (" << result.e_ <<
 						") will be modeled on the false path as " << tcons1(result.e_ > AnalysisUtils::kZero) <<
 						" V " << tcons1(result.e_ < AnalysisUtils::kZero) <<
 						". Partitioning will discard this data and the path may get crossed with the other CFG's true path.\n";
@@ -189,8 +248,8 @@ ExpressionState TransferFuncs::VisitArraySubscriptExpr(ArraySubscriptExpr *node)
 
 	set<abstract1> expr_abs_set, neg_expr_abs_set;
 	tcons1 constraint = (texpr1(idx.e_.get_environment(),array_idx) == idx.e_);
-	expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(*state_.mgr_ptr_,constraint));
-	AnalysisUtils::NegateConstraint(*state_.mgr_ptr_,constraint,neg_expr_abs_set);
+	expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(*state_.Context().mgr_ptr_,constraint));
+	AnalysisUtils::NegateConstraint(*state_.Context().mgr_ptr_,constraint,neg_expr_abs_set);
 	result.s_.Assume(expr_abs_set);
 	result.ns_.Assume(neg_expr_abs_set);
 
@@ -327,7 +386,7 @@ void TransferFuncs::AssignBoolExprToVar(const var& v, const ExpressionState& exp
 }
 
 ExpressionState TransferFuncs::VisitBinaryOperator(BinaryOperator* node) {
-	manager mgr = *(state_.mgr_ptr_);
+	manager mgr = *(state_.Context().mgr_ptr_);
 	environment &env = state_.env_;
 	Expr *lhs = node->getLHS(), *rhs = node->getRHS();
 	BlockStmt_Visit(lhs);
@@ -401,7 +460,7 @@ ExpressionState TransferFuncs::VisitBinaryOperator(BinaryOperator* node) {
 			vector<var> vars;
 			vars.push_back(array);
 			vars.push_back(index);
-			state_.read_map_[read] = vars;
+			state_.Context().read_map_[read] = vars;
 			// state_[v <- read(A,idx_l)] /\ {idx_l = i}
 			state_.Assign(env,left_var,texpr1(env,read));
 			texpr1 index_expr = Visit(array_subscript_expr->getIdx()).e_;
@@ -443,7 +502,7 @@ ExpressionState TransferFuncs::VisitBinaryOperator(BinaryOperator* node) {
 			vector<var> vars;
 			vars.push_back(array);
 			vars.push_back(index);
-			state_.update_map_[update] = vars;
+			state_.Context().update_map_[update] = vars;
 
 			// state_[update(A,idx_l) <- e] /\ {idx_l = i}
 			state_.Assign(env,update,right_texpr);
@@ -520,7 +579,7 @@ ExpressionState TransferFuncs::VisitBinaryOperator(BinaryOperator* node) {
 	case BO_EQ:
 	{
 		tcons1 constraint = (left_texpr == right_texpr);
-		expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(*state_.mgr_ptr_,constraint));
+		expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(*state_.Context().mgr_ptr_,constraint));
 		AnalysisUtils::NegateConstraint(mgr,constraint,neg_expr_abs_set);
 		result.s_.Assume(expr_abs_set);
 		result.ns_.Assume(neg_expr_abs_set);
@@ -653,39 +712,15 @@ ExpressionState TransferFuncs::VisitDeclStmt(DeclStmt* node) {
 				state_.at_diff_point_ = true;
 				analysis_data_ptr_->Observer->ObserveAll(state_, node->getLocStart());
 				// implement the partition-at-corr-point strategy
-				if ( state_.partition_point_ == AnalysisConfiguration::PARTITION_AT_CORR_POINT) {
+				if ( state_.Context().partition_point_ == AnalysisConfiguration::PARTITION_AT_CORR_POINT) {
 					state_.Partition();
 				}
 			}
 
 			if ( decl->getType().getTypePtr()->isIntegerType() ) { // apply to integers alone (this includes guards)
-				manager mgr = *(state_.mgr_ptr_);
 				var v(name.str());
-				/* first forget the variable (in case its defined in a loop) */
-				AbstractSet abstracts = state_.abs_set_;
-				state_.abs_set_.clear();
-				for (AbstractSet::const_iterator iter = abstracts.begin(), end = abstracts.end();  iter != end; ++iter) {
-					if (iter->vars.abstract()->get_environment().contains(v) &&
-							!iter->vars.abstract()->is_variable_unconstrained(mgr,v)) {
-						abstract1 abs(*(iter->vars.abstract()));
-						abs = abs.forget(mgr,v,true);
-						state_.abs_set_.insert(Abstract2(abs,iter->guards));
-					} else if (iter->guards.abstract()->get_environment().contains(v) &&
-							!iter->guards.abstract()->is_variable_unconstrained(mgr,v)) {
-						abstract1 abs(*(iter->guards.abstract()));
-						abs = abs.forget(mgr,v,true);
-						state_.abs_set_.insert(Abstract2(iter->vars,abs));
-					} else {
-						state_.abs_set_.insert(*iter);
-					}
-				}
-				/**
-				 * add the newly declared integer variable to the environment.
-				 * this should be the ONLY place this is needed!
-				 */
+				Declare(v);
 				environment &env = state_.env_;
-				if ( !env.contains(v) )
-					env = env.add(&v,1,0,0);
 				if ( Stmt* init = decl->getInit() ) {  // visit the subexpression to try and create an abstract expression
 					if (type != Defines::kGuardType && decl->getInit()->isKnownToHaveBooleanValue()) {
 						// take care of cases like: int x = (y < z);
@@ -695,7 +730,7 @@ ExpressionState TransferFuncs::VisitDeclStmt(DeclStmt* node) {
 					}
 				} else {
 					//assert(0 && "please avoid uninitialized variables, they decrease analysis precision.");
-					cerr << "Uninitialized variable " << v << " found. Uninitialized variables may decrease analysis precision.\n";
+					state_.Context().Warnings() << "Uninitialized variable " << v << " found. Uninitialized variables may decrease analysis precision.\n";
 				}
 			}
 		}
@@ -703,6 +738,389 @@ ExpressionState TransferFuncs::VisitDeclStmt(DeclStmt* node) {
 	return ExpressionState();
 }
 
+void TransferFuncs::Declare(const var &v) {
+	manager mgr = *(state_.Context().mgr_ptr_);
+	/* first forget the variable (in case its defined in a loop) */
+	AbstractSet abstracts = state_.abs_set_;
+	state_.abs_set_.clear();
+	for (AbstractSet::const_iterator iter = abstracts.begin(), end = abstracts.end();  iter != end; ++iter) {
+		if (iter->vars.abstract()->get_environment().contains(v) &&
+				!iter->vars.abstract()->is_variable_unconstrained(mgr,v)) {
+			abstract1 abs(*(iter->vars.abstract()));
+			abs = abs.forget(mgr,v,true);
+			state_.abs_set_.insert(Abstract2(abs,iter->guards));
+		} else if (iter->guards.abstract()->get_environment().contains(v) &&
+				!iter->guards.abstract()->is_variable_unconstrained(mgr,v)) {
+			abstract1 abs(*(iter->guards.abstract()));
+			abs = abs.forget(mgr,v,true);
+			state_.abs_set_.insert(Abstract2(iter->vars,abs));
+		} else {
+			state_.abs_set_.insert(*iter);
+		}
+	}
+	/**
+	 * add the newly declared integer variable to the environment.
+	 * this should be the ONLY place this is needed!
+	 */
+	environment &env = state_.env_;
+	if ( !env.contains(v) )
+		env = env.add(&v,1,0,0);
+}
+
+const TransferFuncs::BlockProgram &TransferFuncs::Compiled(const CFGBlock *block) {
+	pair<const CFGBlock*,bool> key(block,tag_);
+	map< pair<const CFGBlock*,bool>,BlockProgram >::iterator program = programs_->by_block.find(key);
+	if (program == programs_->by_block.end()) {
+		program = programs_->by_block.insert(make_pair(key,BlockProgram())).first;
+		Compile(block,program->second);
+	}
+	return program->second;
+}
+
+void TransferFuncs::ApplyBlock(const CFGBlock *block) {
+	Apply(Compiled(block).statements);
+}
+
+void TransferFuncs::ApplyCondition(const CFGBlock *block) {
+	Apply(Compiled(block).condition);
+}
+
+void TransferFuncs::Apply(const Program &program) {
+	for (Program::const_iterator iter = program.begin(), end = program.end(); iter != end; ++iter) {
+		switch (iter->kind) {
+		case Op::ASSIGN:
+			state_.Assign(state_.env_,iter->v,iter->expr,iter->is_guard);
+			if (iter->both)
+				nstate_.Assign(nstate_.env_,iter->v,iter->expr,iter->is_guard);
+			break;
+		case Op::DECLARE:
+			Declare(iter->v);
+			break;
+		case Op::FORGET: // as assigning the value of an expression the domain does not model
+			state_.Assign(state_.env_,iter->v,iter->expr);
+			break;
+		case Op::CONDITION: {
+			manager &mgr = *state_.Context().mgr_ptr_;
+			set<abstract1> expr_abs_set, neg_expr_abs_set;
+			for (vector<tcons1>::const_iterator cons = iter->cons.begin(), cons_end = iter->cons.end(); cons != cons_end; ++cons)
+				expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(mgr,*cons));
+			for (vector<tcons1>::const_iterator cons = iter->neg_cons.begin(), cons_end = iter->neg_cons.end(); cons != cons_end; ++cons)
+				neg_expr_abs_set.insert(AnalysisUtils::AbsFromConstraint(mgr,*cons));
+			State s, ns;
+			s.Assume(expr_abs_set);
+			ns.Assume(neg_expr_abs_set);
+			state_.Meet(s);
+			nstate_.Meet(ns);
+			break;
+		}
+		case Op::ARRAY_READ:
+		case Op::ARRAY_WRITE: {
+			environment &env = state_.env_;
+			if (!env.contains(iter->index))
+				env = env.add(&iter->index,1,0,0);
+			if (!env.contains(iter->cell))
+				env = env.add(&iter->cell,1,0,0);
+			vector<var> vars;
+			vars.push_back(iter->array);
+			vars.push_back(iter->index);
+			if (iter->kind == Op::ARRAY_READ) {
+				state_.Context().read_map_[iter->cell] = vars;
+				state_.Assign(env,iter->v,texpr1(env,iter->cell));
+			} else {
+				state_.Context().update_map_[iter->cell] = vars;
+				state_.Assign(env,iter->cell,iter->expr);
+			}
+			state_.Meet(iter->cons[0]);
+			if (iter->kind == Op::ARRAY_READ)
+				state_.ApplyArrayReadAfterUpdateDeductionRule(iter->cell);
+			break;
+		}
+		case Op::VISIT:
+			BlockStmt_Visit(iter->stmt);
+			break;
+		}
+	}
+	expr_map_.clear(); // a statement only reads back the expressions it just visited
+}
+
+void TransferFuncs::Compile(const CFGBlock *block, BlockProgram &program) {
+	for (CFGBlock::const_iterator iter = block->begin(), end = block->end(); iter != end; ++iter) {
+		CFGElement e = *iter;
+		if (const CFGStmt *statement = e.getAs<CFGStmt>()) {
+			Stmt *node = const_cast<Stmt*>(statement->getStmt());
+			if (!Lower(node,program.statements))
+				program.statements.push_back(Op(node));
+		}
+	}
+	Stmt *terminator = const_cast<Stmt*>(block->getTerminator().getStmt());
+	Expr *cond = NULL;
+	if (IfStmt *if_stmt = dyn_cast_or_null<IfStmt>(terminator))
+		cond = if_stmt->getCond();
+	else if (ForStmt *for_stmt = dyn_cast_or_null<ForStmt>(terminator))
+		cond = for_stmt->getCond();
+	else
+		terminator = NULL;
+	// for ( .. ; ; .. ) meets nothing
+	if (terminator && cond && !LowerCondition(cond,program.condition))
+		program.condition.push_back(Op(terminator));
+	expr_map_.clear();
+}
+
+namespace {
+
+// a variable the visitor names, and assigns as a scalar
+VarDecl *ScalarVar(Expr *node) {
+	DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node->IgnoreParens());
+	VarDecl *decl = ref ? dyn_cast<VarDecl>(ref->getDecl()) : NULL;
+	if (!decl || !(decl->getType()->isIntegerType() || decl->getType()->isFloatingType()) || decl->getType().getAsString() == Defines::kGuardType)
+		return NULL;
+	return decl;
+}
+
+// an expression the visitor builds without touching the states: arithmetic over scalars and literals
+bool Arithmetic(Expr *node) {
+	node = node->IgnoreParens();
+	if (isa<IntegerLiteral>(node) || isa<FloatingLiteral>(node) || isa<CharacterLiteral>(node))
+		return true;
+	if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node))
+		return ref->getType()->isIntegerType() || ref->getType()->isFloatingType();
+	if (ImplicitCastExpr *cast = dyn_cast<ImplicitCastExpr>(node))
+		return cast->getCastKind() != CK_IntegralToBoolean && Arithmetic(cast->getSubExpr());
+	if (UnaryOperator *op = dyn_cast<UnaryOperator>(node))
+		return op->getOpcode() == UO_Minus && Arithmetic(op->getSubExpr());
+	if (BinaryOperator *op = dyn_cast<BinaryOperator>(node)) {
+		switch (op->getOpcode()) {
+		case BO_Add:
+		case BO_Sub:
+		case BO_Mul:
+		case BO_Div:
+		case BO_Rem:
+			return Arithmetic(op->getLHS()) && Arithmetic(op->getRHS());
+		default:
+			return false;
+		}
+	}
+	return false;
+}
+
+// an expression whose visit leaves the states as they are: arithmetic, or a comparison of arithmetic
+bool Pure(Expr *node) {
+	BinaryOperator *op = dyn_cast<BinaryOperator>(node->IgnoreParens());
+	if (op && op->isComparisonOp())
+		return Arithmetic(op->getLHS()) && Arithmetic(op->getRHS());
+	return Arithmetic(node);
+}
+
+}
+
+// the operations node amounts to, as VisitBinaryOperator, VisitUnaryOperator and VisitDeclStmt apply them.
+// false if it is left to the visitor.
+bool TransferFuncs::Lower(Stmt *node, Program &program) {
+	// the CFG lists a terminator's condition (and may list operands) on its own, visited for its value alone
+	if (isa<Expr>(node) && Pure(cast<Expr>(node)))
+		return true;
+	if (BinaryOperator *op = dyn_cast<BinaryOperator>(node)) {
+		if (op->getOpcode() == BO_Assign && LowerArrayAccess(op,program))
+			return true;
+		VarDecl *decl = ScalarVar(op->getLHS());
+		if (!decl)
+			return false;
+		switch (op->getOpcode()) {
+		case BO_AndAssign: // the visitor leaves the states as they are
+		case BO_OrAssign:
+		case BO_XorAssign:
+		case BO_ShlAssign:
+		case BO_ShrAssign:
+			return true;
+		default:
+			break;
+		}
+		if (op->getOpcode() == BO_Assign && !op->getRHS()->isKnownToHaveBooleanValue()) {
+			BinaryOperator *bits = dyn_cast<BinaryOperator>(op->getRHS()->IgnoreParens());
+			if (bits && (bits->getOpcode() == BO_And || bits->getOpcode() == BO_Or || bits->getOpcode() == BO_Xor ||
+					bits->getOpcode() == BO_Shl || bits->getOpcode() == BO_Shr) && Arithmetic(bits->getLHS()) && Arithmetic(bits->getRHS())) {
+				program.push_back(Op(Op::FORGET,var((tag_ ? Defines::kTagPrefix : "") + decl->getNameAsString())));
+				return true;
+			}
+		}
+		if (!Arithmetic(op->getRHS()))
+			return false;
+		var v((tag_ ? Defines::kTagPrefix : "") + decl->getNameAsString());
+		texpr1 left = BlockStmt_Visit(op->getLHS()), right = BlockStmt_Visit(op->getRHS());
+		environment env = AnalysisUtils::JoinEnvironments(left.get_environment(),right.get_environment());
+		left.extend_environment(env);
+		right.extend_environment(env);
+		switch (op->getOpcode()) {
+		case BO_Assign:
+			if (op->getRHS()->isKnownToHaveBooleanValue())
+				return false;
+			program.push_back(Op(v,right,false,false));
+			return true;
+		case BO_AddAssign:
+			program.push_back(Op(v,left + right,false,false));
+			return true;
+		case BO_SubAssign:
+			program.push_back(Op(v,left - right,false,false));
+			return true;
+		case BO_MulAssign:
+			program.push_back(Op(v,left * right,false,false));
+			return true;
+		case BO_DivAssign:
+			program.push_back(Op(v,left / right,false,false));
+			return true;
+		case BO_RemAssign: {
+			texpr1 remainder = left % right;
+			remainder.get_texpr0() = left.get_texpr0() % right.get_texpr0();
+			program.push_back(Op(v,remainder,false,false));
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+	if (UnaryOperator *op = dyn_cast<UnaryOperator>(node)) {
+		VarDecl *decl = ScalarVar(op->getSubExpr());
+		if (!decl || !op->isIncrementDecrementOp())
+			return false;
+		var v((tag_ ? Defines::kTagPrefix : "") + decl->getNameAsString());
+		texpr1 sub = BlockStmt_Visit(op->getSubExpr());
+		program.push_back(Op(v,op->isIncrementOp() ? sub + AnalysisUtils::kOne : sub - AnalysisUtils::kOne,false,true));
+		return true;
+	}
+	if (DeclStmt *decls = dyn_cast<DeclStmt>(node)) {
+		Program lowered;
+		for (DeclStmt::const_decl_iterator iter = decls->decl_begin(), end = decls->decl_end(); iter != end; ++iter) {
+			VarDecl *decl = dyn_cast<VarDecl>(*iter);
+			if (!decl)
+				return false;
+			string name = (tag_ ? Defines::kTagPrefix : "") + decl->getNameAsString();
+			if (name.find(Defines::kCorrPointPrefix) == 0)
+				return false;
+			if (!decl->getType().getTypePtr()->isIntegerType())
+				continue;
+			bool is_guard = (decl->getType().getAsString() == Defines::kGuardType);
+			Expr *init = decl->getInit();
+			if (!init || !Arithmetic(init) || (!is_guard && init->isKnownToHaveBooleanValue()))
+				return false;
+			var v(name);
+			lowered.push_back(Op(Op::DECLARE,v));
+			lowered.push_back(Op(v,Visit(init),is_guard,false));
+		}
+		program.insert(program.end(),lowered.begin(),lowered.end());
+		return true;
+	}
+	return false;
+}
+
+// an assignment from a cell of an array to a variable, or of arithmetic to a cell, as VisitBinaryOperator instruments
+// it: the cell read (or updated) is named by the array and the index of the access at this location
+bool TransferFuncs::LowerArrayAccess(BinaryOperator *node, Program &program) {
+	ArraySubscriptExpr *read = dyn_cast<ArraySubscriptExpr>(node->getRHS()->IgnoreParenCasts());
+	ArraySubscriptExpr *write = dyn_cast<ArraySubscriptExpr>(node->getLHS()->IgnoreParenCasts());
+	ArraySubscriptExpr *access = read ? read : write;
+	if (!access || (read && write) || node->getRHS()->isKnownToHaveBooleanValue())
+		return false;
+	VarDecl *array_decl = FindBlockVarDecl(access), *decl = read ? ScalarVar(node->getLHS()) : NULL;
+	if (!array_decl || !array_decl->getType()->isPointerType() || !Arithmetic(access->getIdx()) ||
+			(read && !decl) || (write && !Arithmetic(node->getRHS())))
+		return false;
+	string prefix = (tag_ ? Defines::kTagPrefix : "");
+	stringstream index_ss;
+	index_ss << prefix << Defines::kArrayIndexPrefix << node->getLocStart().getRawEncoding();
+	Op op(read ? Op::ARRAY_READ : Op::ARRAY_WRITE,var(read ? prefix + decl->getNameAsString() : string()));
+	op.array = var(prefix + array_decl->getNameAsString());
+	op.index = var(index_ss.str());
+	stringstream cell_ss;
+	cell_ss << (read ? Defines::kArrayReadPrefix : Defines::kArrayUpdatePrefix) << "( " << op.array << " , " << op.index << " )";
+	op.cell = var(cell_ss.str());
+	if (write) {
+		texpr1 left = BlockStmt_Visit(node->getLHS()), right = BlockStmt_Visit(node->getRHS());
+		right.extend_environment(AnalysisUtils::JoinEnvironments(left.get_environment(),right.get_environment()));
+		op.expr = right;
+	}
+	texpr1 index_expr = Visit(access->getIdx()).e_;
+	environment env = index_expr.get_environment();
+	if (!env.contains(op.index))
+		env = env.add(&op.index,1,0,0);
+	index_expr.extend_environment(env);
+	op.cons.push_back(texpr1(env,op.index) == index_expr);
+	program.push_back(op);
+	return true;
+}
+
+// the comparison of arithmetic cond is, as the constraints VisitBinaryOperator builds for it and for its negation
+bool TransferFuncs::LowerCondition(Expr *cond, Program &program) {
+	BinaryOperator *op = dyn_cast<BinaryOperator>(cond->IgnoreParens());
+	if (!op || !op->isComparisonOp() || !Arithmetic(op->getLHS()) || !Arithmetic(op->getRHS()))
+		return false;
+	texpr1 left = BlockStmt_Visit(op->getLHS()), right = BlockStmt_Visit(op->getRHS());
+	environment env = AnalysisUtils::JoinEnvironments(left.get_environment(),right.get_environment());
+	left.extend_environment(env);
+	right.extend_environment(env);
+	Op condition(Op::CONDITION,var(string()));
+	switch (op->getOpcode()) {
+	case BO_EQ:
+		condition.cons.push_back(left == right);
+		break;
+	case BO_NE:
+		condition.neg_cons.push_back(left == right);
+		break;
+	case BO_GE:
+		condition.cons.push_back(left >= right);
+		break;
+	case BO_GT:
+		condition.cons.push_back(left >= right + AnalysisUtils::kOne);
+		break;
+	case BO_LE:
+		condition.cons.push_back(left <= right);
+		break;
+	case BO_LT:
+		condition.cons.push_back(left <= right - AnalysisUtils::kOne);
+		break;
+	default:
+		return false;
+	}
+	if (op->getOpcode() == BO_NE)
+		AnalysisUtils::NegatedConstraints(condition.neg_cons[0],condition.cons);
+	else
+		AnalysisUtils::NegatedConstraints(condition.cons[0],condition.neg_cons);
+	program.push_back(condition);
+	return true;
+}
+
+bool TransferFuncs::Distributive(const CFGBlock *block) {
+	const BlockProgram &program = Compiled(block);
+	// arrays: the deduction rules read the accesses of the whole run (the context's read and update maps)
+	for (unsigned int i = 0; i < 2; ++i) {
+		const Program &ops = i ? program.condition : program.statements;
+		for (Program::const_iterator iter = ops.begin(), end = ops.end(); iter != end; ++iter) {
+			if (iter->kind == Op::VISIT || iter->kind == Op::ARRAY_READ || iter->kind == Op::ARRAY_WRITE)
+				return false;
+		}
+	}
+	const Stmt *terminator = block->getTerminator().getStmt();
+	if (!terminator)
+		return true;
+	switch (terminator->getStmtClass()) {
+	case Stmt::BreakStmtClass:
+	case Stmt::IfStmtClass: // its condition is lowered
+	case Stmt::ForStmtClass:
+		return true;
+	default: // short-circuit evaluation is not visited, anything else is not supported
+		if (const BinaryOperator *op = dyn_cast<BinaryOperator>(terminator))
+			return op->getOpcode() == BO_LAnd || op->getOpcode() == BO_LOr;
+		return false;
+	}
+}
+
+void TransferFuncs::Declarations(const CFGBlock *block, environment &env) {
+	const Program &program = Compiled(block).statements;
+	for (Program::const_iterator iter = program.begin(), end = program.end(); iter != end; ++iter) {
+		if (iter->kind == Op::DECLARE && !env.contains(iter->v))
+			env = env.add(&iter->v,1,0,0);
+	}
+}
+
 #define DEBUGVisitIntegerLiteral 0
 ExpressionState TransferFuncs::VisitIntegerLiteral(IntegerLiteral * node) {
 	long int value = node->getValue().getLimitedValue();
@@ -9,6 +9,8 @@
 #define CORRELATINGTRANSFORMER_H_
 
 #include <map>
+#include <set>
+#include <vector>
 #include <iostream>
 #include <cstdio>
 using namespace std;
@@ -20,9 +22,11 @@ using namespace std;
 #include <clang/AST/ASTContext.h>
 #include <clang/Analysis/FlowSensitive/DataflowSolver.h>
 #include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
 using namespace clang;
 
 #include "APAbstractDomain.h"
+#include "FunctionSummaries.h"
 #include "../Defines.h"
 #include "../Utils.h"
 
@@ -35,9 +39,52 @@ struct ExpressionState;
 
 class TransferFuncs : public CFGStmtVisitor<TransferFuncs,ExpressionState> {
 
+        /**
+         * A block's statements lowered to operations on the states, so that a block visited many times is
+         * walked (its names printed and its expressions built) only once: assignments of arithmetic over
+         * variables and literals (of what the domain does not model, forgetting the variable), declarations,
+         * reads from and writes to arrays with their instrumentation, and the comparisons its terminator
+         * meets the states with. Expressions without effects are dropped. Any other statement (calls, guards,
+         * correlation points, conditions that are not comparisons) is visited as it is.
+         */
+        struct Op {
+        	enum Kind { ASSIGN, DECLARE, FORGET, CONDITION, ARRAY_READ, ARRAY_WRITE, VISIT } kind;
+        	var v;
+        	texpr1 expr;
+        	// CONDITION: state_ meets the disjunction of cons, and nstate_ that of neg_cons. ARRAY_READ and
+        	// ARRAY_WRITE: state_ meets cons, the index of the access
+        	vector<tcons1> cons, neg_cons;
+        	var array, index, cell; // ARRAY_READ: v is assigned the read cell, ARRAY_WRITE: expr is written to it
+        	bool is_guard;
+        	bool both; // nstate_ is assigned as well
+        	Stmt *stmt; // visited
+        	Op(Stmt *s) : kind(VISIT), v(string()), expr(texpr1::builder(environment(),top())), array(string()), index(string()), cell(string()),
+        		is_guard(false), both(false), stmt(s) { }
+        	Op(Kind k, const var &variable) : kind(k), v(variable), expr(texpr1::builder(environment(),top())), array(string()), index(string()),
+        		cell(string()), is_guard(false), both(false), stmt(NULL) { }
+        	Op(const var &variable, const texpr1 &e, bool guard, bool assign_both) :
+        		kind(ASSIGN), v(variable), expr(e), array(string()), index(string()), cell(string()), is_guard(guard), both(assign_both), stmt(NULL) { }
+        };
+        typedef vector<Op> Program;
+        struct BlockProgram {
+        	Program statements;
+        	Program condition; // of the terminator (an if or a for), applied to state_ and nstate_
+        };
+        // by block and tag_, shared by the copies of a transformer (the solver's snapshots)
+        struct Programs : public llvm::RefCountedBase<Programs> {
+        	map< pair<const CFGBlock*,bool>,BlockProgram > by_block;
+        };
+
         State state_, nstate_;
         APAbstractDomain::AnalysisDataTy * analysis_data_ptr_;
-        map<Expr*,ExpressionState> expr_map_;
+        map<Expr*,ExpressionState> expr_map_; // the values of the expressions visited, emptied after each block
+        set<Expr*> warned_; // the boolean conditions warned about
+        llvm::IntrusiveRefCntPtr<Programs> programs_;
+        // the names of the calls' values by call site and tag_, printed once and shared likewise
+        struct CallNames : public llvm::RefCountedBase<CallNames> {
+        	map< pair<const CallExpr*,bool>,string > by_call;
+        };
+        llvm::IntrusiveRefCntPtr<CallNames> call_names_;
         string current_guard_;
         bool report_;
 
@@ -46,14 +93,25 @@ class TransferFuncs : public CFGStmtVisitor<TransferFuncs,ExpressionState> {
         ExpressionState ApplyExpressionToState(BinaryOperator *node, const texpr1 &expression);
         void SetGuard(const set<abstract1> &expr_abs, const set<abstract1> &neg_expr_abs);
         void AssignBoolExprToVar(const var& v, const ExpressionState& expr, environment& env);
+        bool ApplySummary(CallExpr *node, const string &call_str);
+        void Declare(const var &v);
+        const BlockProgram &Compiled(const CFGBlock *block);
+        void Compile(const CFGBlock *block, BlockProgram &program);
+        bool Lower(Stmt *node, Program &program);
+        bool LowerArrayAccess(BinaryOperator *node, Program &program);
+        bool LowerCondition(Expr *cond, Program &program);
+        void Apply(const Program &program);
 
     public:
 
         bool tag_; // setting this makes the transformer treat all variables as if they are tagged
+        const FunctionSummaries *summaries_; // of the callees (NULL: calls are opaque)
+        string return_var_; // what a return statement assigns (empty: returns are ignored)
+        bool calls_assumed_; // the calls' equivalence is in the initial state, and not assumed at every call
 
-        TransferFuncs() {}
+        TransferFuncs() : programs_(new Programs()), call_names_(new CallNames()), summaries_(NULL), calls_assumed_(false) {}
 
-        TransferFuncs(APAbstractDomain::AnalysisDataTy& ad, bool reportResults = false) : tag_(false), analysis_data_ptr_(&ad), report_(reportResults), current_guard_("") { }
+        TransferFuncs(APAbstractDomain::AnalysisDataTy& ad, bool reportResults = false) : programs_(new Programs()), call_names_(new CallNames()), tag_(false), summaries_(NULL), calls_assumed_(false), analysis_data_ptr_(&ad), report_(reportResults), current_guard_("") { }
 
         ExpressionState VisitDeclRefExpr(DeclRefExpr* node);
         ExpressionState VisitBinaryOperator(BinaryOperator* node);
@@ -64,6 +122,7 @@ class TransferFuncs : public CFGStmtVisitor<TransferFuncs,ExpressionState> {
         ExpressionState VisitCharacterLiteral(CharacterLiteral * node);
         ExpressionState VisitImplicitCastExpr(ImplicitCastExpr * node);
         ExpressionState VisitCallExpr(CallExpr * node);
+        ExpressionState VisitReturnStmt(ReturnStmt * node);
 		ExpressionState VisitParenExpr(ParenExpr *node);
 		ExpressionState VisitIfStmt(IfStmt* node);
 		ExpressionState VisitForStmt(ForStmt* node);
@@ -71,6 +130,15 @@ class TransferFuncs : public CFGStmtVisitor<TransferFuncs,ExpressionState> {
 		ExpressionState VisitArraySubscriptExpr(ArraySubscriptExpr *node);
 		void VisitTerminator(CFGBlock* B) { }
 		VarDecl*   FindBlockVarDecl(Expr* node);
+		// the variable holding the call's value: the call as clang prints it, without spaces (tagged as tag_ says)
+		const string &CallName(CallExpr *node);
+		void ApplyBlock(const CFGBlock *block); // the block's statements (not its terminator), as compiled on the first visit
+		// the condition of the block's terminator (an if or a for): state_ meets it and nstate_ its negation
+		void ApplyCondition(const CFGBlock *block);
+		// whether applying the block and its terminator's condition to a state is applying them to each of its
+		// disjuncts alone (see IterativeSolver::Transfer): assignments, declarations and comparisons only
+		bool Distributive(const CFGBlock *block);
+		void Declarations(const CFGBlock *block, environment &env); // adds the variables the block declares
 
 		State& getVal()  { return state_; }
         State& getNVal() { return nstate_; }
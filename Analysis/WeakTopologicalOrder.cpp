@@ -0,0 +1,133 @@
+/*
+ * WeakTopologicalOrder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "WeakTopologicalOrder.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace differential {
+
+namespace {
+
+struct Frame {
+	unsigned int node, next;
+	Frame(unsigned int node) : node(node), next(0) { }
+};
+
+}
+
+void WeakTopologicalOrder::Compute(const Graph &succs, unsigned int root) {
+	const unsigned int size = succs.size();
+	assert(root < size);
+	order_.clear();
+	position_.assign(size, UNORDERED);
+	head_.assign(size, false);
+	component_.clear();
+	components_.clear();
+	region_.assign(size, 0);
+	index_.assign(size, -1);
+	low_.assign(size, 0);
+	on_stack_.assign(size, false);
+	regions_ = 0;
+	Decompose(succs, vector<unsigned int>(1, root), 0, -1);
+	// release the scratch space
+	vector<int>().swap(region_);
+	vector<int>().swap(index_);
+	vector<int>().swap(low_);
+	vector<bool>().swap(on_stack_);
+}
+
+WeakTopologicalOrder::Span WeakTopologicalOrder::Component(unsigned int position) const {
+	assert(position < order_.size());
+	int component = component_[position];
+	if (component < 0)
+		return Span(0, order_.size());
+	return components_[component];
+}
+
+/**
+ * Order the nodes of region reachable from starts: split them into strongly connected components (Tarjan,
+ * with an explicit stack), order the components topologically, and order each non-trivial component as its
+ * head (the node through which the search entered it) followed by the decomposition of the rest of it.
+ */
+void WeakTopologicalOrder::Decompose(const Graph &succs, const vector<unsigned int> &starts, int region, int parent) {
+	vector< vector<unsigned int> > sccs; // reverse topological order, the first node of each is the one entered first
+	vector<unsigned int> visited, stack;
+	int counter = 0;
+	for (vector<unsigned int>::const_iterator start = starts.begin(), starts_end = starts.end(); start != starts_end; ++start) {
+		if (region_[*start] != region || index_[*start] >= 0)
+			continue;
+		vector<Frame> frames;
+		frames.push_back(Frame(*start));
+		index_[*start] = low_[*start] = counter++;
+		visited.push_back(*start);
+		stack.push_back(*start);
+		on_stack_[*start] = true;
+		while (!frames.empty()) {
+			unsigned int node = frames.back().node;
+			if (frames.back().next < succs[node].size()) {
+				unsigned int succ = succs[node][frames.back().next++];
+				if (region_[succ] != region)
+					continue;
+				if (index_[succ] < 0) {
+					index_[succ] = low_[succ] = counter++;
+					visited.push_back(succ);
+					stack.push_back(succ);
+					on_stack_[succ] = true;
+					frames.push_back(Frame(succ));
+				} else if (on_stack_[succ]) {
+					low_[node] = min(low_[node], index_[succ]);
+				}
+				continue;
+			}
+			frames.pop_back();
+			if (!frames.empty())
+				low_[frames.back().node] = min(low_[frames.back().node], low_[node]);
+			if (low_[node] != index_[node])
+				continue;
+			vector<unsigned int> scc;
+			unsigned int member;
+			do {
+				member = stack.back();
+				stack.pop_back();
+				on_stack_[member] = false;
+				scc.push_back(member);
+			} while (member != node);
+			reverse(scc.begin(), scc.end());
+			sccs.push_back(scc);
+		}
+	}
+	for (vector<unsigned int>::const_iterator iter = visited.begin(), end = visited.end(); iter != end; ++iter) {
+		index_[*iter] = -1;
+	}
+
+	for (vector< vector<unsigned int> >::const_reverse_iterator scc = sccs.rbegin(), sccs_end = sccs.rend(); scc != sccs_end; ++scc) {
+		unsigned int head = scc->front();
+		bool loop = scc->size() > 1 || find(succs[head].begin(), succs[head].end(), head) != succs[head].end();
+		position_[head] = order_.size();
+		order_.push_back(head);
+		if (!loop) {
+			component_.push_back(parent);
+			continue;
+		}
+		int component = components_.size();
+		components_.push_back(Span(order_.size() - 1, 0));
+		component_.push_back(component);
+		head_[head] = true;
+		// the rest of the component is a region of its own, entered through the head's successors
+		int inner = ++regions_;
+		for (vector<unsigned int>::const_iterator iter = scc->begin() + 1, end = scc->end(); iter != end; ++iter) {
+			region_[*iter] = inner;
+		}
+		region_[head] = -1;
+		Decompose(succs, succs[head], inner, component);
+		components_[component].second = order_.size();
+	}
+}
+
+}
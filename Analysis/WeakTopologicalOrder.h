@@ -0,0 +1,61 @@
+/*
+ * WeakTopologicalOrder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef WEAKTOPOLOGICALORDER_H_
+#define WEAKTOPOLOGICALORDER_H_
+
+#include <utility>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * Bourdoncle's weak topological order of a graph: a total order of the nodes reachable from the root in
+ * which every strongly connected component is contiguous, starts at its head, and is recursively ordered
+ * after its head is removed. Every cycle goes through the head of some component, so the heads are
+ * sufficient widening points, and iterating a component until it is stable before moving past it
+ * stabilizes inner loops before outer ones.
+ * Nodes are dense indices, and the order only depends on the order of the successor lists.
+ */
+class WeakTopologicalOrder {
+public:
+	typedef vector< vector<unsigned int> > Graph; // node -> successors
+	typedef pair<unsigned int, unsigned int> Span; // [begin,end) positions
+
+	enum { UNORDERED = ~0u };
+
+	WeakTopologicalOrder() { }
+	virtual ~WeakTopologicalOrder() { }
+
+	void Compute(const Graph &succs, unsigned int root);
+
+	unsigned int size() const { return order_.size(); }
+	unsigned int Node(unsigned int position) const { return order_[position]; }
+	// UNORDERED for nodes that are not reachable from the root
+	unsigned int Position(unsigned int node) const { return position_[node]; }
+	bool IsHead(unsigned int node) const { return head_[node]; }
+	// the innermost component containing the node at position, [0,size()) if there is none
+	Span Component(unsigned int position) const;
+
+private:
+	void Decompose(const Graph &succs, const vector<unsigned int> &starts, int region, int parent);
+
+	vector<unsigned int> order_, position_;
+	vector<bool> head_;
+	vector<int> component_; // position -> innermost component (-1 for none)
+	vector<Span> components_;
+
+	// scratch space of the SCC decomposition, per node
+	vector<int> region_, index_, low_;
+	vector<bool> on_stack_;
+	int regions_;
+};
+
+}
+
+#endif /* WEAKTOPOLOGICALORDER_H_ */
@@ -0,0 +1,310 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "WorkerPool.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace differential {
+
+namespace {
+
+struct Worker {
+	pid_t pid;
+	int fd;
+	unsigned int job;
+};
+
+bool WriteAll(int fd, const string &data) {
+	size_t written = 0;
+	while (written < data.size()) {
+		ssize_t n = write(fd, data.data() + written, data.size() - written);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		written += n;
+	}
+	return true;
+}
+
+bool Reap(pid_t pid, int &status) {
+	status = 0;
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR)
+			return false;
+	}
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool Reap(const Worker &worker, int &status) {
+	return Reap(worker.pid, status);
+}
+
+// anything still buffered would be flushed a second time by every worker
+void Flush() {
+	cout.flush();
+	cerr.flush();
+	llvm::outs().flush();
+	fflush(NULL);
+}
+
+// requests and replies to long-lived workers are sent as "<size>\n<data>"
+bool WriteFrame(int fd, const string &data) {
+	stringstream header;
+	header << data.size() << '\n';
+	return WriteAll(fd, header.str()) && WriteAll(fd, data);
+}
+
+// buffer holds what was read from a worker so far, true once it holds a whole frame (which is then in data)
+bool Framed(const string &buffer, string &data) {
+	size_t newline = buffer.find('\n');
+	if (newline == string::npos)
+		return false;
+	size_t size = 0;
+	istringstream header(buffer.substr(0, newline));
+	header >> size;
+	if (buffer.size() - newline - 1 < size)
+		return false;
+	data = buffer.substr(newline + 1, size);
+	return true;
+}
+
+bool ReadFrame(int fd, string &data) {
+	string buffer;
+	while (!Framed(buffer, data)) {
+		char chunk[4096];
+		ssize_t n = read(fd, chunk, sizeof(chunk));
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		buffer.append(chunk, n);
+	}
+	return true;
+}
+
+}
+
+void WorkerPool::Run(const vector<Job*> &jobs, vector<string> &outputs, vector<bool> &succeeded, vector<int> *statuses) {
+	outputs.assign(jobs.size(), "");
+	succeeded.assign(jobs.size(), false);
+	vector<int> status(jobs.size(), -1);
+
+	Flush();
+
+	vector<Worker> active;
+	unsigned int next = 0;
+	while (next < jobs.size() || !active.empty()) {
+		// keep the pool full
+		while (next < jobs.size() && active.size() < size_) {
+			int fds[2];
+			pid_t pid = -1;
+			if (pipe(fds) == 0) {
+				pid = fork();
+				if (pid < 0) {
+					close(fds[0]);
+					close(fds[1]);
+				}
+			}
+			if (pid < 0) {
+				if (!active.empty())
+					break; // try again once a worker is done
+				// no worker could be started at all, run the job here
+				stringstream out;
+				jobs[next]->Run(out);
+				outputs[next] = out.str();
+				succeeded[next] = true;
+				++next;
+				continue;
+			}
+			if (pid == 0) { // worker
+				close(fds[0]);
+				jobs[next]->Isolate();
+				stringstream out;
+				jobs[next]->Run(out);
+				bool written = WriteAll(fds[1], out.str());
+				close(fds[1]);
+				_exit(written ? 0 : 1); // skip atexit handlers and buffers inherited from the parent
+			}
+			close(fds[1]);
+			Worker worker = { pid, fds[0], next++ };
+			active.push_back(worker);
+		}
+		if (active.empty())
+			continue;
+
+		// collect output from whoever is ready
+		vector<struct pollfd> fds(active.size());
+		for (unsigned int i = 0; i < active.size(); ++i) {
+			fds[i].fd = active[i].fd;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+		if (poll(&fds[0], fds.size(), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("WorkerPool: poll");
+			// give up on the running workers, they are reported as failed
+			for (unsigned int i = 0; i < active.size(); ++i) {
+				kill(active[i].pid, SIGKILL);
+				close(active[i].fd);
+				Reap(active[i], status[active[i].job]);
+			}
+			active.clear();
+			continue;
+		}
+		// go backwards so that erasing a finished worker keeps fds and active aligned
+		for (int i = active.size() - 1; i >= 0; --i) {
+			if (fds[i].revents == 0)
+				continue;
+			char buffer[4096];
+			ssize_t n = read(active[i].fd, buffer, sizeof(buffer));
+			if (n > 0) {
+				outputs[active[i].job].append(buffer, n);
+				continue;
+			}
+			if (n < 0 && errno == EINTR)
+				continue;
+			// end of output, the worker is done
+			close(active[i].fd);
+			succeeded[active[i].job] = Reap(active[i], status[active[i].job]);
+			active.erase(active.begin() + i);
+		}
+	}
+	if (statuses)
+		statuses->swap(status);
+}
+
+bool WorkerPool::Start(Server &server) {
+	Stop();
+	Flush();
+	// a worker that died must fail its reply, not kill the parent writing to it
+	signal(SIGPIPE, SIG_IGN);
+	while (servers_.size() < size_) {
+		int requests[2], replies[2];
+		if (pipe(requests) != 0)
+			break;
+		if (pipe(replies) != 0) {
+			close(requests[0]);
+			close(requests[1]);
+			break;
+		}
+		pid_t pid = fork();
+		if (pid < 0) {
+			close(requests[0]);
+			close(requests[1]);
+			close(replies[0]);
+			close(replies[1]);
+			break;
+		}
+		if (pid == 0) { // worker
+			close(requests[1]);
+			close(replies[0]);
+			// the ends of the workers forked before this one, which only see their requests end once the parent's close
+			for (unsigned int i = 0; i < servers_.size(); ++i) {
+				close(servers_[i].requests);
+				close(servers_[i].replies);
+			}
+			string request;
+			while (ReadFrame(requests[0], request)) {
+				istringstream in(request);
+				stringstream out;
+				bool served = server.Serve(in, out);
+				if (!served || !WriteFrame(replies[1], out.str()))
+					_exit(1);
+			}
+			_exit(0); // the parent stopped the pool
+		}
+		close(requests[0]);
+		close(replies[1]);
+		Resident resident = { pid, requests[1], replies[0] };
+		servers_.push_back(resident);
+	}
+	if (servers_.size() < size_) {
+		perror("WorkerPool: starting workers");
+		Stop();
+		return false;
+	}
+	return true;
+}
+
+void WorkerPool::Call(const vector<string> &requests, vector<string> &replies, vector<bool> &succeeded) {
+	assert(requests.size() <= servers_.size());
+	replies.assign(requests.size(), "");
+	succeeded.assign(requests.size(), false);
+	// a worker reads its whole request before it replies, so the requests can be written one after the other
+	vector<unsigned int> pending;
+	for (unsigned int i = 0; i < requests.size(); ++i) {
+		if (WriteFrame(servers_[i].requests, requests[i]))
+			pending.push_back(i);
+	}
+	vector<string> buffers(requests.size());
+	while (!pending.empty()) {
+		vector<struct pollfd> fds(pending.size());
+		for (unsigned int i = 0; i < pending.size(); ++i) {
+			fds[i].fd = servers_[pending[i]].replies;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+		if (poll(&fds[0], fds.size(), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("WorkerPool: poll");
+			break; // the pending replies are reported as failed
+		}
+		// go backwards so that erasing a finished worker keeps fds and pending aligned
+		for (int i = pending.size() - 1; i >= 0; --i) {
+			if (fds[i].revents == 0)
+				continue;
+			unsigned int worker = pending[i];
+			char buffer[4096];
+			ssize_t n = read(servers_[worker].replies, buffer, sizeof(buffer));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n > 0)
+				buffers[worker].append(buffer, n);
+			if (n > 0 && !Framed(buffers[worker], replies[worker]))
+				continue;
+			succeeded[worker] = (n > 0); // a worker that ended before its reply did failed
+			pending.erase(pending.begin() + i);
+		}
+	}
+	for (unsigned int i = 0; i < succeeded.size(); ++i) {
+		if (!succeeded[i]) {
+			Stop();
+			break;
+		}
+	}
+}
+
+void WorkerPool::Stop() {
+	// a worker exits once its requests end, or is killed if it is (or is stuck) in the middle of one
+	for (unsigned int i = 0; i < servers_.size(); ++i) {
+		close(servers_[i].requests);
+		close(servers_[i].replies);
+		kill(servers_[i].pid, SIGKILL);
+		int status;
+		Reap(servers_[i].pid, status);
+	}
+	servers_.clear();
+}
+
+}
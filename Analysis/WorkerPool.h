@@ -0,0 +1,87 @@
+/*
+ * WorkerPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <sys/types.h>
+
+namespace differential {
+
+/**
+ * A bounded pool of forked worker processes.
+ * Apron abstracts (and the Abstract1 dictionary that shares them) are reference counted without locking
+ * and are canonicalized lazily even by read-only operations, so they cannot be used from several threads.
+ * Instead, every job runs in a forked process over a copy-on-write image of the analysis, and sends its
+ * result back to the parent as text.
+ * The pool either forks a worker per job (Run), or forks its workers once and keeps them serving requests
+ * (Start, Call and Stop), so that what a worker holds is only sent to it as it changes.
+ */
+class WorkerPool {
+public:
+
+	struct Job {
+		virtual ~Job() { }
+		// invoked inside the worker process, everything written to out is handed back to the parent.
+		// a job must also be safe to run in-process, which is what happens if a worker cannot be forked.
+		virtual void Run(ostream &out) = 0;
+		// invoked inside the worker process only, before Run (e.g. to limit its resources)
+		virtual void Isolate() { }
+	};
+
+	struct Server {
+		virtual ~Server() { }
+		// invoked inside a long-lived worker for each of its requests, everything written to out is the reply.
+		// false if the worker can no longer serve, it then exits and its reply is reported as failed.
+		virtual bool Serve(istream &request, ostream &out) = 0;
+	};
+
+	WorkerPool(unsigned int size) : size_(size ? size : 1) { }
+	virtual ~WorkerPool() { Stop(); }
+
+	unsigned int size() const { return size_; }
+	bool started() const { return !servers_.empty(); }
+
+	/**
+	 * Run all jobs, with at most size() of them at a time.
+	 * outputs[i] is the output of jobs[i] and succeeded[i] tells whether its worker exited normally.
+	 * If statuses is given, (*statuses)[i] is the wait status of jobs[i]'s worker, -1 if it ran in-process.
+	 */
+	void Run(const vector<Job*> &jobs, vector<string> &outputs, vector<bool> &succeeded, vector<int> *statuses = NULL);
+
+	/**
+	 * Fork size() long-lived workers, each serving requests with its own copy of server (as it is now) until
+	 * Stop. False if they could not all be forked, and then none is kept.
+	 */
+	bool Start(Server &server);
+	/**
+	 * Send requests[i] to the i-th worker (there are at most size() of them) and wait for all the replies.
+	 * replies[i] is the reply to requests[i] and succeeded[i] tells whether it came back whole. If a worker
+	 * fails, all of them are stopped.
+	 */
+	void Call(const vector<string> &requests, vector<string> &replies, vector<bool> &succeeded);
+	void Stop();
+
+private:
+	struct Resident {
+		pid_t pid;
+		int requests, replies; // the parent's ends of the worker's pipes
+	};
+
+	unsigned int size_;
+	vector<Resident> servers_;
+};
+
+}
+
+#endif /* WORKERPOOL_H_ */
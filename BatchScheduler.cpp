@@ -0,0 +1,574 @@
+/*
+ * BatchScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#include "BatchScheduler.h"
+#include "IterativeAnalyzer.h"
+#include "CodeHandler.h"
+#include "Analysis/AnalysisConfiguration.h"
+#include "Analysis/WorkerPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+using namespace llvm;
+
+extern llvm::cl::opt<string>  InputFilename;
+extern llvm::cl::opt<string>  InputFilename2;
+extern llvm::cl::list<string> ManagerType;
+extern llvm::cl::list<string> InterleavingLookaheadWindow;
+extern llvm::cl::list<string> SpeculationWorkers;
+extern llvm::cl::list<string> FunctionWorkers;
+extern llvm::cl::list<string> BatchMode;
+extern llvm::cl::list<string> InvariantsFile;
+extern llvm::cl::list<string> WarmStartFile;
+extern llvm::cl::list<string> Manifest;
+extern llvm::cl::list<string> Jobs;
+extern llvm::cl::list<string> JobMemory;
+extern llvm::cl::list<string> JobTimeout;
+extern llvm::cl::list<string> JobRetries;
+extern llvm::cl::list<string> OutputDir;
+extern llvm::cl::list<string> JobPipeline;
+extern llvm::cl::list<string> IgnoredParams;
+
+namespace differential {
+
+namespace {
+
+const int kOutOfMemoryExit = 3; // the exit code of a job that ran out of memory
+const unsigned int kMaxRetries = 3;
+
+typedef llvm::cl::list<string> ClList;
+
+unsigned int ParseUnsigned(ClList &option, unsigned int value) {
+	if (option.size()) {
+		int result = atoi(option[0].c_str());
+		value = result < 0 ? 0 : result;
+	}
+	return value;
+}
+
+void SetOption(ClList &option, const string &value) {
+	option.clear();
+	option.addValue(value);
+}
+
+void SetOption(ClList &option, const vector<string> &values) {
+	option.clear();
+	for (vector<string>::const_iterator iter = values.begin(), end = values.end(); iter != end; ++iter) {
+		option.addValue(*iter);
+	}
+}
+
+// the settings of the retries, cheaper as they go: no speculation, then weaker domains (dual has no speculation)
+string DescribeAttempt(BatchScheduler::JobKind kind, unsigned int attempt) {
+	if (kind == BatchScheduler::KIND_DUAL) {
+		switch (attempt) {
+		case 0: return "as configured";
+		case 1: return "octagons";
+		default: return "boxes";
+		}
+	}
+	switch (attempt) {
+	case 0: return "as configured";
+	case 1: return "k = 1";
+	case 2: return "k = 1, octagons";
+	default: return "k = 1, boxes";
+	}
+}
+
+const char *KindName(BatchScheduler::JobKind kind) {
+	switch (kind) {
+	case BatchScheduler::KIND_DUAL: return "dual";
+	case BatchScheduler::KIND_UNION: return "union";
+	default: return "score";
+	}
+}
+
+const char *StatusName(BatchScheduler::JobStatus status) {
+	switch (status) {
+	case BatchScheduler::JOB_DONE: return "done";
+	case BatchScheduler::JOB_TIMEOUT: return "timeout";
+	case BatchScheduler::JOB_MEMORY: return "memory";
+	default: return "crash";
+	}
+}
+
+BatchScheduler::JobStatus Classify(bool succeeded, int status) {
+	if (succeeded)
+		return BatchScheduler::JOB_DONE;
+	if (status != -1 && WIFSIGNALED(status)) {
+		int signal = WTERMSIG(status);
+		if (signal == SIGALRM || signal == SIGXCPU || signal == SIGKILL)
+			return BatchScheduler::JOB_TIMEOUT;
+	}
+	if (status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == kOutOfMemoryExit)
+		return BatchScheduler::JOB_MEMORY;
+	return BatchScheduler::JOB_CRASH;
+}
+
+// the value of key in a JSON line written by score (a string or a number), empty if it is missing
+string JsonField(const string &line, const string &key) {
+	size_t pos = line.find("\"" + key + "\":");
+	if (pos == string::npos)
+		return "";
+	pos += key.size() + 3;
+	string result;
+	if (pos < line.size() && line[pos] == '"') {
+		for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+			if (line[pos] == '\\' && pos + 1 < line.size()) {
+				++pos;
+				result += line[pos] == 'n' ? '\n' : (line[pos] == 't' ? '\t' : line[pos]);
+			} else {
+				result += line[pos];
+			}
+		}
+	} else {
+		for (; pos < line.size() && line[pos] != ',' && line[pos] != '}'; ++pos)
+			result += line[pos];
+	}
+	return result;
+}
+
+string BaseName(const string &path) {
+	size_t slash = path.rfind('/');
+	return slash == string::npos ? path : path.substr(slash + 1);
+}
+
+bool Exists(const string &path) {
+	struct stat buffer;
+	return stat(path.c_str(), &buffer) == 0 && S_ISREG(buffer.st_mode);
+}
+
+// the .c and .i files of dir, by name
+vector<string> SourceFiles(const string &dir) {
+	vector<string> result;
+	DIR *dir_ptr = opendir(dir.c_str());
+	if (!dir_ptr)
+		return result;
+	while (struct dirent *entry = readdir(dir_ptr)) {
+		string name = entry->d_name;
+		if (name.size() > 2 && (name.substr(name.size() - 2) == ".c" || name.substr(name.size() - 2) == ".i"))
+			result.push_back(name);
+	}
+	closedir(dir_ptr);
+	sort(result.begin(), result.end());
+	return result;
+}
+
+string DirName(const string &path) {
+	size_t slash = path.rfind('/');
+	return slash == string::npos ? "." : path.substr(0, slash);
+}
+
+// a word of a shell command
+string Quote(const string &word) {
+	string result = "'";
+	for (size_t i = 0; i < word.size(); ++i) {
+		if (word[i] == '\'')
+			result += "'\\''";
+		else
+			result += word[i];
+	}
+	return result + "'";
+}
+
+// a pipeline job kills its whole process group (the pipeline's processes with it) when its time is up
+void KillGroup(int) {
+	kill(0, SIGKILL);
+}
+
+void Redirect(int fd, const string &path) {
+	int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return;
+	dup2(file, fd);
+	close(file);
+}
+
+/**
+ * One attempt at analyzing a pair of files. In its worker, the job redirects its output to the logs, limits
+ * its memory and time, and runs score with the settings of the attempt, sending the JSON lines back. A
+ * pipeline job runs dual or union.sh instead (in the pair's directory, as the scripts do), and sends back
+ * one line with the pipeline's exit code.
+ */
+class FileJob : public WorkerPool::Job {
+public:
+	FileJob(const BatchScheduler::FilePair &pair, BatchScheduler::JobKind kind, unsigned int attempt, const string &log, unsigned int memory, unsigned int seconds) :
+		pair_(pair), kind_(kind), attempt_(attempt), log_(log), memory_(memory), seconds_(seconds), isolated_(false) { }
+
+	virtual void Isolate() {
+		isolated_ = true;
+		Redirect(STDOUT_FILENO, log_ + ".out");
+		Redirect(STDERR_FILENO, log_ + ".err");
+		if (kind_ != BatchScheduler::KIND_SCORE) {
+			setpgid(0, 0);
+			signal(SIGALRM, KillGroup);
+		}
+		if (memory_) {
+			struct rlimit limit;
+			limit.rlim_cur = limit.rlim_max = (rlim_t)memory_ << 20;
+			setrlimit(RLIMIT_AS, &limit);
+		}
+		if (seconds_) {
+			// the alarm bounds the wall clock time, the CPU limit is a backstop should the alarm be blocked
+			struct rlimit limit;
+			limit.rlim_cur = seconds_;
+			limit.rlim_max = seconds_ + 1;
+			setrlimit(RLIMIT_CPU, &limit);
+			alarm(seconds_);
+		}
+	}
+
+	virtual void Run(ostream &out) {
+		if (kind_ != BatchScheduler::KIND_SCORE) {
+			RunPipeline(out);
+			return;
+		}
+		// a job that could not be forked runs in-process, and must leave the options as it found them
+		string file = InputFilename, file2 = InputFilename2;
+		vector<string> manager(ManagerType.begin(), ManagerType.end()),
+				window(InterleavingLookaheadWindow.begin(), InterleavingLookaheadWindow.end()),
+				workers(SpeculationWorkers.begin(), SpeculationWorkers.end()),
+				batch(BatchMode.begin(), BatchMode.end()),
+				invariants(InvariantsFile.begin(), InvariantsFile.end()),
+				warm(WarmStartFile.begin(), WarmStartFile.end());
+		InputFilename = pair_.file;
+		InputFilename2 = pair_.file2;
+		SetOption(BatchMode, "1");
+		// the invariants options name directories, with a file per pair
+		if (invariants.size())
+			SetOption(InvariantsFile, invariants[0] + "/" + pair_.name + ".inv");
+		if (warm.size())
+			SetOption(WarmStartFile, warm[0] + "/" + pair_.name + ".inv");
+		if (attempt_ >= 1) {
+			SetOption(InterleavingLookaheadWindow, "1");
+			SetOption(SpeculationWorkers, "1");
+		}
+		if (attempt_ >= 2)
+			SetOption(ManagerType, attempt_ == 2 ? AnalysisConfiguration::kManagerTypeOctagon : AnalysisConfiguration::kManagerTypeBox);
+		try {
+			IterativeAnalyzer analyzer;
+			analyzer.set_results(&out);
+			analyzer.RunAnalysis();
+		} catch (bad_alloc &) {
+			if (!isolated_)
+				throw;
+			_exit(kOutOfMemoryExit);
+		}
+		InputFilename = file;
+		InputFilename2 = file2;
+		SetOption(ManagerType, manager);
+		SetOption(InterleavingLookaheadWindow, window);
+		SetOption(SpeculationWorkers, workers);
+		SetOption(BatchMode, batch);
+		SetOption(InvariantsFile, invariants);
+		SetOption(WarmStartFile, warm);
+	}
+
+private:
+	// the command of Script/dual-dir.sh or union.sh for the pair, with the options scorebatch does not know
+	// first (dual takes the first value of an option, so they override the scripts' defaults after them)
+	void RunPipeline(ostream &out) {
+		stringstream command;
+		command << "cd " << Quote(DirName(pair_.file)) << " && ";
+		if (kind_ == BatchScheduler::KIND_DUAL)
+			command << "dual " << Quote(BaseName(pair_.file)) << " -u=" << Quote(BaseName(pair_.file2));
+		else
+			command << "union.sh " << Quote(BaseName(pair_.file)) << " " << Quote(BaseName(pair_.file2));
+		for (ClList::const_iterator iter = IgnoredParams.begin(), end = IgnoredParams.end(); iter != end; ++iter) {
+			command << ' ' << Quote(*iter);
+		}
+		if (kind_ == BatchScheduler::KIND_DUAL) {
+			if (attempt_ >= 1)
+				command << " -m=" << (attempt_ == 1 ? AnalysisConfiguration::kManagerTypeOctagon : AnalysisConfiguration::kManagerTypeBox);
+			else if (ManagerType.size())
+				command << " -m=" << Quote(ManagerType[0]);
+			// the report is written from the pair's directory
+			string report = log_ + ".report";
+			if (report[0] != '/') {
+				char cwd[4096];
+				if (getcwd(cwd, sizeof(cwd)))
+					report = string(cwd) + "/" + report;
+			}
+			command << " -x0=false -tag_equality=true -clear=true -diff_points=true -ret_guard=true -r=" << Quote(report);
+		}
+		cout << command.str() << endl;
+		int status = system(command.str().c_str());
+		int code = (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+		out << "{\"function\":\"-\",\"kind\":\"" << KindName(kind_) << "\",\"verdict\":\""
+			<< (code == 0 ? "done" : "failed") << "\",\"exit\":" << code << "}\n";
+	}
+
+	BatchScheduler::FilePair pair_;
+	BatchScheduler::JobKind kind_;
+	unsigned int attempt_;
+	string log_; // the path of the logs, without the .out/.err suffix
+	unsigned int memory_, seconds_;
+	bool isolated_;
+};
+
+}
+
+BatchScheduler::BatchScheduler() : kind_(KIND_SCORE), jobs_(1), retries_(2), memory_(0), seconds_(0) { }
+
+int BatchScheduler::Main(int argc, char *argv[]) {
+	CodeHandler::Init(argc,argv);
+	BatchScheduler().RunBatch();
+	return 0;
+}
+
+/**
+ * The pairs to analyze: the manifest's lines (<file> <2nd-file>, # starts a comment), or the files of
+ * the directory given as filename, matched with the 2nd directory's files of the same name, or if there
+ * is no 2nd directory, with patched.<file>. The pipelines take .i files only (as the scripts do), and
+ * pairs of files in the same directory, where they write their intermediate files.
+ */
+bool BatchScheduler::CollectPairs() {
+	pairs_.clear();
+	if (Manifest.size()) {
+		ifstream manifest(Manifest[0].c_str());
+		if (!manifest.is_open()) {
+			errs() << "Cannot read the manifest " << Manifest[0] << '\n';
+			return false;
+		}
+		string line;
+		while (getline(manifest,line)) {
+			if (line.find('#') != string::npos)
+				line = line.substr(0,line.find('#'));
+			stringstream ss(line);
+			FilePair pair;
+			if (!(ss >> pair.file))
+				continue;
+			if (!(ss >> pair.file2)) {
+				errs() << "Warning: no 2nd file for " << pair.file << " in the manifest\n";
+				continue;
+			}
+			pair.name = BaseName(pair.file);
+			pairs_.push_back(pair);
+		}
+	} else if (InputFilename.size()) {
+		string dir = InputFilename, dir2 = InputFilename2;
+		vector<string> files = SourceFiles(dir);
+		for (vector<string>::const_iterator iter = files.begin(), end = files.end(); iter != end; ++iter) {
+			if (kind_ != KIND_SCORE && iter->substr(iter->size() - 2) != ".i")
+				continue;
+			FilePair pair;
+			pair.name = *iter;
+			pair.file = dir + "/" + *iter;
+			if (dir2.size()) {
+				pair.file2 = dir2 + "/" + *iter;
+			} else {
+				if (iter->find("patched") != string::npos || iter->find("guarded") != string::npos || iter->find("union") != string::npos)
+					continue;
+				pair.file2 = dir + "/patched." + *iter;
+			}
+			if (!Exists(pair.file2))
+				continue;
+			pairs_.push_back(pair);
+		}
+	} else {
+		errs() << "Usage: scorebatch <dir> [<2nd-dir>] | -manifest=<file> [score options]\n";
+		return false;
+	}
+	if (kind_ != KIND_SCORE) {
+		vector<FilePair> together;
+		for (vector<FilePair>::const_iterator iter = pairs_.begin(), end = pairs_.end(); iter != end; ++iter) {
+			if (DirName(iter->file) == DirName(iter->file2))
+				together.push_back(*iter);
+			else
+				errs() << "Warning: " << iter->file << " and " << iter->file2 << " are not in the same directory, skipped\n";
+		}
+		pairs_.swap(together);
+	}
+	// names are used for the logs, keep them apart
+	map<string,unsigned int> seen;
+	for (vector<FilePair>::iterator iter = pairs_.begin(), end = pairs_.end(); iter != end; ++iter) {
+		unsigned int count = seen[iter->name]++;
+		if (count) {
+			stringstream ss;
+			ss << iter->name << "." << count;
+			iter->name = ss.str();
+		}
+	}
+	return true;
+}
+
+void BatchScheduler::RunBatch() {
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	outs() << "Batch Configuration:\n";
+	string kind = JobPipeline.size() ? JobPipeline[0] : "score";
+	if (kind == "dual") {
+		kind_ = KIND_DUAL;
+	} else if (kind == "union") {
+		kind_ = KIND_UNION;
+	} else if (kind != "score") {
+		errs() << "Unknown job kind " << kind << ", expected score, dual or union\n";
+		return;
+	}
+	outs() << "Jobs run: " << KindName(kind_) << '\n';
+	jobs_ = ParseUnsigned(Jobs, cpus > 0 ? cpus : 1);
+	if (jobs_ == 0)
+		jobs_ = 1;
+	outs() << "Jobs: " << jobs_ << '\n';
+	memory_ = ParseUnsigned(JobMemory, 0);
+	outs() << "Memory limit per job: ";
+	if (memory_)
+		outs() << memory_ << " MB\n";
+	else
+		outs() << "none\n";
+	seconds_ = ParseUnsigned(JobTimeout, 0);
+	outs() << "Time limit per job: ";
+	if (seconds_)
+		outs() << seconds_ << " seconds\n";
+	else
+		outs() << "none\n";
+	retries_ = min(ParseUnsigned(JobRetries, 2), kMaxRetries);
+	if (kind_ == KIND_UNION) // it does not analyze, there is nothing cheaper to retry with
+		retries_ = 0;
+	outs() << "Retries: " << retries_ << '\n';
+	out_dir_ = OutputDir.size() ? OutputDir[0] : "Results";
+	outs() << "Output directory: " << out_dir_ << '\n';
+	AnalysisConfiguration::PrintConfigurationFooter();
+	// several jobs already run at once, and a forked job must not fork in turn from threads
+	SetOption(FunctionWorkers, "1");
+
+	if (!CollectPairs())
+		return;
+	if (pairs_.empty()) {
+		errs() << "No pairs of files to analyze\n";
+		return;
+	}
+	if (mkdir(out_dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+		perror(out_dir_.c_str());
+		return;
+	}
+
+	status_.assign(pairs_.size(), JOB_CRASH);
+	attempt_.assign(pairs_.size(), 0);
+	results_.assign(pairs_.size(), "");
+	vector<unsigned int> pending;
+	for (unsigned int i = 0; i < pairs_.size(); ++i)
+		pending.push_back(i);
+	WorkerPool pool(jobs_);
+	for (unsigned int attempt = 0; attempt <= retries_ && !pending.empty(); ++attempt) {
+		outs() << "Attempt " << attempt + 1 << " (" << DescribeAttempt(kind_, attempt) << "): " << pending.size() << " jobs\n";
+		outs().flush();
+		vector<FileJob> file_jobs;
+		for (vector<unsigned int>::const_iterator iter = pending.begin(), end = pending.end(); iter != end; ++iter) {
+			stringstream log;
+			log << out_dir_ << "/" << pairs_[*iter].name;
+			if (attempt)
+				log << "." << attempt;
+			file_jobs.push_back(FileJob(pairs_[*iter], kind_, attempt, log.str(), memory_, seconds_));
+		}
+		vector<WorkerPool::Job*> jobs;
+		for (unsigned int i = 0; i < file_jobs.size(); ++i)
+			jobs.push_back(&file_jobs[i]);
+		vector<string> outputs;
+		vector<bool> succeeded;
+		vector<int> statuses;
+		pool.Run(jobs, outputs, succeeded, &statuses);
+
+		vector<unsigned int> failed;
+		for (unsigned int i = 0; i < pending.size(); ++i) {
+			unsigned int index = pending[i];
+			status_[index] = Classify(succeeded[i], statuses[i]);
+			if (status_[index] == JOB_DONE && kind_ != KIND_SCORE && JsonField(outputs[i],"exit") != "0")
+				status_[index] = JOB_CRASH;
+			attempt_[index] = attempt;
+			results_[index] = outputs[i];
+			outs() << pairs_[index].name << ": " << StatusName(status_[index]) << '\n';
+			if (status_[index] != JOB_DONE)
+				failed.push_back(index);
+		}
+		pending.swap(failed);
+	}
+	WriteTable();
+	if (kind_ == KIND_DUAL)
+		WriteReport();
+}
+
+/**
+ * The merged results: results.jsonl has the JSON lines of all the jobs, and results.tsv one row per
+ * function (or one per job that never completed), with the attempt that produced it.
+ */
+void BatchScheduler::WriteTable() {
+	string table_file = out_dir_ + "/results.tsv", json_file = out_dir_ + "/results.jsonl";
+	ofstream table(table_file.c_str()), json(json_file.c_str());
+	table << "file\tfile2\tfunction\tverdict\tseconds\tsteps\tpeak_disjuncts\tattempt\n";
+	map<string,unsigned int> verdicts;
+	for (unsigned int i = 0; i < pairs_.size(); ++i) {
+		if (status_[i] != JOB_DONE) {
+			table << pairs_[i].file << '\t' << pairs_[i].file2 << "\t-\t" << StatusName(status_[i]) << "\t-\t-\t-\t" << attempt_[i] + 1 << '\n';
+			verdicts[StatusName(status_[i])]++;
+			continue;
+		}
+		stringstream lines(results_[i]);
+		string line;
+		while (getline(lines,line)) {
+			if (line.empty())
+				continue;
+			json << line << '\n';
+			string verdict = JsonField(line,"verdict");
+			table << pairs_[i].file << '\t' << pairs_[i].file2 << '\t' << JsonField(line,"function") << '\t' << verdict << '\t'
+				  << JsonField(line,"seconds") << '\t' << JsonField(line,"steps") << '\t' << JsonField(line,"peak_disjuncts") << '\t'
+				  << attempt_[i] + 1 << '\n';
+			verdicts[verdict]++;
+		}
+	}
+	outs() << "Results: " << table_file << ", " << json_file << '\n';
+	for (map<string,unsigned int>::const_iterator iter = verdicts.begin(), end = verdicts.end(); iter != end; ++iter) {
+		outs() << "  " << iter->first << ": " << iter->second << '\n';
+	}
+}
+
+/**
+ * Every dual job wrote its report (a header and its row) next to its logs, as dual does with -r: the rows
+ * of the last attempt at each pair are merged under one header in Report.log.
+ */
+void BatchScheduler::WriteReport() {
+	string report_file = out_dir_ + "/Report.log";
+	ofstream report(report_file.c_str());
+	bool header = false;
+	for (unsigned int i = 0; i < pairs_.size(); ++i) {
+		stringstream log;
+		log << out_dir_ << "/" << pairs_[i].name;
+		if (attempt_[i])
+			log << "." << attempt_[i];
+		ifstream rows((log.str() + ".report").c_str());
+		string line;
+		for (bool first = true; getline(rows,line); first = false) {
+			if (first && header)
+				continue;
+			report << line << '\n';
+			header = true;
+		}
+	}
+	outs() << "Report: " << report_file << '\n';
+}
+
+}
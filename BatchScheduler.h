@@ -0,0 +1,65 @@
+/*
+ * BatchScheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: user
+ */
+
+#ifndef BATCHSCHEDULER_H_
+#define BATCHSCHEDULER_H_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace differential {
+
+/**
+ * Runs score over many pairs of files: the .c/.i files of a directory matched with their patched.<file>
+ * (as Script/dual-dir.sh does), the files of two directories matched by name, or the pairs listed in a
+ * manifest. Every file pair is a job of a WorkerPool, so it is analyzed in a forked process of its own
+ * (apron and the abstract dictionary are process-global), under a memory and a time limit. A job that
+ * fails is retried with cheaper settings, and the per-function results of all jobs are merged into one
+ * table (and one JSON lines file) in the output directory.
+ * The jobs may run the pipelines of Script/dual-dir.sh (dual) or Script/union-dir.sh (union.sh) instead,
+ * over the .i files of a directory, one table row per pair.
+ */
+class BatchScheduler {
+public:
+	struct FilePair {
+		string name; // for the logs and the table
+		string file, file2;
+	};
+
+	// how a job ended
+	typedef enum { JOB_DONE, JOB_TIMEOUT, JOB_MEMORY, JOB_CRASH } JobStatus;
+	// what a job runs: score in-process, or the dual or union.sh pipeline
+	typedef enum { KIND_SCORE, KIND_DUAL, KIND_UNION } JobKind;
+
+	BatchScheduler();
+	virtual ~BatchScheduler() { }
+
+	void RunBatch();
+	static int Main(int argc, char *argv[]);
+
+private:
+	bool CollectPairs();
+	void WriteTable();
+	void WriteReport(); // the dual jobs' report rows, in one Report.log
+
+	vector<FilePair> pairs_;
+	JobKind kind_;
+	string out_dir_;
+	unsigned int jobs_, retries_;
+	unsigned int memory_; // MB per job, 0 for unlimited
+	unsigned int seconds_; // per job, 0 for unlimited
+
+	// the outcome of the last attempt at each pair
+	vector<JobStatus> status_;
+	vector<unsigned int> attempt_;
+	vector<string> results_; // JSON lines, one per function
+};
+
+}
+
+#endif /* BATCHSCHEDULER_H_ */
@@ -0,0 +1,54 @@
+#include "BatchScheduler.h"
+#include "Analysis/AnalysisConfiguration.h"
+
+#include <string>
+using std::string;
+
+#include <llvm/Support/CommandLine.h>
+
+// These must be declared here (in the outermost main file) otherwise we have duplicates:
+llvm::cl::list<string> IgnoredParams(llvm::cl::Sink);
+llvm::cl::list<string> DefinedMacros("D", llvm::cl::value_desc("macro"), llvm::cl::Prefix, llvm::cl::desc("Predefine the specified macro"));
+llvm::cl::list<string> IncludeDirs("I", llvm::cl::value_desc("directory"), llvm::cl::Prefix, llvm::cl::desc("Add directory to include search path"));
+llvm::cl::opt<string>  InputFilename(llvm::cl::Positional, llvm::cl::desc("directory"), llvm::cl::Optional);
+llvm::cl::opt<string>  InputFilename2(llvm::cl::Positional, llvm::cl::desc("2nd-directory"), llvm::cl::Optional);
+llvm::cl::list<string> ManagerType("m",llvm::cl::value_desc(differential::AnalysisConfiguration::kManagerTypes),llvm::cl::desc("Type of constraint manager for apron"));
+llvm::cl::list<string> PartitionPoint("p_p",llvm::cl::value_desc(differential::AnalysisConfiguration::kPartitionPoints),llvm::cl::desc("Partition point"));
+llvm::cl::list<string> PartitionStrategy("p_s",llvm::cl::value_desc(differential::AnalysisConfiguration::kPartitionStrategies),llvm::cl::desc("Partition strategy"));
+llvm::cl::list<string> WideningPoint("w_p",llvm::cl::value_desc(differential::AnalysisConfiguration::kWideningPoints),llvm::cl::desc("Widening point"));
+llvm::cl::list<string> WideningStrategy("w_s",llvm::cl::value_desc(differential::AnalysisConfiguration::kWideningStrategies),llvm::cl::desc("Widening strategies"));
+llvm::cl::list<string> WideningThreshold("w_t",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Widening threshold"));
+llvm::cl::list<string> InterleavingLookaheadWindow("k",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative lookahead window size"));
+llvm::cl::list<string> InterleavingLookaheadPartition("p",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative partition interval"));
+llvm::cl::list<string> SpeculationCommit("c",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative steps committed per window; the snapshots below the committed steps are reused by the next window, so a value under -k is needed for any reuse (default: the whole window, no reuse)"));
+llvm::cl::list<string> Acceleration("accel",llvm::cl::value_desc("0|1"),llvm::cl::desc("Summarize loops that add constants to variables in closed form instead of widening (default: 0)"));
+llvm::cl::list<string> Band("band",llvm::cl::value_desc("blocks"),llvm::cl::desc("Prefer the interleavings that keep within this many blocks of the alignment of the CFGs' block texts (default: 0, any)"));
+llvm::cl::list<string> Align("align",llvm::cl::value_desc("0|1"),llvm::cl::desc("Step through the blocks that the alignment of the CFGs' block texts matches without speculating, and speculate only around the others (default: 0)"));
+llvm::cl::list<string> TransferCacheSize("t_cache",llvm::cl::value_desc("entries"),llvm::cl::desc("Block transfers remembered per disjunct (default: 4096, 0 for none)"));
+llvm::cl::list<string> Summaries("summ",llvm::cl::value_desc("0|1"),llvm::cl::desc("Relate the return values of calls to matched functions by their differential summaries (default: 0)"));
+llvm::cl::list<string> SpeculationPOR("s_por",llvm::cl::value_desc("0|1"),llvm::cl::desc("Speculate over all interleavings, up to the order of commuting steps"));
+llvm::cl::list<string> SpeculationWorkers("s_w",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Number of worker processes speculating in parallel"));
+llvm::cl::list<string> BatchMode("batch",llvm::cl::value_desc("0|1"),llvm::cl::desc("Run unattended: no pauses, no progress output"));
+llvm::cl::list<string> FunctionTimeBudget("t_f",llvm::cl::value_desc("seconds"),llvm::cl::desc("Time budget per function (default: none)"));
+llvm::cl::list<string> FunctionStepBudget("s_f",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Step budget per function (default: none)"));
+llvm::cl::list<string> FunctionDisjunctBudget("d_f",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Disjuncts a state may have before the analysis degrades (default: no limit)"));
+llvm::cl::list<string> ResultsFile("json",llvm::cl::value_desc("filename"),llvm::cl::desc("Append per-function results to this file as JSON lines (batch default: <filename>.jsonl)"));
+llvm::cl::list<string> FunctionWorkers("f_w",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Number of threads analyzing functions in parallel, with the box, oct or polka domains (default: 1)"));
+llvm::cl::list<string> CacheDirectory("cache",llvm::cl::value_desc("directory"),llvm::cl::desc("Reuse the results of unchanged functions, kept in this directory across runs"));
+llvm::cl::list<string> CacheSize("cache_mb",llvm::cl::value_desc("MB"),llvm::cl::desc("Size of the result cache (default: 256, 0 for unbounded)"));
+llvm::cl::list<string> InvariantsFile("invariants",llvm::cl::value_desc("directory"),llvm::cl::desc("Write the states at the loop heads of each pair to <name>.inv in this directory"));
+llvm::cl::list<string> WarmStartFile("warm",llvm::cl::value_desc("directory"),llvm::cl::desc("Start the loop heads of each pair from the states in <name>.inv in this directory, once validated"));
+
+// Batch Flags:
+llvm::cl::list<string> Manifest("manifest",llvm::cl::value_desc("filename"),llvm::cl::desc("Analyze the pairs of files listed in this file, one pair per line"));
+llvm::cl::list<string> Jobs("j",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Number of files analyzed at once (default: the number of processors)"));
+llvm::cl::list<string> JobMemory("mem",llvm::cl::value_desc("MB"),llvm::cl::desc("Memory limit per file (default: none)"));
+llvm::cl::list<string> JobTimeout("t_j",llvm::cl::value_desc("seconds"),llvm::cl::desc("Time limit per file (default: none)"));
+llvm::cl::list<string> JobRetries("retries",llvm::cl::value_desc("0-3"),llvm::cl::desc("Retries of a failed file, with cheaper settings each time (default: 2)"));
+llvm::cl::list<string> JobPipeline("kind",llvm::cl::value_desc("score|dual|union"),llvm::cl::desc("Run score on each pair, or the pipeline of Script/dual-dir.sh or Script/union-dir.sh, passing them the options scorebatch does not know (default: score)"));
+llvm::cl::list<string> OutputDir("out",llvm::cl::value_desc("directory"),llvm::cl::desc("Directory of the logs and the merged results (default: Results)"));
+
+int main(int argc, char* argv[])
+{
+    return differential::BatchScheduler::Main(argc,argv);
+}
@@ -15,12 +15,16 @@ llvm::cl::opt<string>  InputFilename(llvm::cl::Positional, llvm::cl::desc("filen
 llvm::cl::list<string> GuardFilename("g", llvm::cl::value_desc("to-be-guarded filename"), llvm::cl::desc("Transform program to guarded instructions mode"));
 llvm::cl::list<string> GuardTaggedFilename("g_t", llvm::cl::value_desc("to-be-guarded-before-tagging file"), llvm::cl::desc("Transform to-be-tagged program to guarded instructions mode"));
 llvm::cl::list<string> TagFilename("t", llvm::cl::value_desc("to-be-tagged filename"), llvm::cl::desc("Tag all variables in input code"));
+llvm::cl::list<string> TagWith("t_with", llvm::cl::value_desc("other version filename"), llvm::cl::desc("Tag only the variables the changes from this version can reach (sparse tagging)"));
 llvm::cl::list<string> InlineFilename("i", llvm::cl::value_desc("input file"), llvm::cl::desc("Inline all functions in input code"));
 llvm::cl::list<string> PatchedFilename("u", llvm::cl::value_desc("pathced-guarded-tagged filename"), llvm::cl::desc("Union the program with this patched version of it"));
+llvm::cl::list<string> SliceFilename("s", llvm::cl::value_desc("to-be-sliced filename"), llvm::cl::desc("Remove the statements that cannot affect a difference from the version given with -s_with (both are sliced)"));
+llvm::cl::list<string> SliceWith("s_with", llvm::cl::value_desc("other version filename"), llvm::cl::desc("The version to diff against when slicing"));
 
 llvm::cl::list<string> Clear("clear", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("Clear function body in case no diff is found between it and the patched version"));
 llvm::cl::list<string> X0("x0", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("preserve initial values (i.e. x=x0,x'=x0' etc)"));
 llvm::cl::list<string> TagEquality("tag_equality", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("make the tag variables equal to the untagged ones in the union program"));
+llvm::cl::list<string> SparseTags("sparse_tags", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("the patched version was tagged with -t_with: emit the lines it left untagged once, for both versions."));
 llvm::cl::list<string> DiffPoints("diff_points", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("create diff points in the union program."));
 llvm::cl::list<string> AddAsserts("asserts", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("add an assertion for tagged-untagged variable equality after each diff-point."));
 llvm::cl::list<string> RetGuard("ret_guard", llvm::cl::value_desc("flag"), llvm::cl::Prefix,llvm::cl::desc("substitute return calls (i.e. return x; --> { Ret = true; RetVal = x; }"));
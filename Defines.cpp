@@ -30,11 +30,14 @@ const string Defines::kRetGuard = "Ret";
 const string Defines::kRetVal = "RetVal";
 const string Defines::kAssertPrefix = "//assert";
 const string Defines::kTempPrefix = "Temp_";
+const string Defines::kSlicedPrefix = "Sliced_";
+const string Defines::kSparseTagsMarker = "/* tagged with -t_with, union with -sparse_tags=true */\n";
 const string Defines::kPatchedFilenamePrefix = "patched.";
 const string Defines::kGuardedFilenamePrefix = "guarded.";
 const string Defines::kTaggedFilenamePrefix = "tagged.";
 const string Defines::kUnionedFilenamePrefix = "union.";
 const string Defines::kInlinedFilenamePrefix = "inlined.";
+const string Defines::kSlicedFilenamePrefix = "sliced.";
 const string Defines::kResultsFilenamePrefix = "results.";
 const string Defines::kTypedefsFilenamePrefix = "typedefs.";
 }
@@ -47,12 +47,16 @@ static const string kRetVal;
 static const string kAssertPrefix;
 
 static const string kTempPrefix;
+static const string kSlicedPrefix;
+
+static const string kSparseTagsMarker;
 
 static const string kPatchedFilenamePrefix;
 static const string kGuardedFilenamePrefix;
 static const string kTaggedFilenamePrefix;
 static const string kUnionedFilenamePrefix;
 static const string kInlinedFilenamePrefix;
+static const string kSlicedFilenamePrefix;
 static const string kResultsFilenamePrefix;
 static const string kTypedefsFilenamePrefix;
 };
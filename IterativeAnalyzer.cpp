@@ -12,18 +12,28 @@ using namespace apron;
 #include "Analysis/APAbstractDomain.h"
 #include "Analysis/IterativeSolver.h"
 #include "Analysis/AnalysisConfiguration.h"
+#include "Analysis/FunctionSummaries.h"
+#include "Analysis/ResultCache.h"
+#include "Analysis/Serialization.h"
 
 #include "DTL/dtl.hpp"
 #include "DTL/variables.hpp"
 using namespace dtl;
 
+#include <cassert>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <fstream>
 #include <string>
 #include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
 using namespace std;
 
+#include <pthread.h>
+
 #define DEBUG 0
 
 extern llvm::cl::opt<string>  InputFilename;
@@ -40,17 +50,477 @@ extern llvm::cl::list<string> WideningThreshold;
 extern llvm::cl::list<string> Interleaving;
 extern llvm::cl::list<string> InterleavingLookaheadWindow;
 extern llvm::cl::list<string> InterleavingLookaheadPartition;
+extern llvm::cl::list<string> SpeculationCommit;
+extern llvm::cl::list<string> SpeculationPOR;
+extern llvm::cl::list<string> Acceleration;
+extern llvm::cl::list<string> Band;
+extern llvm::cl::list<string> Align;
+extern llvm::cl::list<string> Summaries;
+extern llvm::cl::list<string> TransferCacheSize;
+extern llvm::cl::list<string> SpeculationWorkers;
+extern llvm::cl::list<string> BatchMode;
+extern llvm::cl::list<string> FunctionTimeBudget;
+extern llvm::cl::list<string> FunctionStepBudget;
+extern llvm::cl::list<string> FunctionDisjunctBudget;
+extern llvm::cl::list<string> ResultsFile;
+extern llvm::cl::list<string> FunctionWorkers;
+extern llvm::cl::list<string> CacheDirectory;
+extern llvm::cl::list<string> CacheSize;
+extern llvm::cl::list<string> InvariantsFile;
+extern llvm::cl::list<string> WarmStartFile;
 extern llvm::cl::list<string> ProveEquiv;
 
 namespace differential {
 
+namespace {
+
+string JsonString(const string &s) {
+	stringstream ss;
+	ss << '"';
+	for (string::const_iterator iter = s.begin(), end = s.end(); iter != end; ++iter) {
+		switch (*iter) {
+		case '"': ss << "\\\""; break;
+		case '\\': ss << "\\\\"; break;
+		case '\n': ss << "\\n"; break;
+		case '\t': ss << "\\t"; break;
+		case '\r': ss << "\\r"; break;
+		default:
+			if ((unsigned char)*iter < 0x20)
+				ss << "\\u" << hex << setw(4) << setfill('0') << (int)(unsigned char)*iter << dec << setfill(' ');
+			else
+				ss << *iter;
+		}
+	}
+	ss << '"';
+	return ss.str();
+}
+
+// one line per function
+void WriteResult(ostream &os, const string &function, const IterativeSolver::Result &result) {
+	os << "{\"file\":" << JsonString(InputFilename) << ",\"file2\":" << JsonString(InputFilename2)
+	   << ",\"function\":" << JsonString(function) << ",\"verdict\":" << JsonString(result.verdict)
+	   << ",\"exit_delta\":" << JsonString(result.exit_delta) << ",\"deltas\":[";
+	for (unsigned int i = 0; i < result.deltas.size(); ++i) {
+		const IterativeSolver::CFGBlockPair &pcs = result.deltas[i].first;
+		os << (i ? "," : "") << "{\"blocks\":[" << pcs.first->getBlockID() << "," << pcs.second->getBlockID()
+		   << "],\"delta\":" << JsonString(result.deltas[i].second) << "}";
+	}
+	os << "],\"seconds\":" << fixed << setprecision(3) << result.seconds << ",\"steps\":" << result.steps
+	   << ",\"peak_disjuncts\":" << result.peak_disjuncts << ",\"degradations\":[";
+	for (unsigned int i = 0; i < result.degradations.size(); ++i) {
+		os << (i ? "," : "") << JsonString(result.degradations[i]);
+	}
+	os << "],\"cached\":" << (result.cached ? "true" : "false") << ",\"warm_start\":" << JsonString(result.warm_start)
+	   << ",\"transfer_hits\":" << result.transfer_hits << ",\"transfer_misses\":" << result.transfer_misses << "}" << endl;
+}
+
+// block pairs are cached by their ids
+void WriteCachedPairs(ostream &os, const vector< pair<IterativeSolver::CFGBlockPair,string> > &pairs) {
+	os << ' ' << pairs.size();
+	for (unsigned int i = 0; i < pairs.size(); ++i) {
+		os << ' ' << pairs[i].first.first->getBlockID() << ' ' << pairs[i].first.second->getBlockID();
+		Serialization::WriteName(os,pairs[i].second);
+	}
+	os << '\n';
+}
+
+bool ReadCachedPairs(istream &is, const CFG &cfg, const CFG &cfg2, vector< pair<IterativeSolver::CFGBlockPair,string> > &pairs) {
+	vector<const CFGBlock*> blocks(cfg.getNumBlockIDs(),NULL), blocks2(cfg2.getNumBlockIDs(),NULL);
+	for (CFG::const_iterator iter = cfg.begin(), end = cfg.end(); iter != end; ++iter)
+		blocks[(*iter)->getBlockID()] = *iter;
+	for (CFG::const_iterator iter = cfg2.begin(), end = cfg2.end(); iter != end; ++iter)
+		blocks2[(*iter)->getBlockID()] = *iter;
+	size_t size = 0;
+	is >> size;
+	for (size_t i = 0; i < size && is; ++i) {
+		unsigned int id = 0, id2 = 0;
+		is >> id >> id2;
+		string text = Serialization::ReadName(is);
+		if (!is || id >= blocks.size() || id2 >= blocks2.size() || !blocks[id] || !blocks2[id2])
+			return false;
+		pairs.push_back(make_pair(IterativeSolver::CFGBlockPair(blocks[id],blocks2[id2]),text));
+	}
+	return !is.fail();
+}
+
+/**
+ * A cache entry: the verdict, the deltas and the states at the correlation points (the exit and the pairs
+ * of blocks calling printf), and what the run took.
+ */
+string WriteCachedResult(const IterativeSolver::Result &result) {
+	stringstream ss;
+	ss << "result";
+	Serialization::WriteName(ss,result.verdict);
+	Serialization::WriteName(ss,result.exit_delta);
+	Serialization::WriteName(ss,result.warm_start);
+	ss << ' ' << result.steps << ' ' << setprecision(17) << result.seconds << ' ' << result.peak_disjuncts << ' '
+	   << result.transfer_hits << ' ' << result.transfer_misses << ' ' << result.degradations.size();
+	for (unsigned int i = 0; i < result.degradations.size(); ++i)
+		Serialization::WriteName(ss,result.degradations[i]);
+	ss << '\n';
+	WriteCachedPairs(ss,result.deltas);
+	WriteCachedPairs(ss,result.states);
+	return ss.str();
+}
+
+bool ReadCachedResult(const string &text, const CFG &cfg, const CFG &cfg2, IterativeSolver::Result &result) {
+	stringstream ss(text);
+	if (!Serialization::Expect(ss,"result"))
+		return false;
+	result.verdict = Serialization::ReadName(ss);
+	result.exit_delta = Serialization::ReadName(ss);
+	result.warm_start = Serialization::ReadName(ss);
+	size_t degradations = 0;
+	ss >> result.steps >> result.seconds >> result.peak_disjuncts >> result.transfer_hits >> result.transfer_misses >> degradations;
+	for (size_t i = 0; i < degradations && ss; ++i)
+		result.degradations.push_back(Serialization::ReadName(ss));
+	if (!ss || !ReadCachedPairs(ss,cfg,cfg2,result.deltas) || !ReadCachedPairs(ss,cfg,cfg2,result.states))
+		return false;
+	result.cached = true;
+	return true;
+}
+
+// a block is recognized across versions by its statements and terminator as clang prints them, and its
+// occurrence among the blocks (of its CFG) that print the same
+typedef pair<string,unsigned int> BlockText;
+
+void BlockTexts(const CFG &cfg, ASTContext &context, vector<BlockText> &result) {
+	result.assign(cfg.getNumBlockIDs(),BlockText());
+	map<string,unsigned int> occurrences;
+	for (CFG::const_iterator iter = cfg.begin(), end = cfg.end(); iter != end; ++iter) {
+		string text;
+		raw_string_ostream ros(text);
+		for (CFGBlock::const_iterator stmt_iter = (*iter)->begin(), stmt_end = (*iter)->end(); stmt_iter != stmt_end; ++stmt_iter) {
+			CFGElement e = *stmt_iter;
+			if (const CFGStmt *statement = e.getAs<CFGStmt>()) {
+				statement->getStmt()->printPretty(ros,context,0,PrintingPolicy(context.getLangOptions()));
+				ros << ";\n";
+			}
+		}
+		(*iter)->printTerminator(ros,context.getLangOptions());
+		const string &printed = ros.str();
+		result[(*iter)->getBlockID()] = BlockText(printed,occurrences[printed]++);
+	}
+}
+
+// the states of a run, by function, as candidate invariants for a later one
+struct Invariant {
+	BlockText block, block2;
+	string state;
+};
+typedef map< string,vector<Invariant> > Invariants;
+
+// a pair of matched functions, with their CFGs (built up front, CFG construction is not thread safe)
+struct FunctionPair {
+	string name;
+	const FunctionDecl *fd, *fd2;
+	CFG *cfg_ptr, *cfg2_ptr;
+	unsigned long size; // of the product CFG
+	string key; // of its result in the cache
+	vector<BlockText> texts, texts2; // by block id, when invariants are written or read
+	vector< pair<IterativeSolver::CFGBlockPair,string> > warm_start; // the earlier run's states mapped onto the CFGs
+};
+
+void WriteInvariants(ostream &os, const FunctionPair &pair, const IterativeSolver::Result &result) {
+	os << "function";
+	Serialization::WriteName(os,pair.name);
+	os << ' ' << result.states.size() << '\n';
+	for (vector< std::pair<IterativeSolver::CFGBlockPair,string> >::const_iterator iter = result.states.begin(), end = result.states.end(); iter != end; ++iter) {
+		const BlockText &text = pair.texts[iter->first.first->getBlockID()], &text2 = pair.texts2[iter->first.second->getBlockID()];
+		Serialization::WriteName(os,text.first);
+		os << ' ' << text.second;
+		Serialization::WriteName(os,text2.first);
+		os << ' ' << text2.second;
+		Serialization::WriteName(os,iter->second);
+		os << '\n';
+	}
+	os.flush();
+}
+
+bool ReadInvariants(const string &filename, Invariants &invariants) {
+	ifstream is(filename.c_str());
+	if (!is.is_open())
+		return false;
+	string function;
+	size_t size = 0;
+	while (Serialization::Expect(is,"function")) {
+		function = Serialization::ReadName(is);
+		is >> size;
+		vector<Invariant> &states = invariants[function];
+		states.clear();
+		for (size_t i = 0; i < size && is; ++i) {
+			Invariant invariant;
+			invariant.block.first = Serialization::ReadName(is);
+			is >> invariant.block.second;
+			invariant.block2.first = Serialization::ReadName(is);
+			is >> invariant.block2.second;
+			invariant.state = Serialization::ReadName(is);
+			states.push_back(invariant);
+		}
+		if (!is)
+			return false;
+	}
+	return is.eof();
+}
+
+// the earlier states whose blocks both have a match in the pair's CFGs
+void MapInvariants(const vector<Invariant> &invariants, FunctionPair &pair) {
+	map<BlockText,const CFGBlock*> blocks, blocks2;
+	for (CFG::const_iterator iter = pair.cfg_ptr->begin(), end = pair.cfg_ptr->end(); iter != end; ++iter)
+		blocks[pair.texts[(*iter)->getBlockID()]] = *iter;
+	for (CFG::const_iterator iter = pair.cfg2_ptr->begin(), end = pair.cfg2_ptr->end(); iter != end; ++iter)
+		blocks2[pair.texts2[(*iter)->getBlockID()]] = *iter;
+	for (vector<Invariant>::const_iterator iter = invariants.begin(), end = invariants.end(); iter != end; ++iter) {
+		map<BlockText,const CFGBlock*>::const_iterator block = blocks.find(iter->block), block2 = blocks2.find(iter->block2);
+		if (block != blocks.end() && block2 != blocks2.end())
+			pair.warm_start.push_back(make_pair(IterativeSolver::CFGBlockPair(block->second,block2->second),iter->state));
+	}
+}
+
+bool LargerFirst(const FunctionPair &a, const FunctionPair &b) {
+	return a.size > b.size;
+}
+
+// the functions left to analyze and the settings they are analyzed with, shared by the function workers
+struct FunctionQueue {
+	vector<FunctionPair> pairs;
+	unsigned int next; // the next pair to analyze
+	pthread_mutex_t mutex; // guards next and the output
+	int k, p, c, workers, threads;
+	bool por, accelerate, align;
+	unsigned seconds, steps, disjuncts, transfer_cache, band;
+	ASTContext *context_ptr;
+	CodeHandler *code;
+	ostream *results; // NULL if the results are not written
+	ResultCache *cache;
+	ostream *invariants; // NULL if the states are not written
+	const FunctionSummaries *summaries; // NULL if calls are opaque
+};
+
+IterativeSolver::Result AnalyzeFunction(FunctionQueue &queue, const FunctionPair &pair, DiagnosticsEngine &diagnostics) {
+	string cached;
+	IterativeSolver::Result result;
+	if (queue.cache->Lookup(pair.key,cached) && ReadCachedResult(cached,*pair.cfg_ptr,*pair.cfg2_ptr,result))
+		return result;
+	// this codes sets up the observer to use the first cfg
+	// an observer is what we used to report the results
+	// this could be defined using the second cfg as well
+	APAbstractDomain domain(*pair.cfg_ptr);
+	domain.InitializeValues(*pair.cfg_ptr);
+	APChecker Observer(*queue.context_ptr,diagnostics,queue.code->getPreprocessor());
+	domain.getAnalysisData().Observer = &Observer;
+	domain.getAnalysisData().setContext(*queue.context_ptr);
+	IterativeSolver is(domain,queue.k,queue.p,queue.c,queue.por,queue.workers);
+	is.time_budget_ = queue.seconds;
+	is.step_budget_ = queue.steps;
+	is.disjunct_budget_ = queue.disjuncts;
+	is.accelerate_ = queue.accelerate;
+	is.band_ = queue.band;
+	is.align_ = queue.align;
+	is.transfer_cache_size_ = queue.transfer_cache;
+	is.transformer_.summaries_ = queue.summaries;
+	if (pair.warm_start.size())
+		is.warm_start_ = &pair.warm_start;
+	is.AssumeInputEquivalence(pair.fd,pair.fd2);
+	result = is.RunOnCFGs(pair.cfg_ptr,pair.cfg2_ptr);
+	if (queue.cache->enabled() && result.verdict != "unknown") { // where a run stops depends on the machine
+		string entry = WriteCachedResult(result);
+		pthread_mutex_lock(&queue.mutex); // the workers share the temporary file names and the eviction
+		queue.cache->Store(pair.key,entry);
+		pthread_mutex_unlock(&queue.mutex);
+	}
+	return result;
+}
+
+// the functions called in stmt, by name
+void Callees(const Stmt *stmt, set<string> &callees) {
+	if (!stmt)
+		return;
+	if (const CallExpr *call = dyn_cast<CallExpr>(stmt)) {
+		if (const FunctionDecl *callee = call->getDirectCallee())
+			callees.insert(callee->getNameAsString());
+	}
+	for (Stmt::child_iterator iter = const_cast<Stmt*>(stmt)->child_begin(), end = const_cast<Stmt*>(stmt)->child_end(); iter != end; ++iter) {
+		Callees(*iter,callees);
+	}
+}
+
+// only the functions over integers are summarized (see FunctionSummaries)
+bool Summarizable(const FunctionDecl *fd, const FunctionDecl *fd2) {
+	if (!fd->isThisDeclarationADefinition() || !fd2->isThisDeclarationADefinition() || fd->getNumParams() != fd2->getNumParams())
+		return false;
+	if (!fd->getResultType()->isIntegerType() || !fd2->getResultType()->isIntegerType())
+		return false;
+	for (unsigned int i = 0; i < fd->getNumParams(); ++i) {
+		const ParmVarDecl *param = fd->getParamDecl(i), *param2 = fd2->getParamDecl(i);
+		if (param->getNameAsString() != param2->getNameAsString() || !param->getType()->isIntegerType() || !param2->getType()->isIntegerType())
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Summarizes the matched functions called by the matched functions, callees first so that the summaries of
+ * their own calls apply. On a cycle of calls, the call closing the cycle stays opaque.
+ * Runs in the calling thread's context, with the queue's settings.
+ */
+class Summarizer {
+public:
+	Summarizer(const map<string,const FunctionDecl*> &functions, const map<string,const FunctionDecl*> &functions2,
+			AnalysisContextManager &context_manager, const FunctionQueue &queue, FunctionSummaries &summaries) :
+		functions_(functions), functions2_(functions2), context_manager_(context_manager), queue_(queue), summaries_(summaries) { }
+
+	void SummarizeCallees(const FunctionDecl *fd, const FunctionDecl *fd2) {
+		set<string> callees;
+		Callees(fd->getBody(),callees);
+		Callees(fd2->getBody(),callees);
+		for (set<string>::const_iterator iter = callees.begin(), end = callees.end(); iter != end; ++iter) {
+			Summarize(*iter);
+		}
+	}
+
+private:
+	void Summarize(const string &name) {
+		if (!visited_.insert(name).second)
+			return;
+		map<string,const FunctionDecl*>::const_iterator function = functions_.find(name), function2 = functions2_.find(name);
+		if (function == functions_.end() || function2 == functions2_.end() || !function->second || !function2->second)
+			return;
+		const FunctionDecl *fd = function->second, *fd2 = function2->second;
+		if (!Summarizable(fd,fd2))
+			return;
+		SummarizeCallees(fd,fd2);
+		CFG *cfg_ptr = context_manager_.getContext(fd)->getCFG(), *cfg2_ptr = context_manager_.getContext(fd2)->getCFG();
+		if (!cfg_ptr || !cfg2_ptr)
+			return;
+		APAbstractDomain domain(*cfg_ptr);
+		domain.InitializeValues(*cfg_ptr);
+		APChecker Observer(*queue_.context_ptr,queue_.code->getDiagnosticsEngine(), queue_.code->getPreprocessor());
+		domain.getAnalysisData().Observer = &Observer;
+		domain.getAnalysisData().setContext(*queue_.context_ptr);
+		IterativeSolver is(domain,queue_.k,queue_.p,queue_.c,queue_.por,queue_.workers);
+		is.time_budget_ = queue_.seconds;
+		is.step_budget_ = queue_.steps;
+		is.disjunct_budget_ = queue_.disjuncts;
+		is.accelerate_ = queue_.accelerate;
+		is.band_ = queue_.band;
+		is.align_ = queue_.align;
+		is.transfer_cache_size_ = queue_.transfer_cache;
+		is.transformer_.summaries_ = &summaries_;
+		is.AssumeSummaryInput(fd,fd2);
+		IterativeSolver::Result result = is.RunOnCFGs(cfg_ptr,cfg2_ptr);
+		if (result.verdict == "unknown") // the exit state of a run that stopped does not cover every path
+			return;
+		IterativeSolver::State exit;
+		stringstream ss(result.states[0].second); // the exit comes first
+		bool read = Serialization::ReadState(ss,exit);
+		assert(read && "malformed exit state.");
+		vector<string> params;
+		for (unsigned int i = 0; i < fd->getNumParams(); ++i) {
+			params.push_back(fd->getParamDecl(i)->getNameAsString());
+		}
+		summaries_.Add(name,params,exit);
+	}
+
+	const map<string,const FunctionDecl*> &functions_, &functions2_;
+	AnalysisContextManager &context_manager_;
+	const FunctionQueue &queue_;
+	FunctionSummaries &summaries_;
+	set<string> visited_; // summarized, being summarized, or not summarizable
+};
+
+// the text of a function, as clang prints it: the key of its results does not depend on formatting or comments
+string FunctionText(const FunctionDecl *fd, const ASTContext &context) {
+	string text;
+	raw_string_ostream ros(text);
+	fd->print(ros,PrintingPolicy(context.getLangOptions()));
+	return ros.str();
+}
+
+// analyzes pairs off the queue until it is empty, in the calling thread's current context
+void AnalyzeQueue(FunctionQueue &queue, DiagnosticsEngine &diagnostics) {
+	while (true) {
+		pthread_mutex_lock(&queue.mutex);
+		unsigned int index = queue.next++;
+		pthread_mutex_unlock(&queue.mutex);
+		if (index >= queue.pairs.size())
+			break;
+		const FunctionPair &pair = queue.pairs[index];
+		IterativeSolver::Result result = AnalyzeFunction(queue,pair,diagnostics);
+		pthread_mutex_lock(&queue.mutex);
+		if (queue.threads > 1) // results come in any order
+			outs() << "Function " << pair.name << ": " << result.verdict << '\n';
+		stringstream *warnings = DomainContext::Current().warnings_;
+		if (warnings && warnings->str().size()) {
+			cerr << warnings->str();
+			warnings->str("");
+		}
+		if (result.degradations.size()) {
+			outs() << "Over budget, degraded to:";
+			for (vector<string>::const_iterator iter = result.degradations.begin(), end = result.degradations.end(); iter != end; ++iter)
+				outs() << " " << *iter;
+			outs() << '\n';
+		}
+		if (result.warm_start != "none")
+			outs() << "Warm start: " << result.warm_start << '\n';
+		IterativeSolver::PrintDeltas(outs(),result);
+		outs().flush();
+		if (queue.results)
+			WriteResult(*queue.results,pair.name,result);
+		if (queue.invariants)
+			WriteInvariants(*queue.invariants,pair,result);
+		pthread_mutex_unlock(&queue.mutex);
+	}
+}
+
+// keeps the diagnostics of a function worker, which are reported once the workers are joined
+class StoredDiagnostics : public DiagnosticConsumer {
+public:
+	vector<StoredDiagnostic> diagnostics_;
+
+	virtual void HandleDiagnostic(DiagnosticsEngine::Level level, const Diagnostic &info) {
+		DiagnosticConsumer::HandleDiagnostic(level,info);
+		diagnostics_.push_back(StoredDiagnostic(level,info));
+	}
+	virtual DiagnosticConsumer *clone(DiagnosticsEngine &diagnostics) const { return new StoredDiagnostics(); }
+};
+
+struct FunctionWorker {
+	FunctionQueue *queue;
+	manager *mgr_ptr;
+	// made by the main thread, which owns the source manager they refer to
+	DiagnosticsEngine *diagnostics;
+	StoredDiagnostics *stored;
+};
+
+// a thread analyzing functions in a context of its own, configured as the default one but quiet, with its
+// warnings printed along with each function's results
+void *RunFunctionWorker(void *arg) {
+	FunctionWorker *worker = static_cast<FunctionWorker*>(arg);
+	{
+		DomainContext context;
+		context.Configure(DomainContext::Current());
+		context.mgr_ptr_ = worker->mgr_ptr;
+		context.quiet_ = true;
+		stringstream warnings;
+		context.warnings_ = &warnings;
+		DomainContext::Install(&context);
+		AnalyzeQueue(*worker->queue,*worker->diagnostics);
+		DomainContext::Install(NULL);
+	}
+	delete worker->mgr_ptr;
+	return NULL;
+}
+
+}
+
     int IterativeAnalyzer::Main(int argc, char* argv[]) {
         CodeHandler::Init(argc,argv);
         IterativeAnalyzer().RunAnalysis();
         return 0;
     }
 
-    IterativeAnalyzer::IterativeAnalyzer() {  }
+    IterativeAnalyzer::IterativeAnalyzer() : results_(NULL) {  }
 
     /**
      * Run the analysis on 2 files
@@ -61,15 +531,52 @@ namespace differential {
     		WideningStrategy.addValue(AnalysisConfiguration::kWideningStrategyEquiv);
 		}
     	AnalysisConfiguration::PrintConfigurationHeader();
-    	APAbstractDomain::ValTy::mgr_ptr_ = AnalysisConfiguration::ParseManager(ManagerType);
-    	APAbstractDomain::ValTy::partition_point_ = AnalysisConfiguration::ParsePartitionPoint(PartitionPoint);
-    	APAbstractDomain::ValTy::partition_strategy_ = AnalysisConfiguration::ParsePartitionStrategy(PartitionStrategy);
-    	APAbstractDomain::ValTy::widening_point_ = AnalysisConfiguration::ParseWideningPoint(WideningPoint);
-    	APAbstractDomain::ValTy::widening_strategy_ = AnalysisConfiguration::ParseWideningStrategy(WideningStrategy);
-    	APAbstractDomain::ValTy::widening_threshold_ = AnalysisConfiguration::ParseWideningThreshold(WideningThreshold);
+    	APAbstractDomain::ValTy::Context().mgr_ptr_ = AnalysisConfiguration::ParseManager(ManagerType);
+    	APAbstractDomain::ValTy::Context().partition_point_ = AnalysisConfiguration::ParsePartitionPoint(PartitionPoint);
+    	APAbstractDomain::ValTy::Context().partition_strategy_ = AnalysisConfiguration::ParsePartitionStrategy(PartitionStrategy);
+    	APAbstractDomain::ValTy::Context().widening_point_ = AnalysisConfiguration::ParseWideningPoint(WideningPoint);
+    	APAbstractDomain::ValTy::Context().widening_strategy_ = AnalysisConfiguration::ParseWideningStrategy(WideningStrategy);
+    	APAbstractDomain::ValTy::Context().widening_threshold_ = AnalysisConfiguration::ParseWideningThreshold(WideningThreshold);
     	int k = AnalysisConfiguration::ParseInterleavignLookaheadWindow(InterleavingLookaheadWindow);
     	int p = AnalysisConfiguration::ParseInterleavignLookaheadPartition(InterleavingLookaheadPartition);
+    	int c = AnalysisConfiguration::ParseSpeculationCommit(SpeculationCommit);
+    	bool por = AnalysisConfiguration::ParseSpeculationPOR(SpeculationPOR);
+    	bool accelerate = AnalysisConfiguration::ParseAcceleration(Acceleration);
+    	unsigned band = AnalysisConfiguration::ParseBand(Band);
+    	bool align = AnalysisConfiguration::ParseAlign(Align);
+    	bool summarize = AnalysisConfiguration::ParseSummaries(Summaries);
+    	unsigned transfer_cache = AnalysisConfiguration::ParseTransferCacheSize(TransferCacheSize);
+    	int workers = AnalysisConfiguration::ParseSpeculationWorkers(SpeculationWorkers);
+    	bool batch = AnalysisConfiguration::ParseBatchMode(BatchMode);
+    	unsigned seconds = AnalysisConfiguration::ParseFunctionTimeBudget(FunctionTimeBudget);
+    	unsigned steps = AnalysisConfiguration::ParseFunctionStepBudget(FunctionStepBudget);
+    	unsigned disjuncts = AnalysisConfiguration::ParseFunctionDisjunctBudget(FunctionDisjunctBudget);
+    	string results_file = AnalysisConfiguration::ParseResultsFile(ResultsFile);
+    	int threads = AnalysisConfiguration::ParseFunctionWorkers(FunctionWorkers,ManagerType);
+    	ResultCache cache(AnalysisConfiguration::ParseCacheDirectory(CacheDirectory),
+    			(unsigned long)AnalysisConfiguration::ParseCacheSize(CacheSize) << 20);
+    	string invariants_file = AnalysisConfiguration::ParseInvariantsFile(InvariantsFile);
+    	string warm_start_file = AnalysisConfiguration::ParseWarmStartFile(WarmStartFile);
     	AnalysisConfiguration::PrintConfigurationFooter();
+    	APAbstractDomain::ValTy::Context().quiet_ = batch;
+    	if (threads > 1) {
+    		// no pauses or progress from several threads, and no forking from them
+    		APAbstractDomain::ValTy::Context().quiet_ = true;
+    		if (workers > 1)
+    			outs() << "Speculation workers: 1 (functions are analyzed in parallel)\n";
+    		workers = 1;
+    	}
+    	if (batch && results_file.empty())
+    		results_file = InputFilename + ".jsonl";
+    	ofstream results;
+    	if (!results_ && results_file.size())
+    		results.open(results_file.c_str(),ios::app);
+    	ofstream invariants_out;
+    	if (invariants_file.size())
+    		invariants_out.open(invariants_file.c_str());
+    	Invariants warm_start;
+    	if (warm_start_file.size() && !ReadInvariants(warm_start_file,warm_start))
+    		errs() << "Warning: could not read all the invariants in " << warm_start_file << '\n';
 
     	// extract an AST from each of the files
     	CodeHandler code(InputFilename), code2(InputFilename2);
@@ -81,9 +588,58 @@ namespace differential {
 		Utils::CreateFunctionsMap(contex_ptr->getTranslationUnitDecl(),functions);
 		Utils::CreateFunctionsMap(contex2_ptr->getTranslationUnitDecl(),functions2);
 
+		FunctionQueue queue;
+		queue.next = 0;
+		pthread_mutex_init(&queue.mutex,NULL);
+		queue.k = k;
+		queue.p = p;
+		queue.c = c;
+		queue.por = por;
+		queue.accelerate = accelerate;
+		queue.band = band;
+		queue.align = align;
+		queue.workers = workers;
+		queue.threads = threads;
+		queue.seconds = seconds;
+		queue.steps = steps;
+		queue.disjuncts = disjuncts;
+		queue.transfer_cache = transfer_cache;
+		queue.context_ptr = contex_ptr;
+		queue.code = &code;
+		queue.results = results_ ? results_ : (results.is_open() ? &results : NULL);
+		queue.cache = &cache;
+		queue.invariants = invariants_out.is_open() ? &invariants_out : NULL;
+		queue.summaries = NULL;
+
+		// everything a result depends on besides the functions: the version of the analysis and the settings
+		// that change results (the number of workers does not)
+		stringstream configuration;
+		const DomainContext &context = APAbstractDomain::ValTy::Context();
+		configuration << IterativeSolver::kVersion << ' ' << (ManagerType.size() ? ManagerType[0] : "default") << ' '
+				<< context.partition_point_ << ' ' << context.partition_strategy_ << ' ' << context.widening_point_ << ' '
+				<< context.widening_strategy_ << ' ' << context.widening_threshold_ << ' ' << k << ' ' << p << ' ' << c << ' '
+				<< por << ' ' << accelerate << ' ' << band << ' ' << align << ' ' << seconds << ' ' << steps << ' ' << disjuncts << '\n';
+
     	// the context manager is needed to produce a CFG
 		AnalysisContextManager context_manager;
-		// iterate over functions, match them, and perform the dual analysis
+		// the summaries of the callees, before any caller is analyzed (they do not pause or report progress)
+		FunctionSummaries summaries;
+		if (summarize) {
+			bool quiet = APAbstractDomain::ValTy::Context().quiet_;
+			APAbstractDomain::ValTy::Context().quiet_ = true;
+			Summarizer summarizer(functions,functions2,context_manager,queue,summaries);
+			for (map<string,const FunctionDecl*>::const_iterator iter = functions.begin(), end = functions.end(); iter != end; ++iter) {
+				map<string,const FunctionDecl*>::const_iterator match = functions2.find(iter->first);
+				if (iter->second->isThisDeclarationADefinition() && match != functions2.end() && match->second)
+					summarizer.SummarizeCallees(iter->second,match->second);
+			}
+			APAbstractDomain::ValTy::Context().quiet_ = quiet;
+			if (!summaries.empty())
+				queue.summaries = &summaries;
+			// a caller's result depends on its callees' summaries
+			configuration << summaries.ToString();
+		}
+		// iterate over functions, match them, and build their CFGs
 		for (map<string,const FunctionDecl*>::const_iterator iter = functions.begin(), end = functions.end(); iter != end; ++iter) {
 			const FunctionDecl* fd = iter->second;
 			if (!fd->isThisDeclarationADefinition())
@@ -91,26 +647,84 @@ namespace differential {
 			const FunctionDecl* fd2 = functions2[iter->first];
 			if (!fd2) // no matching for the function in the 2nd AST
 				continue;
-			CFG * cfg_ptr = context_manager.getContext(fd)->getCFG(), * cfg2_ptr = context_manager.getContext(fd2)->getCFG();
+			FunctionPair pair;
+			pair.name = iter->first;
+			pair.fd = fd;
+			pair.fd2 = fd2;
+			pair.cfg_ptr = context_manager.getContext(fd)->getCFG();
+			pair.cfg2_ptr = context_manager.getContext(fd2)->getCFG();
+			pair.size = (unsigned long)pair.cfg_ptr->getNumBlockIDs() * pair.cfg2_ptr->getNumBlockIDs();
+			Invariants::const_iterator invariants = warm_start.find(pair.name);
+			if (queue.invariants || invariants != warm_start.end()) {
+				BlockTexts(*pair.cfg_ptr,*contex_ptr,pair.texts);
+				BlockTexts(*pair.cfg2_ptr,*contex2_ptr,pair.texts2);
+			}
+			if (invariants != warm_start.end())
+				MapInvariants(invariants->second,pair);
+			if (cache.enabled()) {
+				// the candidates a warm start begins with may change the result
+				string candidates;
+				for (unsigned int i = 0; i < pair.warm_start.size(); ++i) {
+					stringstream ss;
+					ss << pair.warm_start[i].first.first->getBlockID() << ' ' << pair.warm_start[i].first.second->getBlockID();
+					Serialization::WriteName(ss,pair.warm_start[i].second);
+					candidates += ss.str();
+				}
+				pair.key = ResultCache::Key(configuration.str() + FunctionText(fd,*contex_ptr) + '\0' + FunctionText(fd2,*contex2_ptr) + '\0' + candidates);
+			}
 #if (DEBUG)
 			cerr << "Found both cfgs for " << iter->first << ":\n";
-			cfg_ptr->dump(LangOptions());
-			cfg2_ptr->dump(LangOptions());
+			pair.cfg_ptr->dump(LangOptions());
+			pair.cfg2_ptr->dump(LangOptions());
 			getchar();
 #endif
-			// this codes sets up the observer to use the first cfg
-			// an observer is what we used to report the results
-			// this could be defined using the second cfg as well
-			APAbstractDomain domain(*cfg_ptr);
-			domain.InitializeValues(*cfg_ptr);
-			APChecker Observer(*contex_ptr,code.getDiagnosticsEngine(), code.getPreprocessor());
-			domain.getAnalysisData().Observer = &Observer;
-			domain.getAnalysisData().setContext(*contex_ptr);
-			IterativeSolver is(domain,k,p);
-			is.AssumeInputEquivalence(fd,fd2);
-			is.RunOnCFGs(cfg_ptr,cfg2_ptr);
+			queue.pairs.push_back(pair);
+		}
 
+		// perform the dual analysis, in the order of the names, or largest product first when in parallel so
+		// that a big function does not start last and keep the other workers idle
+		if (threads == 1) {
+			AnalyzeQueue(queue,code.getDiagnosticsEngine());
+		} else {
+			stable_sort(queue.pairs.begin(),queue.pairs.end(),LargerFirst);
+			vector<FunctionWorker> function_workers(threads);
+			vector<pthread_t> ids(threads);
+			for (int i = 0; i < threads; ++i) {
+				function_workers[i].queue = &queue;
+				function_workers[i].mgr_ptr = AnalysisConfiguration::ParseManager(ManagerType,false);
+				function_workers[i].stored = new StoredDiagnostics();
+				function_workers[i].diagnostics = new DiagnosticsEngine(IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs()),
+						function_workers[i].stored,false);
+				function_workers[i].diagnostics->setSourceManager(&code.getDiagnosticsEngine().getSourceManager());
+			}
+			int started = 0;
+			for (; started < threads; ++started) {
+				if (pthread_create(&ids[started],NULL,RunFunctionWorker,&function_workers[started]) != 0) {
+					errs() << "Warning: could only start " << started << " function workers\n";
+					delete function_workers[started].mgr_ptr;
+					break;
+				}
+			}
+			if (started == 0) {
+				AnalyzeQueue(queue,code.getDiagnosticsEngine());
+			}
+			for (int i = 0; i < started; ++i) {
+				pthread_join(ids[i],NULL);
+			}
+			for (int i = started + 1; i < threads; ++i) {
+				delete function_workers[i].mgr_ptr;
+			}
+			// the diagnostics of the workers, by worker
+			for (int i = 0; i < threads; ++i) {
+				const vector<StoredDiagnostic> &stored = function_workers[i].stored->diagnostics_;
+				for (vector<StoredDiagnostic>::const_iterator iter = stored.begin(), end = stored.end(); iter != end; ++iter) {
+					code.getDiagnosticsEngine().Report(*iter);
+				}
+				delete function_workers[i].diagnostics;
+				delete function_workers[i].stored;
+			}
 		}
+		pthread_mutex_destroy(&queue.mutex);
     }
 
 }
@@ -20,11 +20,14 @@ class IterativeAnalyzer
 {
 private:
 	AnalyzerOptions analyzer_options_;
+	ostream *results_;
 
 public:
 	IterativeAnalyzer();
 	~IterativeAnalyzer() { }
 	void RunAnalysis(ostream& report_file = cout);
+	// write the per-function JSON lines to results instead of the results file
+	void set_results(ostream *results) { results_ = results; }
 	static int Main(int argc, char *argv[]);
 };
 }
@@ -20,6 +20,24 @@ llvm::cl::list<string> WideningStrategy("w_s",llvm::cl::value_desc(differential:
 llvm::cl::list<string> WideningThreshold("w_t",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Widening threshold"));
 llvm::cl::list<string> InterleavingLookaheadWindow("k",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative lookahead window size"));
 llvm::cl::list<string> InterleavingLookaheadPartition("p",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative partition interval"));
+llvm::cl::list<string> SpeculationCommit("c",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Speculative steps committed per window; the snapshots below the committed steps are reused by the next window, so a value under -k is needed for any reuse (default: the whole window, no reuse)"));
+llvm::cl::list<string> Acceleration("accel",llvm::cl::value_desc("0|1"),llvm::cl::desc("Summarize loops that add constants to variables in closed form instead of widening (default: 0)"));
+llvm::cl::list<string> Band("band",llvm::cl::value_desc("blocks"),llvm::cl::desc("Prefer the interleavings that keep within this many blocks of the alignment of the CFGs' block texts (default: 0, any)"));
+llvm::cl::list<string> Align("align",llvm::cl::value_desc("0|1"),llvm::cl::desc("Step through the blocks that the alignment of the CFGs' block texts matches without speculating, and speculate only around the others (default: 0)"));
+llvm::cl::list<string> TransferCacheSize("t_cache",llvm::cl::value_desc("entries"),llvm::cl::desc("Block transfers remembered per disjunct (default: 4096, 0 for none)"));
+llvm::cl::list<string> Summaries("summ",llvm::cl::value_desc("0|1"),llvm::cl::desc("Relate the return values of calls to matched functions by their differential summaries (default: 0)"));
+llvm::cl::list<string> SpeculationPOR("s_por",llvm::cl::value_desc("0|1"),llvm::cl::desc("Speculate over all interleavings, up to the order of commuting steps"));
+llvm::cl::list<string> SpeculationWorkers("s_w",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Number of worker processes speculating in parallel"));
+llvm::cl::list<string> BatchMode("batch",llvm::cl::value_desc("0|1"),llvm::cl::desc("Run unattended: no pauses, no progress output"));
+llvm::cl::list<string> FunctionTimeBudget("t_f",llvm::cl::value_desc("seconds"),llvm::cl::desc("Time budget per function (default: none)"));
+llvm::cl::list<string> FunctionStepBudget("s_f",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Step budget per function (default: none)"));
+llvm::cl::list<string> FunctionDisjunctBudget("d_f",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Disjuncts a state may have before the analysis degrades (default: no limit)"));
+llvm::cl::list<string> ResultsFile("json",llvm::cl::value_desc("filename"),llvm::cl::desc("Append per-function results to this file as JSON lines (batch default: <filename>.jsonl)"));
+llvm::cl::list<string> FunctionWorkers("f_w",llvm::cl::value_desc("positive integer"),llvm::cl::desc("Number of threads analyzing functions in parallel, with the box, oct or polka domains (default: 1)"));
+llvm::cl::list<string> CacheDirectory("cache",llvm::cl::value_desc("directory"),llvm::cl::desc("Reuse the results of unchanged functions, kept in this directory across runs"));
+llvm::cl::list<string> CacheSize("cache_mb",llvm::cl::value_desc("MB"),llvm::cl::desc("Size of the result cache (default: 256, 0 for unbounded)"));
+llvm::cl::list<string> InvariantsFile("invariants",llvm::cl::value_desc("file"),llvm::cl::desc("Write the states at the loop heads (and correlation points) to this file"));
+llvm::cl::list<string> WarmStartFile("warm",llvm::cl::value_desc("file"),llvm::cl::desc("Start the loop heads from the states written by an earlier run (with -invariants), once validated"));
 
 int main(int argc, char* argv[])
 {
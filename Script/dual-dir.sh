@@ -11,13 +11,7 @@ ret_guard="-ret_guard=true"
 ParseUccCommandLine $@
 echo "Press 'Enter' to continue or terminate with 'Ctrl+c'"
 read -n1 kbd
-mkdir -p Results
-for file in $( ls *.i ); do
-        if [[ $file != *patched* && $file != *guarded* && $file != *union* ]] 
-        then
-            echo "Dual run: (timeout 1000 dual $file -u=patched.$file $x0 $tag_equality $clear $diff_points $ret_guard $asserts $manager $canon_point $canon_strategy -r=Report.log > Results/$file.out 2> Results/$file.err)"
-            timeout 1000 dual $file -u=patched.$file $x0 $tag_equality $clear $diff_points $ret_guard $asserts $manager $canon_point $canon_strategy -r=Report.log > Results/$file.out 2> Results/$file.err
-	    echo $file "done."
-        fi
-done
-
+# each .i file and its patched.<file> are a scorebatch job, run in a process of its own (-j at a time, the
+# number of processors by default) and retried with octagons, then boxes; the report goes to Results/Report.log
+echo "Dual run: (scorebatch . -kind=dual -t_j=1000 -out=Results $manager $x0 $tag_equality $clear $diff_points $ret_guard $asserts $canon_point $canon_strategy)"
+scorebatch . -kind=dual -t_j=1000 -out=Results $manager $x0 $tag_equality $clear $diff_points $ret_guard $asserts $canon_point $canon_strategy
@@ -0,0 +1,92 @@
+#!/bin/bash
+echo "Usage: options.sh [<case>.options...] (run in Test/options, with score and ccc on the path)"
+# Each line of a <case>.options file is "<name> [cached|slice|union] [<score options>]". score is run on <name>.c
+# and patched.<name>.c with the options, and must give the verdicts listed in expected.<name>.txt:
+#  - cached: every function must also be taken from the result cache (filled by an earlier line);
+#  - slice: both versions are sliced first (ccc -s), and each sliced version must hold what
+#    expected.sliced.<name>.txt lists, as "<count> <text>" lines: the number of its lines holding the text;
+#  - union: the union program is built with sparse tagging instead (as union.sh -sparse=true does), must
+#    compile and hold what expected.union.<name>.txt lists, and ccc -u must refuse it without -sparse_tags.
+if [[ $# > 0 ]]
+    then
+        cases=$@
+    else
+        cases=*.options
+fi
+rm -rf options.cache options.invariants
+failed=0
+
+function Verdicts {
+    rm -f options.jsonl
+    score $1 $2 -batch=1 -json=options.jsonl ${@:3} > /dev/null 2>&1
+    sed -n 's/.*"function":"\([^"]*\)","verdict":"\([^"]*\)".*/\1 \2/p' options.jsonl | sort
+}
+
+function Counts {
+    while read count text ; do
+        actual=$(grep -c -F "$text" $1)
+        if [[ $actual != $count ]]
+            then
+                echo "  $1: $actual lines hold '$text', expected $count"
+                return 1
+        fi
+    done < $2
+}
+
+for case in $cases ; do
+    while read name kind options ; do
+        if [[ $name == "" || $name == \#* ]]
+            then
+                continue
+        fi
+        file=$name.c
+        patched=patched.$name.c
+        ok=1
+        label=$(echo $name $kind $options)
+        case $kind in
+            cached) ;;
+            slice)
+                ccc -s $file -s_with $patched > /dev/null 2>&1
+                Counts sliced.$file expected.sliced.$name.txt || ok=0
+                Counts sliced.$patched expected.sliced.$name.txt || ok=0
+                file=sliced.$file
+                patched=sliced.$patched ;;
+            union) ;;
+            *)  options="$kind $options" ;;
+        esac
+        if [[ $kind == "union" ]]
+            then
+                ccc -g $file -ret_guard=true > /dev/null 2>&1
+                ccc -g_t $patched -ret_guard=true > /dev/null 2>&1
+                ccc -t guarded.$patched -t_with guarded.$file -tag_equality=true > /dev/null 2>&1
+                if ccc -u tagged.guarded.$patched guarded.$file -diff_points=true > /dev/null 2>&1
+                    then
+                        echo "  ccc -u took tagged.guarded.$patched without -sparse_tags=true"
+                        ok=0
+                fi
+                ccc -u tagged.guarded.$patched guarded.$file -diff_points=true -sparse_tags=true > /dev/null 2>&1
+                gcc -fsyntax-only union.$file || ok=0
+                Counts union.$file expected.union.$name.txt || ok=0
+            else
+                if [[ "$(Verdicts $file $patched $options)" != "$(cat expected.$name.txt)" ]]
+                    then
+                        echo "  verdicts differ from expected.$name.txt:"
+                        Verdicts $file $patched $options
+                        ok=0
+                fi
+                if [[ $kind == "cached" && ( ! -s options.jsonl || $(grep -c '"cached":false' options.jsonl) != 0 ) ]]
+                    then
+                        echo "  not every function was taken from the cache"
+                        ok=0
+                fi
+        fi
+        if [[ $ok == 1 ]]
+            then
+                echo "$case: $label passed"
+            else
+                echo "$case: $label FAILED"
+                failed=1
+        fi
+    done < $case
+done
+exit $failed
@@ -1,10 +1,5 @@
 #!/bin/bash
-for file in $( ls *.i ); do
-        if [[ $file != *patched* && $file != *guarded* && $file != *union* ]] 
-        then
-            echo Unioning $file...
-	    union.sh $file patched.$file $@
-	    echo Done.
-        fi
-done
-
+# each .i file and its patched.<file> are a scorebatch job, which runs union.sh on them with these options
+echo Unioning the .i files...
+scorebatch . -kind=union -out=Results $@
+echo Done.
@@ -1,5 +1,5 @@
 #!/bin/bash
-echo "Usage: union.sh filename patched_filename [-clear|prep|x0|eq|diffp|ret|inline|asserts=true|false]"
+echo "Usage: union.sh filename patched_filename [-clear|prep|x0|eq|diffp|ret|inline|asserts|sparse=true|false]"
 if [[ $# < 2 ]]
     then
         echo "Not enough args, exiting"
@@ -25,10 +25,15 @@ echo "Guarding $filename...(ccc -g $filename $ret_guard $x0)"
 ccc -g $filename $ret_guard $x0 #2> ccc.guarded.$filename.err
 echo "Guarding $patched_filename...(ccc -g_t $patched_filename $ret_guard $x0)"
 ccc -g_t $patched_filename $ret_guard $x0 #2> ccc.guarded.$patched_filename.err
-echo "Tagging guarded.$patched_filename...(ccc -t guarded.$patched_filename $tag_equality $asserts)"
-ccc -t guarded.$patched_filename $tag_equality $asserts #2> ccc.tagged.guarded.$patched_filename.err 
-echo "Unioning guarded.$filename and tagged.guarded.$patched_filename...(ccc -u tagged.guarded.$patched_filename guarded.$filename $clear $diff_points)"
-ccc -u tagged.guarded.$patched_filename guarded.$filename $clear $diff_points #2> ccc.union.$filename.err
+tag_with=""
+if [[ $sparse_tags == "-sparse_tags=true" ]]
+    then
+        tag_with="-t_with guarded.$filename"
+fi
+echo "Tagging guarded.$patched_filename...(ccc -t guarded.$patched_filename $tag_with $tag_equality $asserts)"
+ccc -t guarded.$patched_filename $tag_with $tag_equality $asserts #2> ccc.tagged.guarded.$patched_filename.err 
+echo "Unioning guarded.$filename and tagged.guarded.$patched_filename...(ccc -u tagged.guarded.$patched_filename guarded.$filename $clear $diff_points $sparse_tags)"
+ccc -u tagged.guarded.$patched_filename guarded.$filename $clear $diff_points $sparse_tags #2> ccc.union.$filename.err
 echo
 echo "Look for error messages (if emitted) in the ccc.*.err files."
 echo Done.
@@ -8,6 +8,7 @@ diff_points="-diff_points=false"
 ret_guard="-ret_guard=false"
 inline="-inline=false"
 asserts="-asserts=false"
+sparse_tags="-sparse_tags=false"
 
 function ParseUccCommandLine {
     while [[ $# > 0 ]] ; do
@@ -20,6 +21,7 @@ function ParseUccCommandLine {
             -ret=*)       ret_guard=$1 ;    shift 1 ;;
             -inline=*)    inline=$1 ;       shift 1 ;;
             -asserts=*)   asserts=$1 ;       shift 1 ;;
+            -sparse=*)    sparse_tags="-sparse_tags=${1#-sparse=}" ;   shift 1 ;;
             *)                              shift 1 ;;
         esac
     done
@@ -31,6 +33,7 @@ function ParseUccCommandLine {
     echo "Create Diff Points? : [$diff_points]"
     echo "Add Assertions? (i.e. assert(x' == x)) : [$asserts]"
     echo "Replace return With Guard? : [$ret_guard]"
+    echo "Tag Only What The Patch Reaches? : [$sparse_tags]"
 }
 
 manager="-m=ppl"
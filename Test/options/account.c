@@ -0,0 +1,24 @@
+int total;
+
+int account(int x, int y) {
+  int a, b, c;
+  a = x + 1;
+  b = y * 2;
+  c = a + 1;
+  total = b;
+  return c;
+}
+
+int scale(int z) {
+  int t;
+  t = z * 3;
+  return t;
+}
+
+int carry(int w) {
+  int c, d;
+  c = w;
+  total = c;
+  d = total;
+  return d;
+}
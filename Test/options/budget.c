@@ -0,0 +1,16 @@
+int clamp(int x, int n) {
+  int i, s = 0;
+  if (x < 0)
+    x = 0;
+  if (x > 100)
+    x = 100;
+  if (n < 0)
+    n = 0;
+  if (n > 10)
+    n = 10;
+  for (i = 0; i < n; i++)
+    s = s + x;
+  if (s > 500)
+    s = 500;
+  return s;
+}
@@ -0,0 +1,7 @@
+int inc(int x) {
+  return x + 2;
+}
+
+int twice(int y) {
+  return inc(y) + inc(y);
+}
@@ -0,0 +1,23 @@
+int sum(int n) {
+  int i, s = 0;
+  for (i = 0; i < n; i++)
+    s += 2;
+  return s;
+}
+
+int sign(int x) {
+  int sgn;
+  if (x < 0)
+    sgn = 1;
+  else
+    sgn = -1;
+  if (x == 0)
+    sgn = 0;
+  return sgn;
+}
+
+int magnitude(int x) {
+  if (x >= 0)
+    return x;
+  return -x;
+}
@@ -0,0 +1,7 @@
+int step(int x, int u) {
+  int r;
+  r = x + 2;
+  if (u > 0)
+    u = u - 1;
+  return r + u;
+}
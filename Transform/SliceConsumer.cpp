@@ -0,0 +1,249 @@
+#include "SliceConsumer.h"
+
+namespace differential {
+
+namespace {
+
+bool Intersect(const set<const VarDecl*> &set1, const set<const VarDecl*> &set2) {
+	for (set<const VarDecl*>::const_iterator iter = set1.begin(), end = set1.end(); iter != end; ++iter) {
+		if (set2.count(*iter))
+			return true;
+	}
+	return false;
+}
+
+bool Global(Expr *node) {
+	DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node->IgnoreParenImpCasts());
+	const VarDecl *decl = ref ? dyn_cast<VarDecl>(ref->getDecl()) : NULL;
+	return decl && !decl->hasLocalStorage();
+}
+
+bool Tainted(const set<const VarDecl*> &vars, const Taint &taint) {
+	for (set<const VarDecl*>::const_iterator iter = vars.begin(), end = vars.end(); iter != end; ++iter) {
+		if (taint.Tainted(*iter))
+			return true;
+	}
+	return false;
+}
+
+}
+
+void Slicer::Slice(FunctionDecl *node) {
+	statements_.clear();
+	escaped_.clear();
+	Collect(node->getBody(), vector<unsigned>());
+
+	// forward, as Taint followed the patch: the conditions are collected before the statements under them.
+	// the statements' own defs would miss what a write to a global, an array or through a pointer carries
+	vector<bool> reached(statements_.size(), false);
+	for (unsigned i = 0; i < statements_.size(); ++i) {
+		const Statement &statement = statements_[i];
+		reached[i] = statement.changed || Tainted(statement.uses,taint_);
+		for (unsigned j = 0; j < statement.conditions.size() && !reached[i]; ++j) {
+			reached[i] = reached[statement.conditions[j]];
+		}
+	}
+
+	// backward, from the outputs the patch reaches and the changed statements
+	vector<bool> kept(statements_.size(), false);
+	set<const VarDecl*> needed = escaped_;
+	for (bool grew = true; grew; ) {
+		grew = false;
+		for (unsigned i = 0; i < statements_.size(); ++i) {
+			const Statement &statement = statements_[i];
+			if (kept[i] || !((reached[i] && !statement.removable) || statement.changed || Intersect(statement.defs,needed)))
+				continue;
+			Keep(i, kept, needed);
+			grew = true;
+		}
+	}
+
+	// the variables left in the code, whose declarations must stay (an output the patch does not reach may use them).
+	// what is sliced away from them is replaced by a call, which the analyzers take as the same value in both
+	// versions: the patch does not reach them, so they are the same
+	set<const VarDecl*> referenced;
+	for (unsigned i = 0; i < statements_.size(); ++i) {
+		if (kept[i] || !statements_[i].removable) {
+			referenced.insert(statements_[i].defs.begin(), statements_[i].defs.end());
+			referenced.insert(statements_[i].uses.begin(), statements_[i].uses.end());
+		}
+	}
+
+	for (unsigned i = 0; i < statements_.size(); ++i) {
+		if (!kept[i] && statements_[i].removable) {
+			const Statement &statement = statements_[i];
+			DeclStmt *decl_stmt = dyn_cast<DeclStmt>(statement.stmt);
+			if (decl_stmt && Intersect(statement.defs,referenced)) {
+				string declarations;
+				for (DeclStmt::decl_iterator iter = decl_stmt->decl_begin(), end = decl_stmt->decl_end(); iter != end; ++iter) {
+					VarDecl *decl = cast<VarDecl>(*iter);
+					declarations += decl->getType().getAsString() + " " + decl->getNameAsString() +
+							(referenced.count(decl) && decl->getInit() ? " = " + Stub(node,decl) : "") + ";";
+				}
+				rewriter_.ReplaceText(decl_stmt->getSourceRange(), declarations); // the range ends with the ';'
+			} else if (Intersect(statement.defs,referenced)) {
+				string assignments;
+				for (set<const VarDecl*>::const_iterator iter = statement.defs.begin(), end = statement.defs.end(); iter != end; ++iter) {
+					if (referenced.count(*iter))
+						assignments += (assignments.empty() ? "" : ", ") + (*iter)->getNameAsString() + " = " + Stub(node,*iter);
+				}
+				rewriter_.ReplaceText(statement.stmt->getSourceRange(), assignments);
+			} else {
+				// an expression statement keeps its ';', a declaration does not
+				rewriter_.ReplaceText(statements_[i].stmt->getSourceRange(), decl_stmt ? ";" : "");
+			}
+			removed_ctr_++;
+		} else if (reached[i]) {
+			affected_ctr_++;
+		}
+	}
+	statements_ctr_ += statements_.size();
+}
+
+// the call standing for the values of a local that are sliced away, declared once at the top of the file
+string Slicer::Stub(const FunctionDecl *function, const VarDecl *decl) {
+	string name = Defines::kSlicedPrefix + function->getNameAsString() + "_" + decl->getNameAsString();
+	stubs_.insert(decl->getType().getAsString() + " " + name + "();\n");
+	return name + "()";
+}
+
+// keep a statement, what it uses and the conditions it is under (which are under the outer ones themselves)
+void Slicer::Keep(unsigned index, vector<bool> &kept, set<const VarDecl*> &needed) const {
+	const Statement &statement = statements_[index];
+	kept[index] = true;
+	needed.insert(statement.defs.begin(), statement.defs.end()); // their declarations
+	needed.insert(statement.uses.begin(), statement.uses.end());
+	for (unsigned i = 0; i < statement.conditions.size(); ++i) {
+		if (!kept[statement.conditions[i]])
+			Keep(statement.conditions[i], kept, needed);
+	}
+}
+
+// statements are collected where they can be removed on their own; what control statements hold besides
+// (their conditions, and the initialization and increment of for loops) is collected as not removable
+void Slicer::Collect(Stmt *node, const vector<unsigned> &conditions) {
+	if (!node)
+		return;
+	if (CompoundStmt *compound = dyn_cast<CompoundStmt>(node)) {
+		for (CompoundStmt::body_iterator iter = compound->body_begin(), end = compound->body_end(); iter != end; ++iter) {
+			Collect(*iter, conditions);
+		}
+	} else if (IfStmt *if_stmt = dyn_cast<IfStmt>(node)) {
+		vector<unsigned> inner = conditions;
+		inner.push_back(Add(if_stmt->getCond(), false, conditions));
+		Collect(if_stmt->getThen(), inner);
+		Collect(if_stmt->getElse(), inner);
+	} else if (ForStmt *for_stmt = dyn_cast<ForStmt>(node)) {
+		if (for_stmt->getInit())
+			Add(for_stmt->getInit(), false, conditions);
+		vector<unsigned> inner = conditions;
+		if (for_stmt->getCond())
+			inner.push_back(Add(for_stmt->getCond(), false, conditions));
+		if (for_stmt->getInc())
+			Add(for_stmt->getInc(), false, inner);
+		Collect(for_stmt->getBody(), inner);
+	} else if (WhileStmt *while_stmt = dyn_cast<WhileStmt>(node)) {
+		vector<unsigned> inner = conditions;
+		inner.push_back(Add(while_stmt->getCond(), false, conditions));
+		Collect(while_stmt->getBody(), inner);
+	} else if (DoStmt *do_stmt = dyn_cast<DoStmt>(node)) {
+		vector<unsigned> inner = conditions;
+		inner.push_back(Add(do_stmt->getCond(), false, conditions));
+		Collect(do_stmt->getBody(), inner);
+	} else if (SwitchStmt *switch_stmt = dyn_cast<SwitchStmt>(node)) {
+		vector<unsigned> inner = conditions;
+		inner.push_back(Add(switch_stmt->getCond(), false, conditions));
+		Collect(switch_stmt->getBody(), inner);
+	} else if (SwitchCase *switch_case = dyn_cast<SwitchCase>(node)) {
+		Collect(switch_case->getSubStmt(), conditions);
+	} else if (LabelStmt *label = dyn_cast<LabelStmt>(node)) {
+		Collect(label->getSubStmt(), conditions);
+	} else {
+		Add(node, true, conditions);
+	}
+}
+
+unsigned Slicer::Add(Stmt *node, bool removable, const vector<unsigned> &conditions) {
+	Statement statement;
+	statement.stmt = node;
+	statement.removable = removable && node->getLocStart().isFileID() && node->getLocEnd().isFileID(); // not through macros
+	statement.changed = Changed(node);
+	statement.conditions = conditions;
+	Refs(node, statement);
+	statements_.push_back(statement);
+	return statements_.size() - 1;
+}
+
+// the variables the statement defines and uses. a statement that writes anything but a local scalar, calls,
+// or transfers control is an output, and is not removable
+void Slicer::Refs(Stmt *node, Statement &statement) {
+	if (!node)
+		return;
+	if (BinaryOperator *op = dyn_cast<BinaryOperator>(node)) {
+		if (op->isAssignmentOp()) {
+			if (const VarDecl *decl = LocalScalar(op->getLHS())) {
+				statement.defs.insert(decl);
+				if (op->isCompoundAssignmentOp())
+					statement.uses.insert(decl);
+			} else {
+				statement.removable = false;
+				// a global assigned as a whole is not used: what it held does not reach the output
+				if (op->isCompoundAssignmentOp() || !Global(op->getLHS()))
+					Refs(op->getLHS(), statement);
+			}
+			Refs(op->getRHS(), statement);
+			return;
+		}
+	} else if (UnaryOperator *op = dyn_cast<UnaryOperator>(node)) {
+		if (op->isIncrementDecrementOp()) {
+			if (const VarDecl *decl = LocalScalar(op->getSubExpr())) {
+				statement.defs.insert(decl);
+				statement.uses.insert(decl);
+				return;
+			}
+			statement.removable = false;
+		} else if (op->getOpcode() == UO_AddrOf) {
+			if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(op->getSubExpr()->IgnoreParenImpCasts())) {
+				if (const VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl()))
+					escaped_.insert(decl);
+			}
+		}
+	} else if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node)) {
+		if (const VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl()))
+			statement.uses.insert(decl);
+	} else if (DeclStmt *decl_stmt = dyn_cast<DeclStmt>(node)) {
+		for (DeclStmt::decl_iterator iter = decl_stmt->decl_begin(), end = decl_stmt->decl_end(); iter != end; ++iter) {
+			VarDecl *decl = dyn_cast<VarDecl>(*iter);
+			if (!decl || !decl->hasLocalStorage() || !(decl->getType()->isIntegerType() || decl->getType()->isFloatingType())) {
+				statement.removable = false;
+			}
+			if (decl) {
+				statement.defs.insert(decl);
+				Refs(decl->getInit(), statement);
+			}
+		}
+		return;
+	} else if (isa<CallExpr>(node) || !isa<Expr>(node)) { // calls, returns, jumps, and whatever else
+		statement.removable = false;
+	}
+	for (Stmt::child_iterator iter = node->child_begin(), end = node->child_end(); iter != end; ++iter) {
+		Refs(*iter, statement);
+	}
+}
+
+const VarDecl *Slicer::LocalScalar(Expr *node) const {
+	DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node->IgnoreParenImpCasts());
+	const VarDecl *decl = ref ? dyn_cast<VarDecl>(ref->getDecl()) : NULL;
+	if (decl && decl->hasLocalStorage() && (decl->getType()->isIntegerType() || decl->getType()->isFloatingType()))
+		return decl;
+	return NULL;
+}
+
+bool Slicer::Changed(Stmt *node) const {
+	unsigned first = source_manager_.getSpellingLineNumber(node->getLocStart()),
+			last = source_manager_.getSpellingLineNumber(node->getLocEnd());
+	set<unsigned>::const_iterator line = changed_lines_.lower_bound(first);
+	return line != changed_lines_.end() && *line <= last;
+}
+
+}
@@ -0,0 +1,116 @@
+#ifndef ANALYZER_SLICE_CONSUMER_H
+#define ANALYZER_SLICE_CONSUMER_H
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <string>
+using namespace std;
+
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Rewrite/Rewriter.h>
+using namespace clang;
+using namespace llvm;
+
+#include "../Utils.h"
+#include "../Defines.h"
+#include "Taint.h"
+
+namespace differential {
+
+/**
+ * Removes from the functions of one version the statements that cannot affect a difference from the other
+ * version: assignments and declarations of local scalars whose values never reach an output the patch reaches.
+ * Outputs are what the analyzers compare or cannot see through: returns, calls, writes through pointers, to
+ * arrays and to globals, and the conditions of the control statements (the control structure is kept as is).
+ * The patch is first followed forward by Taint, over the whole unit, from the changed statements (on the lines
+ * the line diff against the other version marks) and from the variables named on the changed lines of either
+ * version (so that both versions start from the same variables): a statement is reached if it is changed, uses
+ * a tainted variable (writes through pointers, to arrays and to globals taint what they write, and its
+ * aliases), or is under a condition that is reached. The slice then goes backward from the outputs it reached and the changed statements,
+ * through what they use and the conditions they are under. Outputs the patch does not reach are left in place,
+ * but the definitions of their inputs may be sliced away. Each is then replaced by a call (Sliced_<function>_<var>,
+ * declared at the top of the file), which the analyzers take as the same value in both versions, as it is.
+ * Both passes are flow-insensitive: a statement is kept if it defines a variable that a kept statement uses,
+ * wherever they are. A removed statement is replaced by an empty one, so labels and branches stay valid.
+ */
+class Slicer {
+	struct Statement {
+		Stmt *stmt;
+		set<const VarDecl*> defs, uses;
+		bool removable, changed;
+		vector<unsigned> conditions; // the conditions the statement is under (by index)
+	};
+
+	Rewriter        &rewriter_;
+	SourceManager   &source_manager_;
+	const set<unsigned> &changed_lines_;
+	const Taint     &taint_; // of the unit, from the changed lines and the names changed in both versions
+
+	vector<Statement> statements_; // of the current function
+	set<const VarDecl*> escaped_; // locals whose address is taken
+
+	void Collect(Stmt *node, const vector<unsigned> &conditions);
+	unsigned Add(Stmt *node, bool removable, const vector<unsigned> &conditions);
+	void Keep(unsigned index, vector<bool> &kept, set<const VarDecl*> &needed) const;
+	string Stub(const FunctionDecl *function, const VarDecl *decl);
+	void Refs(Stmt *node, Statement &statement);
+	const VarDecl *LocalScalar(Expr *node) const;
+	bool Changed(Stmt *node) const;
+
+public:
+
+	unsigned statements_ctr_, removed_ctr_, affected_ctr_;
+	set<string> stubs_; // the declarations of the calls standing for what was sliced away (see Slice)
+
+	Slicer(Rewriter &rewriter, const set<unsigned> &changed_lines, const Taint &taint) :
+		rewriter_(rewriter), source_manager_(rewriter.getSourceMgr()), changed_lines_(changed_lines),
+		taint_(taint), statements_ctr_(0), removed_ctr_(0), affected_ctr_(0) { }
+	virtual ~Slicer() { }
+
+	void Slice(FunctionDecl *node);
+};
+
+class SlicerASTConsumer : public ASTConsumer {
+	Rewriter             &rewriter_;
+	const set<unsigned>  &changed_lines_;
+	const set<string>    &changed_names_;
+
+public:
+
+	SlicerASTConsumer(Rewriter& rewriter, const set<unsigned> &changed_lines, const set<string> &changed_names) :
+		rewriter_(rewriter), changed_lines_(changed_lines), changed_names_(changed_names) {}
+
+	virtual ~SlicerASTConsumer() {}
+
+	virtual void HandleTranslationUnit(ASTContext &contex) {
+		// called when everything is done
+		SourceManager &source_manager = contex.getSourceManager();
+		string filename = source_manager.getFileEntryForID(source_manager.getMainFileID())->getName();
+		TranslationUnitDecl *unit = contex.getTranslationUnitDecl();
+		Taint taint(source_manager, changed_lines_, changed_names_);
+		taint.Run(unit);
+		Slicer slicer(rewriter_, changed_lines_, taint);
+		for (DeclContext::decl_iterator iter = unit->decls_begin(), end = unit->decls_end(); iter != end; ++iter) {
+			FunctionDecl *node = dyn_cast<FunctionDecl>(*iter);
+			if (node && node->isThisDeclarationADefinition() && source_manager.isFromMainFile(node->getLocation()))
+				slicer.Slice(node);
+		}
+		string stubs;
+		for (set<string>::const_iterator iter = slicer.stubs_.begin(), end = slicer.stubs_.end(); iter != end; ++iter) {
+			stubs += *iter;
+		}
+		rewriter_.InsertText(source_manager.getLocForStartOfFile(source_manager.getMainFileID()), stubs);
+		cout << filename << ": " << slicer.removed_ctr_ << " of " << slicer.statements_ctr_ << " statements sliced away, "
+				<< slicer.affected_ctr_ << " reached by the patch\n";
+		Utils::WriteFiles(rewriter_,Defines::kSlicedFilenamePrefix + filename);
+	}
+};
+
+}
+
+#endif
@@ -8,7 +8,7 @@ namespace differential {
         VarDecl * decl_ptr = dyn_cast<VarDecl>(node->getDecl());
         if (!decl_ptr) // ignore other types of declarations for now
             return;
-        if (!decl_ptr->isExternC()) {// ignore externs 
+        if (!decl_ptr->isExternC() && Tagged(decl_ptr)) {// ignore externs (and, when sparse, what the patch cannot reach)
             rewriter_.InsertText(node->getLocStart(), Defines::kTagPrefix); // tag it
             if (add_asserts_ && is_l_value_ && 
                 !decl_ptr->getType()->isArrayType() && // ignore arrays 
@@ -31,11 +31,14 @@ namespace differential {
         }
 
         if ( node->isThisDeclarationADefinition() ) {
+            function_ = node;
             stringstream ParamsOS;
             ParamsOS << "\n";
             // For now add the tagged parameters as local variables
             for ( unsigned i = 0 ; i < node->getNumParams() ; i++ ) {
                 ParmVarDecl * p = node->getParamDecl(i);
+                if ( !Tagged(p) ) // the untagged parameter stands for both versions
+                    continue;
                 string decl = Utils::PrintDecl(p,contex_);
                 string name = p->getNameAsString();
                 unsigned l = decl.find_last_of(name) - name.size() + 1;
@@ -62,7 +65,8 @@ namespace differential {
     }
 
     void TagInstructions::VisitGotoStmt(GotoStmt * node) {
-        rewriter_.InsertText(node->getLabelLoc(), Defines::kTagPrefix); 
+        if ( Tagged(node->getLabel()->getNameAsString()) )
+            rewriter_.InsertText(node->getLabelLoc(), Defines::kTagPrefix); 
     }
 
     void TagInstructions::VisitVarDecl(VarDecl *node) {
@@ -70,7 +74,7 @@ namespace differential {
             return Visit(node->getBody());
         if ( node->hasInit() )
             Visit(node->getInit());
-        if ( node->isExternC() )
+        if ( node->isExternC() || !Tagged(node) )
             return;
         // make RetVal' = RetVal
         /*
@@ -89,7 +93,8 @@ namespace differential {
     }
 
     void TagInstructions::VisitLabelStmt(LabelStmt * node) {
-        rewriter_.InsertText(node->getLocStart(), Defines::kTagPrefix); 
+        if ( Tagged(node->getName()) )
+            rewriter_.InsertText(node->getLocStart(), Defines::kTagPrefix); 
         Visit(node->getSubStmt());
     }
 
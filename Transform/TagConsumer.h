@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 using namespace std;
 
 #include <clang/AST/ASTConsumer.h>
@@ -21,6 +22,7 @@ using namespace llvm;
 
 #include "../Utils.h"
 #include "../Defines.h"
+#include "Taint.h"
 
 namespace differential {
 
@@ -33,6 +35,8 @@ namespace differential {
       SourceManager  &source_manager_;
       ASTContext     &contex_;
       stringstream   *assertion_ss_ptr;
+      const Taint    *taint_; // what to tag, or NULL to tag everything
+      FunctionDecl   *function_;
 
       unsigned asserts_ctr_;
 
@@ -40,8 +44,8 @@ namespace differential {
       const bool tag_equality_;
       bool is_l_value_;
 
-      TagInstructions(Rewriter &rewriter, ASTContext &contex, bool tag_equality, bool add_asserts) :
-          rewriter_(rewriter), source_manager_(rewriter_.getSourceMgr()), contex_(contex), 
+      TagInstructions(Rewriter &rewriter, ASTContext &contex, bool tag_equality, bool add_asserts, const Taint *taint = NULL) :
+          rewriter_(rewriter), source_manager_(rewriter_.getSourceMgr()), contex_(contex), taint_(taint), function_(NULL),
           asserts_ctr_(0), tag_equality_(tag_equality), add_asserts_(add_asserts), is_l_value_(false)  {
             assertion_ss_ptr = new stringstream();
           }
@@ -64,6 +68,9 @@ namespace differential {
       void VisitUnaryOperator(UnaryOperator * node);
       void VisitGotoStmt(GotoStmt * node);
       void VisitChildren(Stmt *node);
+
+      bool Tagged(const VarDecl *decl) const { return !taint_ || taint_->Tainted(decl); }
+      bool Tagged(const string &label) const { return !taint_ || taint_->Tainted(function_,label); }
    };
 
    class TagInstructionsASTConsumer : public ASTConsumer {
@@ -71,24 +78,37 @@ namespace differential {
        Rewriter         &rewriter_;
        const bool tag_equality_;
        const bool add_asserts_;
+       const set<unsigned> *changed_lines_; // for sparse tagging (see Taint), NULL otherwise
+       const set<string>   *changed_names_;
 
    public:
 
-      TagInstructionsASTConsumer(Rewriter& rewriter, bool tag_equality, bool add_asserts) : 
-      rewriter_(rewriter), source_manager_(rewriter.getSourceMgr()), tag_equality_(tag_equality), add_asserts_(add_asserts)  {}
+      TagInstructionsASTConsumer(Rewriter& rewriter, bool tag_equality, bool add_asserts,
+                                 const set<unsigned> *changed_lines = NULL, const set<string> *changed_names = NULL) : 
+      rewriter_(rewriter), source_manager_(rewriter.getSourceMgr()), tag_equality_(tag_equality), add_asserts_(add_asserts),
+      changed_lines_(changed_lines), changed_names_(changed_names)  {}
 
       virtual ~TagInstructionsASTConsumer() {}
 
       virtual void HandleTranslationUnit(ASTContext &contex) {
          // called when everything is done
-         TagInstructions tagger(rewriter_, contex, tag_equality_, add_asserts_);
          TranslationUnitDecl *unit_ptr = contex.getTranslationUnitDecl();
+         Taint *taint_ptr = NULL;
+         if (changed_lines_) {
+            taint_ptr = new Taint(source_manager_, *changed_lines_, *changed_names_);
+            taint_ptr->Run(unit_ptr);
+         }
+         TagInstructions tagger(rewriter_, contex, tag_equality_, add_asserts_, taint_ptr);
          if (add_asserts_)
              rewriter_.InsertText(source_manager_.getLocForStartOfFile(source_manager_.getMainFileID()), "#include <assert.h>\n");
          for (DeclContext::decl_iterator iter = unit_ptr->decls_begin(), end = unit_ptr->decls_end(); iter != end; ++iter) 
             tagger.Visit(*iter);
          string filename = Defines::kTaggedFilenamePrefix + source_manager_.getFileEntryForID(source_manager_.getMainFileID())->getName();
          Utils::WriteFiles(rewriter_,filename);
+         if (taint_ptr) {
+            cout << filename << ": " << taint_ptr->vars_.size() << " of " << taint_ptr->vars_ctr_ << " variables tagged\n";
+            delete taint_ptr;
+         }
       }
    };
 
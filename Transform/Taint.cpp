@@ -0,0 +1,260 @@
+#include "Taint.h"
+
+#include <algorithm>
+
+namespace differential {
+
+namespace {
+
+template <typename T>
+bool Intersect(const set<T> &set1, const set<T> &set2) {
+	for (typename set<T>::const_iterator iter = set1.begin(), end = set1.end(); iter != end; ++iter) {
+		if (set2.count(*iter))
+			return true;
+	}
+	return false;
+}
+
+}
+
+void Taint::Run(TranslationUnitDecl *unit) {
+	for (DeclContext::decl_iterator iter = unit->decls_begin(), end = unit->decls_end(); iter != end; ++iter) {
+		if (VarDecl *decl = dyn_cast<VarDecl>(*iter)) { // a global
+			See(decl);
+			continue;
+		}
+		FunctionDecl *function = dyn_cast<FunctionDecl>(*iter);
+		if (!function || !function->isThisDeclarationADefinition())
+			continue;
+		unsigned begin = statements_.size();
+		for (unsigned i = 0; i < function->getNumParams(); ++i) {
+			See(function->getParamDecl(i));
+		}
+		Collect(function->getBody(), function, set<const VarDecl*>());
+		functions_[function] = make_pair(begin,(unsigned)statements_.size());
+	}
+	vars_ctr_ = seen_.size();
+
+	// what the other version changes is only known by name
+	for (set<const VarDecl*>::const_iterator iter = seen_.begin(), end = seen_.end(); iter != end; ++iter) {
+		if (changed_names_.count((*iter)->getNameAsString()))
+			TaintVar(*iter);
+	}
+	for (unsigned i = 0; i < statements_.size(); ++i) {
+		const Statement &statement = statements_[i];
+		if (changed_names_.count(statement.label))
+			TaintLabel(statement.function,statement.label);
+		if (changed_names_.count(statement.target))
+			TaintLabel(statement.function,statement.target);
+	}
+
+	vector<bool> tainted(statements_.size(), false), controlled(statements_.size(), false);
+	for (bool grew = true; grew; ) {
+		grew = false;
+		for (unsigned i = 0; i < statements_.size(); ++i) {
+			const Statement &statement = statements_[i];
+			// whether the statement runs may differ, and then whether what it jumps over does
+			bool controls = statement.changed || Intersect(statement.conditions,vars_);
+			for (unsigned j = 0; j < ranges_.size() && !controls; ++j) {
+				controls = ranges_[j].first <= i && i < ranges_[j].second;
+			}
+			if (controls && !controlled[i]) {
+				controlled[i] = grew = true;
+				if (!statement.target.empty())
+					TaintLabel(statement.function,statement.target);
+				if (statement.ret) // the rest of the function
+					ranges_.push_back(make_pair(i + 1,functions_[statement.function].second));
+				else if (statement.jump) // the enclosing loop, or the function
+					ranges_.push_back(functions_[statement.function]);
+			}
+			bool reaches = controls || Intersect(statement.uses,vars_) || Intersect(statement.callees,returning_);
+			if (!reaches || tainted[i])
+				continue;
+			tainted[i] = grew = true;
+			for (set<const VarDecl*>::const_iterator iter = statement.defs.begin(), end = statement.defs.end(); iter != end; ++iter) {
+				TaintVar(*iter);
+			}
+			if (statement.ret)
+				returning_.insert(statement.function);
+			for (set<const FunctionDecl*>::const_iterator iter = statement.callees.begin(), end = statement.callees.end(); iter != end; ++iter) {
+				for (unsigned j = 0; j < (*iter)->getNumParams(); ++j) {
+					TaintVar((*iter)->getParamDecl(j)->getCanonicalDecl());
+				}
+			}
+		}
+	}
+}
+
+// the statements are collected where they can be told apart (each on its own line in guarded code), with the
+// variables of the conditions they are under
+void Taint::Collect(Stmt *node, const FunctionDecl *function, const set<const VarDecl*> &conditions) {
+	if (!node)
+		return;
+	if (CompoundStmt *compound = dyn_cast<CompoundStmt>(node)) {
+		for (CompoundStmt::body_iterator iter = compound->body_begin(), end = compound->body_end(); iter != end; ++iter) {
+			Collect(*iter, function, conditions);
+		}
+	} else if (IfStmt *if_stmt = dyn_cast<IfStmt>(node)) {
+		set<const VarDecl*> inner = conditions;
+		const Statement &cond = statements_[Add(if_stmt->getCond(), function, conditions)];
+		inner.insert(cond.uses.begin(), cond.uses.end());
+		Collect(if_stmt->getThen(), function, inner);
+		Collect(if_stmt->getElse(), function, inner);
+	} else if (ForStmt *for_stmt = dyn_cast<ForStmt>(node)) {
+		if (for_stmt->getInit())
+			Add(for_stmt->getInit(), function, conditions);
+		set<const VarDecl*> inner = conditions;
+		if (for_stmt->getCond()) {
+			const Statement &cond = statements_[Add(for_stmt->getCond(), function, conditions)];
+			inner.insert(cond.uses.begin(), cond.uses.end());
+		}
+		if (for_stmt->getInc())
+			Add(for_stmt->getInc(), function, inner);
+		Collect(for_stmt->getBody(), function, inner);
+	} else if (WhileStmt *while_stmt = dyn_cast<WhileStmt>(node)) {
+		set<const VarDecl*> inner = conditions;
+		const Statement &cond = statements_[Add(while_stmt->getCond(), function, conditions)];
+		inner.insert(cond.uses.begin(), cond.uses.end());
+		Collect(while_stmt->getBody(), function, inner);
+	} else if (DoStmt *do_stmt = dyn_cast<DoStmt>(node)) {
+		set<const VarDecl*> inner = conditions;
+		const Statement &cond = statements_[Add(do_stmt->getCond(), function, conditions)];
+		inner.insert(cond.uses.begin(), cond.uses.end());
+		Collect(do_stmt->getBody(), function, inner);
+	} else if (SwitchStmt *switch_stmt = dyn_cast<SwitchStmt>(node)) {
+		set<const VarDecl*> inner = conditions;
+		const Statement &cond = statements_[Add(switch_stmt->getCond(), function, conditions)];
+		inner.insert(cond.uses.begin(), cond.uses.end());
+		Collect(switch_stmt->getBody(), function, inner);
+	} else if (SwitchCase *switch_case = dyn_cast<SwitchCase>(node)) {
+		Collect(switch_case->getSubStmt(), function, conditions);
+	} else if (LabelStmt *label = dyn_cast<LabelStmt>(node)) {
+		statements_[Add(NULL, function, conditions)].label = label->getName();
+		Collect(label->getSubStmt(), function, conditions);
+	} else {
+		Add(node, function, conditions);
+	}
+}
+
+unsigned Taint::Add(Stmt *node, const FunctionDecl *function, const set<const VarDecl*> &conditions) {
+	Statement statement;
+	statement.stmt = node;
+	statement.function = function;
+	statement.conditions = statement.uses = conditions;
+	statement.jump = statement.ret = false;
+	statement.changed = node && Changed(node);
+	Refs(node, statement);
+	statements_.push_back(statement);
+	return statements_.size() - 1;
+}
+
+void Taint::Refs(Stmt *node, Statement &statement) {
+	if (!node)
+		return;
+	if (BinaryOperator *op = dyn_cast<BinaryOperator>(node)) {
+		if (op->isAssignmentOp())
+			Def(op->getLHS(), statement);
+	} else if (UnaryOperator *op = dyn_cast<UnaryOperator>(node)) {
+		if (op->isIncrementDecrementOp()) {
+			Def(op->getSubExpr(), statement);
+		} else if (op->getOpcode() == UO_AddrOf) {
+			Def(op->getSubExpr(), statement); // whoever gets the address may write through it
+			if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(op->getSubExpr()->IgnoreParenCasts())) {
+				if (VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl()))
+					aliased_.insert(decl->getCanonicalDecl());
+			}
+		}
+	} else if (CallExpr *call = dyn_cast<CallExpr>(node)) {
+		const FunctionDecl *callee = call->getDirectCallee(), *definition = NULL;
+		if (callee && callee->hasBody(definition))
+			statement.callees.insert(definition);
+		for (CallExpr::arg_iterator iter = call->arg_begin(), end = call->arg_end(); iter != end; ++iter) {
+			QualType type = (*iter)->IgnoreParenImpCasts()->getType();
+			if (type->isPointerType() || type->isArrayType())
+				Def(*iter, statement);
+		}
+	} else if (isa<ReturnStmt>(node)) {
+		statement.jump = statement.ret = true;
+	} else if (isa<BreakStmt>(node) || isa<ContinueStmt>(node)) {
+		statement.jump = true;
+	} else if (GotoStmt *goto_stmt = dyn_cast<GotoStmt>(node)) {
+		statement.target = goto_stmt->getLabel()->getNameAsString();
+	} else if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node)) {
+		if (VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl())) {
+			See(decl);
+			statement.uses.insert(decl->getCanonicalDecl());
+		}
+	} else if (DeclStmt *decl_stmt = dyn_cast<DeclStmt>(node)) {
+		for (DeclStmt::decl_iterator iter = decl_stmt->decl_begin(), end = decl_stmt->decl_end(); iter != end; ++iter) {
+			if (VarDecl *decl = dyn_cast<VarDecl>(*iter)) {
+				See(decl);
+				statement.defs.insert(decl->getCanonicalDecl());
+				Refs(decl->getInit(), statement);
+			}
+		}
+		return;
+	}
+	for (Stmt::child_iterator iter = node->child_begin(), end = node->child_end(); iter != end; ++iter) {
+		Refs(*iter, statement);
+	}
+}
+
+// a write defines the variable at the base of its target: x in x, a[i], *p, s.f and p->f
+void Taint::Def(Expr *node, Statement &statement) {
+	for (;;) {
+		node = node->IgnoreParenCasts();
+		if (ArraySubscriptExpr *subscript = dyn_cast<ArraySubscriptExpr>(node)) {
+			node = subscript->getBase();
+		} else if (MemberExpr *member = dyn_cast<MemberExpr>(node)) {
+			node = member->getBase();
+		} else if (UnaryOperator *op = dyn_cast<UnaryOperator>(node)) {
+			node = op->getSubExpr();
+		} else if (BinaryOperator *op = dyn_cast<BinaryOperator>(node)) { // pointer arithmetic
+			node = op->getLHS();
+		} else {
+			break;
+		}
+	}
+	if (DeclRefExpr *ref = dyn_cast<DeclRefExpr>(node)) {
+		if (VarDecl *decl = dyn_cast<VarDecl>(ref->getDecl()))
+			statement.defs.insert(decl->getCanonicalDecl());
+	}
+}
+
+void Taint::See(const VarDecl *decl) {
+	decl = decl->getCanonicalDecl();
+	seen_.insert(decl);
+	if (decl->getType()->isPointerType() || decl->getType()->isArrayType())
+		aliased_.insert(decl);
+}
+
+// tainting one alias taints them all
+void Taint::TaintVar(const VarDecl *decl) {
+	if (!vars_.insert(decl).second || !aliased_.count(decl))
+		return;
+	vars_.insert(aliased_.begin(), aliased_.end());
+}
+
+// a tainted label is tagged, and so is every goto to it; what lies between them may or may not run
+void Taint::TaintLabel(const FunctionDecl *function, const string &label) {
+	if (!labels_.insert(make_pair(function,label)).second)
+		return;
+	pair<unsigned,unsigned> range = functions_[function], jumped(range.second,range.first);
+	for (unsigned i = range.first; i < range.second; ++i) {
+		if (statements_[i].label == label || statements_[i].target == label) {
+			jumped.first = min(jumped.first,i);
+			jumped.second = max(jumped.second,i + 1);
+		}
+	}
+	if (jumped.first < jumped.second)
+		ranges_.push_back(jumped);
+}
+
+bool Taint::Changed(Stmt *node) const {
+	unsigned first = source_manager_.getSpellingLineNumber(node->getLocStart()),
+			last = source_manager_.getSpellingLineNumber(node->getLocEnd());
+	set<unsigned>::const_iterator line = changed_lines_.lower_bound(first);
+	return line != changed_lines_.end() && *line <= last;
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef ANALYZER_TAINT_H
+#define ANALYZER_TAINT_H
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+using namespace std;
+
+#include <clang/AST/Decl.h>
+#include <clang/AST/Expr.h>
+#include <clang/AST/Stmt.h>
+#include <clang/Basic/SourceManager.h>
+using namespace clang;
+using namespace llvm;
+
+namespace differential {
+
+/**
+ * The variables and labels of one version that the patch can reach, for tagging only those (see
+ * TagInstructions). Taint starts at the statements on the changed lines of this version, and at the variables
+ * and labels named on the changed lines of the other version, and follows:
+ * - data, from what a statement uses to what it defines (a write through a pointer or to an array defines its
+ *   base, and the variables whose address is taken, the pointers and the arrays are all taken as aliases);
+ * - control, from a condition to the statements under it (in guarded code the guards are on every line), and
+ *   from a goto to the statements between it and its label (which is then tagged too), and from a break,
+ *   continue or return to the rest of the function;
+ * - calls, from the arguments to the parameters of the functions defined in the unit, and from a return back
+ *   to the calls.
+ * The analysis is flow-insensitive, over the whole translation unit.
+ */
+class Taint {
+	struct Statement {
+		Stmt *stmt;
+		const FunctionDecl *function;
+		set<const VarDecl*> defs, uses; // the uses include the conditions
+		set<const VarDecl*> conditions; // the variables of the conditions the statement is under
+		set<const FunctionDecl*> callees; // the ones defined in the unit
+		string label, target; // of a label statement, and of a goto
+		bool jump, ret; // a break, continue or return, and a return
+		bool changed;
+	};
+
+	SourceManager        &source_manager_;
+	const set<unsigned>  &changed_lines_;
+	const set<string>    &changed_names_;
+
+	vector<Statement> statements_;
+	map<const FunctionDecl*,pair<unsigned,unsigned> > functions_; // the range of a function's statements
+	set<const VarDecl*> seen_, aliased_;
+	set<const FunctionDecl*> returning_; // with a tainted return
+	vector<pair<unsigned,unsigned> > ranges_; // of the statements under a tainted jump
+
+	void Collect(Stmt *node, const FunctionDecl *function, const set<const VarDecl*> &conditions);
+	unsigned Add(Stmt *node, const FunctionDecl *function, const set<const VarDecl*> &conditions);
+	void Refs(Stmt *node, Statement &statement);
+	void Def(Expr *node, Statement &statement);
+	void See(const VarDecl *decl);
+	void TaintVar(const VarDecl *decl);
+	void TaintLabel(const FunctionDecl *function, const string &label);
+	bool Changed(Stmt *node) const;
+
+public:
+
+	set<const VarDecl*> vars_; // tainted, by canonical declaration
+	set<pair<const FunctionDecl*,string> > labels_;
+	unsigned vars_ctr_; // of all variables seen
+
+	Taint(SourceManager &source_manager, const set<unsigned> &changed_lines, const set<string> &changed_names) :
+		source_manager_(source_manager), changed_lines_(changed_lines), changed_names_(changed_names), vars_ctr_(0) { }
+	virtual ~Taint() { }
+
+	void Run(TranslationUnitDecl *unit);
+
+	bool Tainted(const VarDecl *decl) const { return vars_.count(decl->getCanonicalDecl()); }
+	bool Tainted(const FunctionDecl *function, const string &label) const { return labels_.count(make_pair(function,label)); }
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include "Transform/TagConsumer.h"
 #include "Transform/InlineConsumer.h"
 #include "Transform/UnionConsumer.h"
+#include "Transform/SliceConsumer.h"
 using namespace differential;
 
 #include "DTL/dtl.hpp"
@@ -12,21 +13,27 @@ using namespace dtl;
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <cctype>
+#include <cstdlib>
 using namespace std;
 
 #define DEBUGOutputUnion 0
 
 extern llvm::cl::opt<std::string>  InputFilename;
 extern llvm::cl::list<std::string> PatchedFilename;
+extern llvm::cl::list<std::string> SliceFilename;
+extern llvm::cl::list<std::string> SliceWith;
 extern llvm::cl::list<std::string> GuardFilename;
 extern llvm::cl::list<std::string> GuardTaggedFilename;
 extern llvm::cl::list<std::string> TagFilename;
+extern llvm::cl::list<std::string> TagWith;
 extern llvm::cl::list<std::string> InlineFilename;
 extern llvm::cl::list<std::string> RetGuard;
 extern llvm::cl::list<std::string> X0;
 extern llvm::cl::list<std::string> Clear;
 extern llvm::cl::list<std::string> DiffPoints;
 extern llvm::cl::list<std::string> TagEquality;
+extern llvm::cl::list<std::string> SparseTags;
 extern llvm::cl::list<std::string> AddAsserts;
 
 namespace differential {
@@ -48,6 +55,9 @@ namespace differential {
         } else if ( InlineFilename.size() > 0 ) {
             InputFilename = InlineFilename[0];
             UnionCompiler().InlineTransform();
+        } else if ( SliceFilename.size() > 0 && SliceWith.size() > 0 ) {
+            InputFilename = SliceFilename[0];
+            UnionCompiler().SliceTransform();
         } else if ( PatchedFilename.size() > 0 ) {
             // This handles 2 files
             UnionCompiler().UnionTransform();
@@ -83,6 +93,11 @@ namespace differential {
         // Create TranslationUnit for the patched program (we need another differential for that)
         InputFilename = PatchedFilename[0];
         UnionCompiler ucc2; // for the patched version
+        bool sparse = SparseTags.size() > 0 && SparseTags[0] == "true";
+        if ( !sparse && ucc2.source_manager_.getBufferData(ucc2.source_manager_.getMainFileID()).find(Defines::kSparseTagsMarker) != StringRef::npos ) {
+            cerr << PatchedFilename[0] << " was tagged with -t_with, its union needs -sparse_tags=true" << endl;
+            exit(1);
+        }
         UnionerASTConsumer consumer2(ucc2.rewriter_);
         ucc2.Transform(consumer2);
 
@@ -210,11 +225,14 @@ namespace differential {
         unsigned line_num = 0, patched_line_num = 0;
 		bool added = false, deleted = false;
 		bool add_diff_points = DiffPoints.size() > 0 && DiffPoints[0] == "true";
+		bool sparse = SparseTags.size() > 0 && SparseTags[0] == "true";
+        vector<bool> braces; // in sparse mode, whether each open brace was emitted once (or in both copies)
         for ( size_t loc = 0 ; loc < seq.size() ; ++loc ) {
 #if (DEBUGOutputUnion)
 			cerr << "Line index: " << line_num << " , " << " Patched line index: " << patched_line_num << ", Line: " << seq[loc].second.type << " , " << seq[loc].first << endl;
 #endif
             string line, patched_line, current = seq[loc].first;
+            bool once = false;
             switch ( seq[loc].second.type ) {
             case SES_ADD:
 				patched_line = patched_lines[patched_line_num];
@@ -226,6 +244,7 @@ namespace differential {
                     break;
                 }
                 out << patched_line;
+                MatchBraces(current, braces, true);
                 // Addition of tag variables or '}' or '{' doesn't count as a true diff
                 if ( add_diff_points &&
                      current.find(Defines::kTagParamDef) == current.npos &&
@@ -245,6 +264,7 @@ namespace differential {
             case SES_DELETE:
 				line = lines[line_num];
                 out << line;
+                MatchBraces(current, braces, true);
                 if ( add_diff_points &&
                      current.find(Defines::kCorrPointPrefix) == current.npos &&
                      current.find("{") == current.npos &&
@@ -263,6 +283,10 @@ namespace differential {
             case SES_COMMON:
 				line = lines[line_num];
 				patched_line = patched_lines[patched_line_num];
+				// a line tagging left as is stands for both versions and is emitted once, and so is a line closing
+				// braces emitted once (a loop or a block over shared variables must not run twice)
+				once = sparse && Utils::Trim(line) == Utils::Trim(patched_line) && ClosesOnce(current, braces);
+				MatchBraces(current, braces, once);
 				if (added || deleted) { // if lines were added or removed prior to this common line, add a diff point
 					out << "{char *" << Defines::kCorrPointPrefix << diff_point_ctr++ << ";}\n";
 					added = deleted = false;
@@ -273,7 +297,7 @@ namespace differential {
                     stringstream ss;
                     ss << " = " << Defines::kRetVal;
                     out << patched_line.insert(patched_line.size() - 2,ss.str());
-                } else if (seq[loc].first.find("enum") != 0) { // print out the patched line only if its not an enum
+                } else if (seq[loc].first.find("enum") != 0 && !once) { // print out the patched line only if its not an enum, or emitted once
                     out << patched_line;
                 }
                 // Add a corr point after 2 identical lines only if it's a "real" line 
@@ -300,8 +324,67 @@ namespace differential {
         return out.str();
     }
 
+    // whether all the braces the line closes (of those open before it) were emitted once
+    bool UnionCompiler::ClosesOnce(const string &line, const vector<bool> &braces) {
+        size_t open = 0, closed = 0; // opened on the line, and closed of the ones before it
+        for ( size_t i = 0; i < line.size(); ++i ) {
+            if ( line[i] == '{' ) {
+                ++open;
+            } else if ( line[i] == '}' ) {
+                if ( open > 0 )
+                    --open;
+                else if ( ++closed <= braces.size() && !braces[braces.size() - closed] )
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // follow the braces of a line emitted once or twice (see OutputUnion)
+    void UnionCompiler::MatchBraces(const string &line, vector<bool> &braces, bool once) {
+        for ( size_t i = 0; i < line.size(); ++i ) {
+            if ( line[i] == '{' )
+                braces.push_back(once);
+            else if ( line[i] == '}' && !braces.empty() )
+                braces.pop_back();
+        }
+    }
+
+    // the line without the "if (G0) ", "if (!G1) " and "if (!Ret) " guards GuardedInstructions puts before statements
+    string UnionCompiler::Unguarded(const string &line) {
+        string rest = Utils::Trim(line);
+        while ( rest.find("if (") == 0 ) {
+            size_t begin = (rest.find("if (!") == 0) ? 5 : 4, end = rest.find(") ", begin);
+            if ( end == rest.npos )
+                break;
+            string guard = rest.substr(begin, end - begin);
+            bool numbered = guard.size() > Defines::kGuardPrefix.size() && guard.find(Defines::kGuardPrefix) == 0 &&
+                            guard.find_first_not_of("0123456789", Defines::kGuardPrefix.size()) == guard.npos;
+            if ( !numbered && guard != Defines::kRetGuard )
+                break;
+            rest = rest.substr(end + 2);
+        }
+        return rest;
+    }
+
     void UnionCompiler::TagInstructionsTransform() {
-        TagInstructionsASTConsumer consumer(rewriter_, (TagEquality.size() > 0 && TagEquality[0] == "true"), (AddAsserts.size() > 0 && AddAsserts[0] == "true"));
+        bool tag_equality = TagEquality.size() > 0 && TagEquality[0] == "true", add_asserts = AddAsserts.size() > 0 && AddAsserts[0] == "true";
+        if ( TagWith.size() == 0 ) {
+            TagInstructionsASTConsumer consumer(rewriter_, tag_equality, add_asserts);
+            Transform(consumer);
+            return;
+        }
+        // Sparse tagging: only what the changes from the version given with -t_with can reach is tagged
+        InputFilename = TagWith[0];
+        UnionCompiler ucc2; // for the other version
+        string file2 = ucc2.source_manager_.getBufferData(ucc2.source_manager_.getMainFileID());
+        set<unsigned> changed, changed2;
+        set<string> names2;
+        ChangedLines(source_manager_.getBufferData(source_manager_.getMainFileID()), file2, changed, changed2);
+        ChangedNames(file2, changed2, names2);
+        // the union of a sparsely tagged version must know it (see OutputUnion)
+        rewriter_.InsertText(source_manager_.getLocForStartOfFile(source_manager_.getMainFileID()), Defines::kSparseTagsMarker);
+        TagInstructionsASTConsumer consumer(rewriter_, tag_equality, add_asserts, &changed, &names2);
         Transform(consumer);
     }
 
@@ -319,4 +402,77 @@ namespace differential {
         Transform(consumer);
     }
 
+    // slices this version and the one given with -s_with, each from the lines the diff marks in it and the names on them
+    void UnionCompiler::SliceTransform() {
+        InputFilename = SliceWith[0];
+        UnionCompiler ucc2; // for the other version
+        string file = source_manager_.getBufferData(source_manager_.getMainFileID()),
+               file2 = ucc2.source_manager_.getBufferData(ucc2.source_manager_.getMainFileID());
+        set<unsigned> changed, changed2;
+        set<string> names; // named on the changed lines of either version, so both slices start from them
+        ChangedLines(file, file2, changed, changed2);
+        ChangedNames(file, changed, names);
+        ChangedNames(file2, changed2, names);
+        SlicerASTConsumer consumer(rewriter_, changed, names);
+        Transform(consumer);
+        SlicerASTConsumer consumer2(ucc2.rewriter_, changed2, names);
+        ucc2.Transform(consumer2);
+    }
+
+    // the lines of file, in one pass over it
+    void UnionCompiler::SplitLines(const string &file, vector<string> &lines) {
+        for ( size_t begin = 0, end = 0; end != file.npos; begin = end + 1 ) {
+            end = file.find('\n', begin);
+            lines.push_back(file.substr(begin, (end == file.npos) ? file.npos : end - begin));
+        }
+    }
+
+    // the numbers of the lines (from 1) the line diff deletes from file and adds in file2, ignoring indentation
+    void UnionCompiler::ChangedLines(const string &file, const string &file2, set<unsigned> &changed, set<unsigned> &changed2) {
+        vector<string> lines, lines2;
+        SplitLines(file, lines);
+        SplitLines(file2, lines2);
+        for ( size_t i = 0; i < lines.size(); ++i )
+            lines[i] = Utils::Trim(lines[i]);
+        for ( size_t i = 0; i < lines2.size(); ++i )
+            lines2[i] = Utils::Trim(lines2[i]);
+        Diff< string, vector<string> > diff(lines, lines2);
+        diff.compose();
+        vector<pair<string, elemInfo> > seq = diff.getSes().getSequence();
+        unsigned line_num = 0, line_num2 = 0;
+        for ( size_t loc = 0 ; loc < seq.size() ; ++loc ) {
+            switch ( seq[loc].second.type ) {
+            case SES_ADD:
+                changed2.insert(++line_num2);
+                break;
+            case SES_DELETE:
+                changed.insert(++line_num);
+                break;
+            case SES_COMMON:
+                ++line_num;
+                ++line_num2;
+                break;
+            }
+        }
+    }
+
+    // the identifiers on the given lines (numbered from 1) of file, but not in the guards of guarded code: every
+    // statement under a guard (and, with return guards, every statement) has them, so they are not what changed
+    void UnionCompiler::ChangedNames(const string &file, const set<unsigned> &lines, set<string> &names) {
+        vector<string> file_lines;
+        SplitLines(file, file_lines);
+        for ( set<unsigned>::const_iterator iter = lines.begin(), end = lines.end(); iter != end && *iter <= file_lines.size(); ++iter ) {
+            string line = Unguarded(file_lines[*iter - 1]);
+            for ( size_t i = 0, j; i < line.size(); i = j ) {
+                j = i + 1;
+                if ( !isalnum(line[i]) && line[i] != '_' )
+                    continue;
+                while ( j < line.size() && (isalnum(line[j]) || line[j] == '_') )
+                    ++j;
+                if ( !isdigit(line[i]) ) // not a number
+                    names.insert(line.substr(i, j - i));
+            }
+        }
+    }
+
 }
@@ -1,6 +1,11 @@
 #ifndef UCC_H
 #define UCC_H
 
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
 #include <clang/AST/ASTContext.h>
 
 #include "CodeHandler.h"
@@ -12,6 +17,12 @@ namespace differential {
       ASTContext    *contex_ptr_;
 
       void Transform(ASTConsumer  &consumer);
+      static void SplitLines(const string &file, vector<string> &lines);
+      static bool ClosesOnce(const string &line, const vector<bool> &braces);
+      static void MatchBraces(const string &line, vector<bool> &braces, bool once);
+      static void ChangedLines(const string &file, const string &file2, set<unsigned> &changed, set<unsigned> &changed2);
+      static void ChangedNames(const string &file, const set<unsigned> &lines, set<string> &names);
+      static string Unguarded(const string &line);
       string OutputUnion(string FileStr, string FilePatchedStr, unsigned &diff_point_ctr, unsigned &added_ctr, unsigned &deleted_ctr, bool clear);
 
    public:
@@ -23,6 +34,7 @@ namespace differential {
       void GuardedInstructionsTransform();
       void TagInstructionsTransform();
       void InlineTransform();
+      void SliceTransform();
       void UnionTransform(ostream& report_file = cout);
 
       static int Main(int argc, char* argv[]);
@@ -205,6 +205,8 @@ private:
 		EnqueueBlocksOnWorklist(cfg, AnalysisDirTag());
 		llvm::DenseMap<unsigned,unsigned> CounterMap;
 		std::set<const CFGBlock *> VisitedBlocks;
+		// loop heads are computed once per CFG, every cycle goes through one of them
+		typename ValTy::LoopsTy Loops(cfg);
 		while ( !WorkList.isEmpty() ) {
 			const CFGBlock* B = WorkList.dequeue();
 			VisitedBlocks.insert(B);
@@ -231,12 +233,12 @@ private:
 #endif
 
 			// widen when reaching the threshold, according to widening point
-			if ( ++CounterMap[B->getBlockID()] > TF.getVal().widening_threshold_ ) {
+			if ( ++CounterMap[B->getBlockID()] > TF.getVal().Context().widening_threshold_ ) {
 #if (DEBUGWiden)
 				fprintf(stderr,"\nBlock (visited %d times):\n", CounterMap[B->getBlockID()]);
 				B->dump(&cfg,LangOptions());
 #endif
-				if (TF.getVal().widening_point_ == 0/*AnalysisConfiguration::WIDEN_AT_ALL*/) {
+				if (TF.getVal().Context().widening_point_ == 0/*AnalysisConfiguration::WIDEN_AT_ALL*/) {
 #if (DEBUGWiden)
 					fprintf(stderr,"\nStrategy: At-All\nWidning...\n");
 #endif
@@ -245,26 +247,21 @@ private:
 					fprintf(stderr,"\nResult:\n");
 					TF.getVal().print();
 #endif
-				} else if (TF.getVal().widening_point_ == 2/*AnalysisConfiguration::WIDEN_AT_BACK_EDGE*/) {
+				} else if (TF.getVal().Context().widening_point_ == 2/*AnalysisConfiguration::WIDEN_AT_BACK_EDGE*/) {
 #if (DEBUGWiden)
 					fprintf(stderr,"\nStrategy: At-Back-Edge\n");
 #endif
-					// a block has a back edge if its predecessor id is greater than its own
-					for ( PrevBItr I=ItrTraits::PrevBegin(B),E=ItrTraits::PrevEnd(B); I!=E; ++I ) {
-						CFGBlock *PrevBlk = *I;
-						if ( PrevBlk && PrevBlk->getBlockID() < B->getBlockID() ) {
+					if ( Loops.IsHead(B) ) {
 #if (DEBUGWiden)
-							fprintf(stderr,"\nBack Edge Found! (%d), Widneing...\n",PrevBlk->getBlockID());
+						fprintf(stderr,"\nLoop Head Found! (%d), Widneing...\n",B->getBlockID());
 #endif
-							ValTy::Widening(VPre,VPost,TF.getVal());
+						ValTy::Widening(VPre,VPost,TF.getVal());
 #if (DEBUGWiden)
-							fprintf(stderr,"\nResult:\n");
-							TF.getVal().print();
+						fprintf(stderr,"\nResult:\n");
+						TF.getVal().print();
 #endif
-							break;
-						}
 					}
-				} else if (TF.getVal().widening_point_ == 1/*AnalysisConfiguration::WIDEN_AT_CORR_POINT*/ && TF.getVal().at_diff_point_ == true) {
+				} else if (TF.getVal().Context().widening_point_ == 1/*AnalysisConfiguration::WIDEN_AT_CORR_POINT*/ && TF.getVal().at_diff_point_ == true) {
 					   TF.getVal().at_diff_point_ = false;
 #if (DEBUGWiden)
 						fprintf(stderr,"\nDiff Point Found! (%d), Widneing...\n");
@@ -351,7 +348,7 @@ private:
 		// Set the data for the block.
 		BI->second.copyValues(V);
 		// partioning at join may happen only here!
-		if ( BI->second.partition_point_ == 1/*AnalysisConfiguration::PARTITION_AT_JOIN*/ ) {
+		if ( BI->second.Context().partition_point_ == 1/*AnalysisConfiguration::PARTITION_AT_JOIN*/ ) {
 			BI->second.Partition();
 		}
 #if (DEBUGMerge)